@@ -0,0 +1,652 @@
+#include "Benchmark.h"
+#include "Window.h"
+#include "InputManager.h"
+#include "InputConfig.h"
+#include "Settings.h"
+#include "Paths.h"
+#include "Trace.h"
+#include "MemoryAccounting.h"
+#include "SystemData.h"
+#include "FileData.h"
+#include "Gamelist.h"
+#include "views/gamelist/DetailedGameListView.h"
+#include "services/httplib.h"
+#include "Log.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include <pugixml/src/pugixml.hpp>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/prettywriter.h>
+#include <SDL_events.h>
+#include <SDL_keyboard.h>
+#include <SDL_stdinc.h>
+#include <iostream>
+#include <cstring>
+#include <thread>
+#include <atomic>
+
+// Marks a directory generated by the benchmark : it can be wiped at the next run
+#define LIBRARY_MARKER ".es-bench"
+
+std::vector<Benchmark::Action> Benchmark::mActions;
+size_t Benchmark::mPosition = 0;
+int64_t Benchmark::mWaitUntil = 0;
+int Benchmark::mFramesToWait = 0;
+
+bool Benchmark::mRunning = false;
+bool Benchmark::mStarted = false;
+bool Benchmark::mGeneratedLibrary = false;
+int Benchmark::mLibrarySystems = 0;
+int Benchmark::mLibraryGames = 0;
+
+std::string Benchmark::mScriptPath;
+std::string Benchmark::mOutputPath;
+
+std::vector<std::pair<std::string, int64_t>> Benchmark::mBootPhases;
+std::vector<Benchmark::Section> Benchmark::mSections;
+std::vector<Benchmark::Measure> Benchmark::mMeasures;
+bool Benchmark::mSectionOpened = false;
+
+std::thread* Benchmark::mMeasureThread = nullptr;
+std::atomic<bool> Benchmark::mMeasureDone(false);
+Benchmark::Measure Benchmark::mPendingMeasure;
+std::string Benchmark::mPendingMediaPath;
+
+// Systems of the synthetic library, named after common themes so that they get logos
+static const char* sSystemNames[] = { "nes", "snes", "megadrive", "mastersystem", "gb", "gbc", "gba", "n64", "psx", "pcengine", "neogeo", "atari2600", "segacd", "gamegear", "nds", "dreamcast" };
+static const int sSystemNamesCount = sizeof(sSystemNames) / sizeof(sSystemNames[0]);
+
+static const char* sGenres[] = { "Action", "Platform", "Shooter", "Sports", "Puzzle", "Racing", "Fighting", "Role Playing Game" };
+
+// 1x1 transparent png
+static const unsigned char sImageStub[] =
+{
+	0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x48, 0x44, 0x52,
+	0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00, 0x00, 0x1F, 0x15, 0xC4,
+	0x89, 0x00, 0x00, 0x00, 0x0D, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9C, 0x63, 0x00, 0x01, 0x00, 0x00,
+	0x05, 0x00, 0x01, 0x0D, 0x0A, 0x2D, 0xB4, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44, 0xAE,
+	0x42, 0x60, 0x82
+};
+
+bool Benchmark::load(const std::string& scriptPath)
+{
+	mScriptPath = Utils::FileSystem::getAbsolutePath(scriptPath);
+
+	if (!parseScript(mScriptPath))
+		return false;
+
+	if (mLibrarySystems > 0)
+	{
+		std::string home = Utils::FileSystem::getParent(mScriptPath) + "/es-bench-home";
+		if (!generateLibrary(home, mLibrarySystems, mLibraryGames))
+			return false;
+
+		Paths::setHomePath(home);
+		mGeneratedLibrary = true;
+
+		pinSettings();
+	}
+
+	mRunning = true;
+	return true;
+}
+
+bool Benchmark::parseScript(const std::string& scriptPath)
+{
+	if (!Utils::FileSystem::exists(scriptPath))
+	{
+		std::cerr << "Benchmark : " << scriptPath << " doesn't exist\n";
+		return false;
+	}
+
+	int lineNumber = 0;
+
+	for (auto line : Utils::FileSystem::readAllLines(scriptPath))
+	{
+		lineNumber++;
+
+		auto comment = line.find('#');
+		if (comment != std::string::npos)
+			line = line.substr(0, comment);
+
+		std::vector<std::string> args;
+		for (auto arg : Utils::String::splitAny(Utils::String::trim(line), " \t", true))
+			args.push_back(arg);
+
+		if (args.empty())
+			continue;
+
+		std::string command = args[0];
+		bool valid = true;
+
+		if (command == "library" && args.size() == 3 && mActions.empty())
+		{
+			mLibrarySystems = Utils::String::toInteger(args[1]);
+			mLibraryGames = Utils::String::toInteger(args[2]);
+			valid = mLibrarySystems > 0 && mLibraryGames > 0;
+		}
+		else if (command == "wait" && args.size() == 2)
+			mActions.push_back({ ACTION_WAIT, "", Utils::String::toInteger(args[1]) });
+		else if (command == "frames" && args.size() == 2)
+			mActions.push_back({ ACTION_FRAMES, "", Utils::String::toInteger(args[1]) });
+		else if (command == "press" && args.size() >= 2 && args.size() <= 4)
+		{
+			int count = args.size() > 2 ? Utils::String::toInteger(args[2]) : 1;
+			int delay = args.size() > 3 ? Utils::String::toInteger(args[3]) : 100;
+
+			// The release is sent on the next frame, as a real key would be
+			for (int i = 0; i < count; i++)
+			{
+				mActions.push_back({ ACTION_KEYDOWN, args[1], 0 });
+				mActions.push_back({ ACTION_FRAMES, "", 1 });
+				mActions.push_back({ ACTION_KEYUP, args[1], 0 });
+				mActions.push_back({ ACTION_WAIT, "", delay });
+			}
+		}
+		else if (command == "hold" && args.size() == 3)
+		{
+			mActions.push_back({ ACTION_KEYDOWN, args[1], 0 });
+			mActions.push_back({ ACTION_WAIT, "", Utils::String::toInteger(args[2]) });
+			mActions.push_back({ ACTION_KEYUP, args[1], 0 });
+		}
+		else if (command == "section" && args.size() >= 2)
+			mActions.push_back({ ACTION_SECTION, Utils::String::trim(line.substr(line.find(args[1]))), 0 });
+		else if (command == "measure" && args.size() == 3)
+		{
+			mActions.push_back({ ACTION_MEASURE, args[1], Utils::String::toInteger(args[2]) });
+			valid = (args[1] == "theme" || args[1] == "gamelist" || args[1] == "media") && mActions.back().amount > 0;
+		}
+		else if (command == "quit" && args.size() == 1)
+			mActions.push_back({ ACTION_QUIT, "", 0 });
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			std::cerr << "Benchmark : invalid command line " << lineNumber << " of " << scriptPath << " : " << line << "\n";
+			return false;
+		}
+	}
+
+	if (mActions.empty() || mActions.back().type != ACTION_QUIT)
+		mActions.push_back({ ACTION_QUIT, "", 0 });
+
+	return true;
+}
+
+bool Benchmark::generateLibrary(const std::string& path, int systems, int games)
+{
+	if (Utils::FileSystem::exists(path))
+	{
+		// Never wipe a directory which hasn't been created by a benchmark
+		if (!Utils::FileSystem::exists(path + "/" + LIBRARY_MARKER))
+		{
+			std::cerr << "Benchmark : " << path << " already exists and wasn't generated by a benchmark\n";
+			return false;
+		}
+
+		Utils::FileSystem::deleteDirectoryFiles(path);
+	}
+
+	// Start from an empty home at every run, so that caches of a previous run don't change the results
+	Utils::FileSystem::createDirectory(path + "/.emulationstation");
+	Utils::FileSystem::writeAllText(path + "/" + LIBRARY_MARKER, std::to_string(systems) + " " + std::to_string(games));
+
+	std::string imageStub((const char*)sImageStub, sizeof(sImageStub));
+
+	pugi::xml_document systemsDoc;
+	pugi::xml_node systemList = systemsDoc.append_child("systemList");
+
+	for (int i = 0; i < systems; i++)
+	{
+		std::string theme = sSystemNames[i % sSystemNamesCount];
+		std::string name = theme + (i < sSystemNamesCount ? "" : std::to_string(i / sSystemNamesCount + 1));
+		std::string romPath = path + "/roms/" + name;
+
+		pugi::xml_node system = systemList.append_child("system");
+		system.append_child("name").text().set(name.c_str());
+		system.append_child("fullname").text().set(("Benchmark " + name).c_str());
+		system.append_child("path").text().set(romPath.c_str());
+		system.append_child("extension").text().set(".zip");
+		system.append_child("command").text().set("true");
+		system.append_child("platform").text().set(theme.c_str());
+		system.append_child("theme").text().set(theme.c_str());
+
+		Utils::FileSystem::createDirectory(romPath + "/images");
+
+		pugi::xml_document gamelistDoc;
+		pugi::xml_node gameList = gamelistDoc.append_child("gameList");
+
+		for (int j = 0; j < games; j++)
+		{
+			char fileName[32];
+			snprintf(fileName, sizeof(fileName), "game%05d", j);
+
+			// Values vary between games so that sorts and filters have something to do
+			int seed = (j * 7919 + i * 104729) % 1000;
+
+			Utils::FileSystem::writeAllText(romPath + "/" + fileName + ".zip", "");
+			Utils::FileSystem::writeAllText(romPath + "/images/" + fileName + ".png", imageStub);
+
+			pugi::xml_node game = gameList.append_child("game");
+			game.append_child("path").text().set((std::string("./") + fileName + ".zip").c_str());
+			game.append_child("name").text().set(("Game " + std::to_string(seed) + " " + std::to_string(j)).c_str());
+			game.append_child("desc").text().set(("Synthetic game " + std::to_string(j) + " of " + name + ".").c_str());
+			game.append_child("image").text().set((std::string("./images/") + fileName + ".png").c_str());
+			game.append_child("rating").text().set(std::to_string((seed % 11) / 10.0f).c_str());
+			game.append_child("releasedate").text().set((std::to_string(1980 + seed % 40) + "0101T000000").c_str());
+			game.append_child("developer").text().set(("Developer " + std::to_string(seed % 25)).c_str());
+			game.append_child("genre").text().set(sGenres[seed % (sizeof(sGenres) / sizeof(sGenres[0]))]);
+			game.append_child("players").text().set(std::to_string(1 + seed % 4).c_str());
+
+			if (seed % 10 == 0)
+				game.append_child("favorite").text().set("true");
+		}
+
+		if (!gamelistDoc.save_file((romPath + "/gamelist.xml").c_str()))
+		{
+			std::cerr << "Benchmark : unable to write " << romPath << "/gamelist.xml\n";
+			return false;
+		}
+	}
+
+	if (!systemsDoc.save_file((path + "/.emulationstation/es_systems.cfg").c_str()))
+	{
+		std::cerr << "Benchmark : unable to write " << path << "/.emulationstation/es_systems.cfg\n";
+		return false;
+	}
+
+	std::cout << "Benchmark : generated " << systems << " systems of " << games << " games in " << path << "\n";
+	return true;
+}
+
+// Settings which would make runs differ
+void Benchmark::pinSettings()
+{
+	Settings::getInstance()->setString("PowerSaverMode", "disabled");
+	Settings::getInstance()->setInt("ScreenSaverTime", 0);
+	Settings::getInstance()->setString("StartupSystem", "");
+	Settings::getInstance()->setBool("SplashScreen", false);
+}
+
+void Benchmark::setHeadless()
+{
+	SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+}
+
+void Benchmark::markBoot(const std::string& phase)
+{
+	if (!mRunning)
+		return;
+
+	mBootPhases.push_back(std::pair<std::string, int64_t>(phase, Trace::getTime()));
+}
+
+void Benchmark::pushKey(const std::string& button, bool pressed)
+{
+	InputConfig* config = InputManager::getInstance()->getInputConfigByDevice(DEVICE_KEYBOARD);
+
+	Input input;
+	if (config == nullptr || !config->getInputByName(button, &input) || input.type != TYPE_KEY)
+	{
+		LOG(LogWarning) << "Benchmark : no keyboard key is mapped to " << button;
+		return;
+	}
+
+	SDL_Event event;
+	memset(&event, 0, sizeof(event));
+	event.type = pressed ? SDL_KEYDOWN : SDL_KEYUP;
+	event.key.timestamp = SDL_GetTicks();
+	event.key.state = pressed ? SDL_PRESSED : SDL_RELEASED;
+	event.key.keysym.sym = input.id;
+	event.key.keysym.scancode = SDL_GetScancodeFromKey(input.id);
+	SDL_PushEvent(&event);
+}
+
+void Benchmark::beginSection(const std::string& name)
+{
+	endSection();
+
+	Section section;
+	section.name = name;
+	section.start = Trace::getTime();
+	section.duration = 0;
+	section.heapInUse = 0;
+	mSections.push_back(section);
+	mSectionOpened = true;
+
+	FrameTimings::reset();
+
+	LOG(LogInfo) << "Benchmark : section " << name;
+}
+
+void Benchmark::endSection()
+{
+	if (!mSectionOpened)
+		return;
+
+	mSectionOpened = false;
+
+	auto& section = mSections.back();
+	section.duration = Trace::getTime() - section.start;
+	section.stats = FrameTimings::getStats();
+	section.heapInUse = MemoryAccounting::getHeapInUse();
+}
+
+// First populated system which isn't a collection, or nullptr
+static SystemData* getMeasuredSystem()
+{
+	for (auto system : SystemData::sSystemVector)
+	{
+		if (system->isCollection() || system->isGroupSystem())
+			continue;
+
+		system->ensurePopulated();
+		if (system->isPopulated())
+			return system;
+	}
+
+	return nullptr;
+}
+
+void Benchmark::runMeasure(Window* window, const std::string& name, int amount)
+{
+	SystemData* system = getMeasuredSystem();
+	if (system == nullptr)
+	{
+		LOG(LogWarning) << "Benchmark : no system to run measure " << name;
+		return;
+	}
+
+	Measure measure;
+	measure.name = name;
+	measure.amount = amount;
+
+	// The file is served from the resources of the benchmark home : never write it in a real home
+	std::string mediaPath = Paths::getUserEmulationStationPath() + "/resources/es-bench-media.bin";
+	if (name == "media")
+	{
+		if (!mGeneratedLibrary)
+		{
+			LOG(LogWarning) << "Benchmark : measure media needs a generated library";
+			return;
+		}
+
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(mediaPath));
+
+		FILE* file = fopen(mediaPath.c_str(), "wb");
+		if (file == nullptr)
+		{
+			LOG(LogWarning) << "Benchmark : unable to write " << mediaPath;
+			return;
+		}
+
+		std::vector<char> block(1024 * 1024, 'x');
+		for (int i = 0; i < amount; i++)
+			fwrite(block.data(), 1, block.size(), file);
+
+		fclose(file);
+	}
+
+	// Changing the games isn't measured, only the save
+	if (name == "gamelist")
+	{
+		auto games = system->getRootFolder()->getFilesRecursive(GAME);
+		for (int i = 0; i < amount && i < (int)games.size(); i++)
+		{
+			auto game = games[(i * games.size()) / amount];
+			game->getMetadata().set(MetaDataId::PlayCount, std::to_string(Utils::String::toInteger(game->getMetadata().get(MetaDataId::PlayCount)) + 1));
+		}
+	}
+
+	int64_t start = Trace::getTime();
+
+	if (name == "theme")
+	{
+		// Themes are cached : this measures the creation of the components and the application of the theme
+		for (int i = 0; i < amount; i++)
+			DetailedGameListView view(window, system->getRootFolder());
+	}
+	else if (name == "gamelist")
+		updateGamelist(system);
+	else if (name == "media")
+	{
+		// The client runs on a worker, so that the UI thread keeps rendering frames while the web server sends the file.
+		// update() waits for it before running the next action.
+		int port = Settings::getInstance()->getInt("HttpServerPort");
+
+		mPendingMeasure = measure;
+		mPendingMediaPath = mediaPath;
+		mMeasureDone = false;
+
+		mMeasureThread = new std::thread([amount, port, start]
+		{
+			httplib::Client client("127.0.0.1", port);
+
+			unsigned long long size = (unsigned long long)amount * 1024 * 1024;
+			unsigned long long received = 0;
+
+			auto response = client.Get("/resources/es-bench-media.bin", [&received](const char* /*data*/, size_t length) { received += length; return true; });
+			if (response == nullptr || response->status != 200 || received != size)
+				LOG(LogWarning) << "Benchmark : media download failed, " << received << " bytes of " << size << " received";
+
+			// A last byte past the end of the file is clamped to it
+			received = 0;
+			httplib::Headers headers = { httplib::make_range_header({ httplib::Range((ssize_t)size - 10, (ssize_t)size + 1000) }) };
+			response = client.Get("/resources/es-bench-media.bin", headers, [&received](const char* /*data*/, size_t length) { received += length; return true; });
+			if (response == nullptr || response->status != 206 || received != 10)
+				LOG(LogWarning) << "Benchmark : media range request failed, " << received << " bytes received instead of 10";
+
+			mPendingMeasure.duration = Trace::getTime() - start;
+			mMeasureDone = true;
+		});
+
+		return;
+	}
+
+	measure.duration = Trace::getTime() - start;
+	addMeasure(measure);
+}
+
+void Benchmark::finishPendingMeasure()
+{
+	mMeasureThread->join();
+	delete mMeasureThread;
+	mMeasureThread = nullptr;
+
+	Utils::FileSystem::removeFile(mPendingMediaPath);
+	addMeasure(mPendingMeasure);
+}
+
+void Benchmark::addMeasure(Measure& measure)
+{
+	measure.peakRss = MemoryAccounting::getPeakRss();
+	mMeasures.push_back(measure);
+
+	LOG(LogInfo) << "Benchmark : measure " << measure.name << " " << measure.amount << " took " << measure.duration / 1000 << "ms";
+}
+
+void Benchmark::update(Window* window)
+{
+	if (!mRunning)
+		return;
+
+	if (!mStarted)
+	{
+		mStarted = true;
+		markBoot("firstFrame");
+
+		InputConfig* keyboard = InputManager::getInstance()->getInputConfigByDevice(DEVICE_KEYBOARD);
+		if (keyboard != nullptr && !keyboard->isConfigured())
+			InputManager::getInstance()->loadDefaultKBConfig();
+
+		if (mActions.empty() || mActions[0].type != ACTION_SECTION)
+			beginSection("default");
+	}
+
+	while (mPosition < mActions.size())
+	{
+		if (mMeasureThread != nullptr)
+		{
+			if (!mMeasureDone)
+				return;
+
+			finishPendingMeasure();
+		}
+
+		if (mFramesToWait > 0)
+		{
+			mFramesToWait--;
+			return;
+		}
+
+		if (mWaitUntil > 0)
+		{
+			if (Trace::getTime() < mWaitUntil)
+				return;
+
+			mWaitUntil = 0;
+		}
+
+		auto& action = mActions[mPosition++];
+
+		switch (action.type)
+		{
+		case ACTION_KEYDOWN:
+			pushKey(action.value, true);
+			break;
+
+		case ACTION_KEYUP:
+			pushKey(action.value, false);
+			break;
+
+		case ACTION_WAIT:
+			mWaitUntil = Trace::getTime() + (int64_t)action.amount * 1000;
+			break;
+
+		case ACTION_FRAMES:
+			mFramesToWait = action.amount;
+			break;
+
+		case ACTION_SECTION:
+			beginSection(action.value);
+			break;
+
+		case ACTION_MEASURE:
+			runMeasure(window, action.value, action.amount);
+			break;
+
+		case ACTION_QUIT:
+			{
+				endSection();
+				writeReport();
+				mRunning = false;
+
+				SDL_Event quit;
+				memset(&quit, 0, sizeof(quit));
+				quit.type = SDL_QUIT;
+				SDL_PushEvent(&quit);
+			}
+			return;
+		}
+	}
+}
+
+void Benchmark::writeReport()
+{
+	rapidjson::StringBuffer s;
+	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+
+	// Times are in milliseconds, frame durations in microseconds
+	writer.StartObject();
+	writer.Key("script"); writer.String(mScriptPath.c_str());
+
+	if (mGeneratedLibrary)
+	{
+		writer.Key("library");
+		writer.StartObject();
+		writer.Key("systems"); writer.Int(mLibrarySystems);
+		writer.Key("games"); writer.Int(mLibraryGames);
+		writer.EndObject();
+	}
+
+	writer.Key("boot");
+	writer.StartObject();
+	for (auto& phase : mBootPhases)
+	{
+		writer.Key(phase.first.c_str());
+		writer.Double(phase.second / 1000.0);
+	}
+	writer.EndObject();
+
+	writer.Key("sections");
+	writer.StartArray();
+
+	for (auto& section : mSections)
+	{
+		writer.StartObject();
+		writer.Key("name"); writer.String(section.name.c_str());
+		writer.Key("duration"); writer.Double(section.duration / 1000.0);
+		writer.Key("stalls"); writer.Uint64(section.stats.stallCount);
+		writer.Key("heapInUse"); writer.Int64(section.heapInUse);
+
+		writer.Key("phases");
+		writer.StartObject();
+
+		for (int i = 0; i < FrameTimings::PHASE_COUNT; i++)
+		{
+			auto& phase = section.stats.phases[i];
+
+			writer.Key(FrameTimings::getPhaseName((FrameTimings::Phase)i));
+			writer.StartObject();
+			writer.Key("count"); writer.Uint64(phase.count);
+			writer.Key("mean"); writer.Int64(phase.mean);
+			writer.Key("p50"); writer.Int64(phase.p50);
+			writer.Key("p95"); writer.Int64(phase.p95);
+			writer.Key("p99"); writer.Int64(phase.p99);
+			writer.Key("max"); writer.Int64(phase.max);
+			writer.EndObject();
+		}
+
+		writer.EndObject();
+		writer.EndObject();
+	}
+
+	writer.EndArray();
+
+	if (!mMeasures.empty())
+	{
+		writer.Key("measures");
+		writer.StartArray();
+
+		for (auto& measure : mMeasures)
+		{
+			writer.StartObject();
+			writer.Key("name"); writer.String(measure.name.c_str());
+			writer.Key("amount"); writer.Int(measure.amount);
+			writer.Key("duration"); writer.Double(measure.duration / 1000.0);
+			writer.Key("peakRss"); writer.Int64(measure.peakRss);
+			writer.EndObject();
+		}
+
+		writer.EndArray();
+	}
+
+	writer.Key("memory");
+	writer.StartObject();
+	writer.Key("peakRss"); writer.Int64(MemoryAccounting::getPeakRss());
+	writer.Key("heapInUse"); writer.Int64(MemoryAccounting::getHeapInUse());
+	writer.EndObject();
+
+	writer.EndObject();
+
+	std::string report = s.GetString();
+
+	if (mOutputPath.empty())
+		std::cout << report << "\n";
+	else
+		Utils::FileSystem::writeAllText(mOutputPath, report);
+
+	LOG(LogInfo) << "Benchmark : finished" << (mOutputPath.empty() ? "" : ", report saved to " + mOutputPath);
+}
@@ -0,0 +1,122 @@
+#pragma once
+#ifndef ES_APP_BENCHMARK_H
+#define ES_APP_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include "FrameTimings.h"
+
+class Window;
+
+// Reproducible UI benchmark : emulationstation --benchmark <script> [--benchmark-output <file.json>] [--headless]
+//
+// The script is read line by line, '#' starts a comment :
+//   library <systems> <games>			generate a synthetic library in <script directory>/es-bench-home and use it as home path. Must be the first command.
+//   wait <ms>							do nothing for this time
+//   frames <count>						do nothing for this number of frames
+//   press <button> [count] [delay]		press and release a button (up, down, left, right, a, b, x, y, start, select, pageup, pagedown...) count times, waiting delay ms (100) after each press
+//   hold <button> <ms>					keep a button pressed
+//   section <name>						start measuring a new section of the report
+//   measure <name> <amount>			run a timed operation and add its duration to the report :
+//										theme <count>		build the detailed gamelist view of the first system count times
+//										gamelist <count>	change count games of the first system, then save its gamelist
+//										media <MB>			download a file of this size from the web server, then a clamped range of it, from a worker thread.
+//															Only with a generated library. Check the peakRss of the measure.
+//   quit								write the report and exit
+//
+// Buttons are sent as SDL keyboard events, using the keyboard mapping of InputManager (the default one if the keyboard isn't configured).
+// The report contains the boot phases, the frame time percentiles of every section, the heap usage and the peak RSS.
+class Benchmark
+{
+public:
+	// Called before the settings are loaded : may change the home path
+	static bool load(const std::string& scriptPath);
+	static void setOutputPath(const std::string& path) { mOutputPath = path; }
+	static void setHeadless();
+
+	static bool isRunning() { return mRunning; }
+
+	// Time since startup, recorded in the report
+	static void markBoot(const std::string& phase);
+
+	// Main loop, once per frame
+	static void update(Window* window);
+
+private:
+	enum ActionType
+	{
+		ACTION_KEYDOWN,
+		ACTION_KEYUP,
+		ACTION_WAIT,
+		ACTION_FRAMES,
+		ACTION_SECTION,
+		ACTION_MEASURE,
+		ACTION_QUIT
+	};
+
+	struct Action
+	{
+		ActionType type;
+		std::string value; // Button, section or measure name
+		int amount; // Milliseconds, frames, or measure amount
+	};
+
+	struct Measure
+	{
+		std::string name;
+		int amount;
+		int64_t duration;
+		int64_t peakRss;
+	};
+
+	struct Section
+	{
+		std::string name;
+		int64_t start;
+		int64_t duration;
+		int64_t heapInUse;
+		FrameTimings::Stats stats;
+	};
+
+	static bool parseScript(const std::string& scriptPath);
+	static bool generateLibrary(const std::string& path, int systems, int games);
+	static void pinSettings();
+
+	static void pushKey(const std::string& button, bool pressed);
+	static void beginSection(const std::string& name);
+	static void endSection();
+	static void runMeasure(Window* window, const std::string& name, int amount);
+	static void finishPendingMeasure();
+	static void addMeasure(Measure& measure);
+	static void writeReport();
+
+	static std::vector<Action> mActions;
+	static size_t mPosition;
+	static int64_t mWaitUntil;
+	static int mFramesToWait;
+
+	static bool mRunning;
+	static bool mStarted;
+	static bool mGeneratedLibrary;
+	static int mLibrarySystems;
+	static int mLibraryGames;
+
+	static std::string mScriptPath;
+	static std::string mOutputPath;
+
+	static std::vector<std::pair<std::string, int64_t>> mBootPhases;
+	static std::vector<Section> mSections;
+	static std::vector<Measure> mMeasures;
+	static bool mSectionOpened;
+
+	// Measure running on a worker
+	static std::thread* mMeasureThread;
+	static std::atomic<bool> mMeasureDone;
+	static Measure mPendingMeasure;
+	static std::string mPendingMediaPath;
+};
+
+#endif // ES_APP_BENCHMARK_H
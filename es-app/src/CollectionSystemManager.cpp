@@ -324,6 +324,29 @@ void CollectionSystemManager::saveCustomCollection(SystemData* sys)
 		{
 			std::string relativeTo = Paths::getRootPath();
 
+			// Games of the systems which are still loading in background can't be in the collection yet : keep them from the current file
+			std::vector<std::string> pendingGames;
+
+			auto pendingSystems = SystemData::getPendingSystems();
+			if (pendingSystems.size() > 0)
+			{
+				std::ifstream input(getCustomCollectionConfigPath(name));
+				for (std::string gameKey; getline(input, gameKey); )
+				{
+					gameKey = Utils::String::trim(gameKey);
+
+					std::string path = Utils::FileSystem::resolveRelativePath(gameKey, relativeTo, true);
+					for (auto system : pendingSystems)
+					{
+						if (Utils::String::startsWith(path, system->getStartPath() + "/"))
+						{
+							pendingGames.push_back(gameKey);
+							break;
+						}
+					}
+				}
+			}
+
 			std::ofstream configFile;
 			configFile.open(getCustomCollectionConfigPath(name));
 			for (auto iter = games.cbegin(); iter != games.cend(); ++iter)
@@ -336,6 +359,9 @@ void CollectionSystemManager::saveCustomCollection(SystemData* sys)
 				configFile << path << std::endl;
 			}
 
+			for (auto path : pendingGames)
+				configFile << path << std::endl;
+
 			configFile.close();
 		}
 	}
@@ -433,6 +459,46 @@ void CollectionSystemManager::updateSystemsList()
 	}
 }
 
+// Rebuilds the populated collections once the systems loaded in background have their games
+void CollectionSystemManager::repopulateCollections()
+{
+	std::vector<CollectionSystemData*> editedCollections;
+
+	for (auto collections : { &mAutoCollectionSystemsData, &mCustomCollectionSystemsData })
+	{
+		for (auto& item : *collections)
+		{
+			CollectionSystemData* data = &item.second;
+			if (!data->isPopulated)
+				continue;
+
+			ViewController::get()->removeGameListView(data->system);
+
+			// Unsaved custom collections keep their content : only games of the systems loaded in background are added
+			if (data->decl.isCustom && data->filteredIndex == nullptr && data->needsSave)
+			{
+				editedCollections.push_back(data);
+				continue;
+			}
+
+			data->system->getRootFolder()->clear();
+			data->system->resetIndex();
+			data->system->updateDisplayedGameCount();
+			data->isPopulated = false;
+		}
+	}
+
+	ViewController::get()->removeGameListView(mCustomCollectionsBundle);
+
+	for (auto data : editedCollections)
+	{
+		populateCustomCollection(data, nullptr, true);
+		data->system->updateDisplayedGameCount();
+	}
+
+	updateSystemsList();
+}
+
 /* Methods to manage collection files related to a source FileData */
 // updates all collection files related to the source file
 void CollectionSystemManager::refreshCollectionSystems(FileData* file)
@@ -505,7 +571,7 @@ void CollectionSystemManager::updateCollectionSystem(FileData* file, const Colle
 	}
 	
 	if (view != nullptr)
-		view->onFileChanged(rootFolder, name == "recent" || collectionEntry == nullptr ? FILE_METADATA_CHANGED : FILE_SORTED);
+		ViewController::get()->onGameListChanged(curSys, rootFolder, name == "recent" || collectionEntry == nullptr ? FILE_METADATA_CHANGED : FILE_SORTED);
 }
 
 void CollectionSystemManager::sortLastPlayed(SystemData* system)
@@ -973,9 +1039,8 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 		std::vector<PlatformIds::PlatformId> platforms = system->getPlatformIds();
 		bool isArcade = std::find(platforms.begin(), platforms.end(), PlatformIds::ARCADE) != platforms.end();
 
-		std::vector<std::string> hiddenExts;
-		for (auto ext : Utils::String::split(Settings::getInstance()->getString(system->getName() + ".HiddenExt"), ';'))
-			hiddenExts.push_back("." + Utils::String::toLower(ext));
+		auto settings = system->getSettings();
+		auto& hiddenExts = settings->hiddenExtensions;
 
 		std::vector<FileData*> files = system->getRootFolder()->getFilesRecursive(GAME);
 		for (auto& game : files)
@@ -989,8 +1054,8 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 
 			if (hiddenExts.size() > 0 && game->getType() == GAME)
 			{
-				std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(game->getFileName()));
-				if (std::find(hiddenExts.cbegin(), hiddenExts.cend(), extlow) != hiddenExts.cend())
+				std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(game->getFileName(), false));
+				if (hiddenExts.find(extlow) != hiddenExts.cend())
 					continue;
 			}
 
@@ -1077,7 +1142,7 @@ void CollectionSystemManager::populateAutoCollection(CollectionSystemData* sysDa
 }
 
 // populates a Custom Collection System
-void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sysData, std::unordered_map<std::string, FileData*>* pMap)
+void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sysData, std::unordered_map<std::string, FileData*>* pMap, bool backgroundSystemsOnly)
 {
 	SystemData* newSys = sysData->system;
 	sysData->isPopulated = true;
@@ -1160,6 +1225,9 @@ void CollectionSystemManager::populateCustomCollection(CollectionSystemData* sys
 			if (std::find(hiddenSystems.cbegin(), hiddenSystems.cend(), it->second->getName()) != hiddenSystems.cend())
 				continue;
 
+			if (backgroundSystemsOnly && (!it->second->getSourceFileData()->getSystem()->isLoadedInBackground() || rootFolder->FindByPath(it->second->getFullPath()) != nullptr))
+				continue;
+
 			CollectionFileData* newGame = new CollectionFileData(it->second, newSys);
 			rootFolder->addChild(newGame);
 			newSys->addToIndex(newGame);
@@ -74,6 +74,7 @@ public:
 	void loadCollectionSystems();
 	void loadEnabledListFromSettings();
 	void updateSystemsList();
+	void repopulateCollections();
 
 	void refreshCollectionSystems(FileData* file);
 	void updateCollectionSystem(FileData* file, const CollectionSystemData& sysData);
@@ -117,7 +118,7 @@ private:
 	SystemData* getAllGamesCollection();
 	SystemData* createNewCollectionEntry(std::string name, CollectionSystemDecl sysDecl, bool index = true, bool needSave = true);
 
-	void populateCustomCollection(CollectionSystemData* sysData, std::unordered_map<std::string, FileData*>* pMap = nullptr);
+	void populateCustomCollection(CollectionSystemData* sysData, std::unordered_map<std::string, FileData*>* pMap = nullptr, bool backgroundSystemsOnly = false);
 
 	void removeCollectionsFromDisplayedSystems();
 	void addEnabledCollectionsToDisplayedSystems(std::map<std::string, CollectionSystemData>* colSystemData, std::unordered_map<std::string, FileData*>* pMap);
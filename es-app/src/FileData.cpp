@@ -8,6 +8,7 @@
 #include "FileFilterIndex.h"
 #include "FileSorts.h"
 #include "Log.h"
+#include "Trace.h"
 #include "MameNames.h"
 #include "utils/Platform.h"
 #include "Scripting.h"
@@ -23,7 +24,10 @@
 #include "ApiSystem.h"
 #include <time.h>
 #include <algorithm>
+#include <mutex>
+#include <atomic>
 #include "LangParser.h"
+#include "utils/md5.h"
 #include "resources/ResourceManager.h"
 #include "RetroAchievements.h"
 #include "SaveStateRepository.h"
@@ -33,6 +37,11 @@
 #include "guis/GuiMsgBox.h"
 #include "Paths.h"
 #include "resources/TextureData.h"
+#include "MemoryAccounting.h"
+
+// ArcadeRomType device bits never reach 0xFF
+#define DEVICE_FLAGS_UNKNOWN 0xFF
+#define RESUME_TARGET_MS 500 // Time between the emulator exit and the first frames of the interface
 
 using namespace Utils::Platform;
 
@@ -61,14 +70,30 @@ static std::map<std::string, std::function<BindableProperty(FileData*)>> propert
 
 FileData* FileData::mRunningGame = nullptr;
 
+// Games waiting for their post-game idle task : a game deleted meanwhile (e.g. by a gamelist reload) is forgotten
+static std::unordered_set<FileData*> sPendingIdleUpdates;
+static std::atomic<int> sPendingIdleUpdateCount(0);
+static std::mutex sPendingIdleUpdatesLock;
+
+static bool takePendingIdleUpdate(FileData* file)
+{
+	std::unique_lock<std::mutex> lock(sPendingIdleUpdatesLock);
+	if (sPendingIdleUpdates.erase(file) == 0)
+		return false;
+
+	sPendingIdleUpdateCount = (int)sPendingIdleUpdates.size();
+	return true;
+}
+
 FileData::FileData(FileType type, const std::string& path, SystemData* system)
-	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
+	: mPath(path), mType(type), mSystem(system), mParent(nullptr), mDisplayName(nullptr), mGameId(nullptr), mDeviceFlags(DEVICE_FLAGS_UNKNOWN), mMetadata(type == GAME ? GAME_METADATA : FOLDER_METADATA) // metadata is REALLY set in the constructor!
 {
 	// metadata needs at least a name field (since that's what getName() will return)
 	if (mMetadata.get(MetaDataId::Name).empty() && !mPath.empty())
 		mMetadata.set(MetaDataId::Name, getDisplayName());
 	
 	mMetadata.resetChangedFlag();
+	mMetadata.setOwner(this);
 }
 
 const std::string FileData::getPath() const
@@ -134,11 +159,60 @@ FileData::~FileData()
 	if (mDisplayName)
 		delete mDisplayName;
 
+	if (mGameId)
+		delete mGameId;
+
 	if (mParent)
 		mParent->removeChild(this);
 
 	if (mType == GAME)
 		mSystem->removeFromIndex(this);
+
+	if (sPendingIdleUpdateCount > 0)
+		takePendingIdleUpdate(this);
+
+	// Unregister from the system's dirty files
+	if (mMetadata.wasChanged())
+		mMetadata.resetChangedFlag();
+}
+
+size_t FileData::getMemoryUsage() const
+{
+	size_t size = sizeof(FileData);
+
+	if (mType == FOLDER)
+		size = sizeof(FolderData) + ((FolderData*)this)->mChildren.capacity() * sizeof(FileData*);
+
+	size += MemoryAccounting::getStringSize(mPath);
+	size += mMetadata.getMemoryUsage();
+
+	if (mDisplayName != nullptr)
+		size += sizeof(std::string) + MemoryAccounting::getStringSize(*mDisplayName);
+
+	if (mGameId != nullptr)
+		size += sizeof(std::string) + MemoryAccounting::getStringSize(*mGameId);
+
+	return size;
+}
+
+const std::string& FileData::getGameId()
+{
+	// Collection entries share the id of their source game
+	FileData* source = getSourceFileData();
+	if (source != this)
+		return source->getGameId();
+
+	if (mGameId == nullptr)
+	{
+		std::string path = getPath();
+
+		MD5 md5;
+		md5.update(path.c_str(), path.size());
+		md5.finalize();
+		mGameId = new std::string(md5.hexdigest());
+	}
+
+	return *mGameId;
 }
 
 std::string& FileData::getDisplayName()
@@ -433,27 +507,35 @@ const bool FileData::isVerticalArcadeGame()
 	return false;
 }
 
+unsigned int FileData::getDeviceFlags()
+{
+	if (mDeviceFlags == DEVICE_FLAGS_UNKNOWN)
+		mDeviceFlags = (unsigned char)MameNames::getInstance()->getDeviceFlags(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+
+	return mDeviceFlags;
+}
+
 const bool FileData::isLightGunGame()
 {
-	return MameNames::getInstance()->isLightgun(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getDeviceFlags() & (unsigned int)ArcadeRomType::LIGHTGUN) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_LIGHTGUN);
 }
 
 const bool FileData::isWheelGame()
 {
-	return MameNames::getInstance()->isWheel(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getDeviceFlags() & (unsigned int)ArcadeRomType::WHEEL) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_WHEEL);
 }
 
 const bool FileData::isTrackballGame()
 {
-	return MameNames::getInstance()->isTrackball(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getDeviceFlags() & (unsigned int)ArcadeRomType::TRACKBALL) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_TRACKBALL);
 }
 
 const bool FileData::isSpinnerGame()
 {
-	return MameNames::getInstance()->isSpinner(Utils::FileSystem::getStem(getPath()), mSystem->getName(), mSystem && mSystem->hasPlatformId(PlatformIds::ARCADE));
+	return (getDeviceFlags() & (unsigned int)ArcadeRomType::SPINNER) != 0;
 	//return Genres::genreExists(&getMetadata(), GENRE_SPINNER);
 }
 
@@ -718,6 +800,9 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 
 	mRunningGame = gameToUpdate;
 
+	// The UI thread is blocked until the emulator exits : don't leave journal records unsynced meanwhile
+	syncGamelistJournals(true);
+
 	ProcessStartInfo process(command);
 	process.window = hideWindow ? NULL : window;
 	
@@ -727,6 +812,8 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 
 	mRunningGame = nullptr;
 
+	int64_t resumeStart = Trace::getTime();
+
 	if (SaveStateRepository::isEnabled(this))
 	{
 		if (options.saveStateInfo != nullptr)
@@ -742,7 +829,7 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 	
 	if (!hideWindow && Settings::getInstance()->getBool("HideWindowFullReinit"))
 	{
-		ResourceManager::getInstance()->reloadAll();
+		// Resources are still unloaded : deinit keeps them flagged for reloading, so that they are reloaded once by init
 		window->deinit();
 		window->init();
 		window->setCustomSplashScreen(gameToUpdate->getImagePath(), gameToUpdate->getName(), gameToUpdate);
@@ -755,6 +842,15 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 
 	window->normalizeNextUpdate();
 
+	LOG(LogInfo) << "Interface reinitialized in " << (Trace::getTime() - resumeStart) / 1000 << "ms";
+
+	// Idle tasks run once the frames following the post have been rendered : the interface is responsive again
+	window->postIdleTask([resumeStart]
+	{
+		int64_t elapsed = (Trace::getTime() - resumeStart) / 1000;
+		LOG(elapsed > RESUME_TARGET_MS ? LogWarning : LogInfo) << "Interface resumed in " << elapsed << "ms (target " << RESUME_TARGET_MS << "ms)";
+	});
+
 	//update number of times the game has been launched
 	if (exitCode == 0)
 	{
@@ -771,8 +867,24 @@ bool FileData::launchGame(Window* window, LaunchGameOptions options)
 
 		//update last played time
 		gameToUpdate->setMetadata(MetaDataId::LastPlayed, Utils::Time::DateTime(Utils::Time::now()));
-		CollectionSystemManager::get()->refreshCollectionSystems(gameToUpdate);
+
+		// A single journal record : written now so that the statistics survive a crash before the idle task runs
 		saveToGamelistRecovery(gameToUpdate);
+
+		// Not needed to display the first frames
+		{
+			std::unique_lock<std::mutex> lock(sPendingIdleUpdatesLock);
+			sPendingIdleUpdates.insert(gameToUpdate);
+			sPendingIdleUpdateCount = (int)sPendingIdleUpdates.size();
+		}
+
+		window->postIdleTask([gameToUpdate]
+		{
+			if (!takePendingIdleUpdate(gameToUpdate))
+				return;
+
+			CollectionSystemManager::get()->refreshCollectionSystems(gameToUpdate);
+		});
 	}
 
 	window->reactivateGui();
@@ -991,17 +1103,34 @@ const std::string& CollectionFileData::getName()
 	return mSourceFileData->getName();
 }
 
+void FolderData::setPreparedChildrenListToDisplay(const std::vector<FileData*>* list)
+{
+	if (mPreparedChildrenList != nullptr)
+	{
+		delete mPreparedChildrenList;
+		mPreparedChildrenList = nullptr;
+	}
+
+	if (list != nullptr)
+		mPreparedChildrenList = new std::vector<FileData*>(*list);
+}
+
 const std::vector<FileData*> FolderData::getChildrenListToDisplay() 
 {
+	if (mPreparedChildrenList != nullptr)
+	{
+		std::vector<FileData*> prepared = std::move(*mPreparedChildrenList);
+		setPreparedChildrenListToDisplay(nullptr);
+		return prepared;
+	}
+
+	TRACE_SCOPE_DETAIL("FolderData::getChildrenListToDisplay", getSystem()->getName());
+
 	std::vector<FileData*> ret;
 
 	std::string showFoldersMode = getSystem()->getFolderViewMode();
 	
-	bool showHiddenFiles = Settings::ShowHiddenFiles();
-
-	auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHiddenFiles = true;
-	else if (shv == "0") showHiddenFiles = false;
+	bool showHiddenFiles = getSystem()->getSettings()->showHiddenFiles;
 
 	bool filterKidGame = false;
 
@@ -1016,9 +1145,11 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 
 	auto sys = CollectionSystemManager::get()->getSystemToView(mSystem);
 
-	std::vector<std::string> hiddenExts;
-	if (mSystem->isGameSystem() && !mSystem->isCollection())
-		hiddenExts = Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(mSystem->getName() + ".HiddenExt")), ';');
+	auto systemSettings = mSystem->getSettings();
+
+	const std::set<std::string>* hiddenExts = nullptr;
+	if (mSystem->isGameSystem() && !mSystem->isCollection() && systemSettings->hiddenExtensions.size() > 0)
+		hiddenExts = &systemSettings->hiddenExtensions;
 
 	FileFilterIndex* idx = sys->getIndex(false);
 	if (idx != nullptr && !idx->isFiltered())
@@ -1045,10 +1176,10 @@ const std::vector<FileData*> FolderData::getChildrenListToDisplay()
 		if (filterKidGame && (*it)->getType() == GAME && !(*it)->getKidGame())
 			continue;
 
-		if (hiddenExts.size() > 0 && (*it)->getType() == GAME)
+		if (hiddenExts != nullptr && (*it)->getType() == GAME)
 		{
 			std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension((*it)->getFileName(), false));
-			if (std::find(hiddenExts.cbegin(), hiddenExts.cend(), extlow) != hiddenExts.cend())
+			if (hiddenExts->find(extlow) != hiddenExts->cend())
 				continue;
 		}
 
@@ -1174,11 +1305,9 @@ FileData* FolderData::findUniqueGameForFolder()
 	{
 		if (game->getHidden())
 		{
-			bool showHiddenFiles = Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
+			auto settings = getSystem()->getSettings();
 
-			auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-			if (shv == "1") showHiddenFiles = true;
-			else if (shv == "0") showHiddenFiles = false;
+			bool showHiddenFiles = settings->showHiddenFilesOverride >= 0 ? settings->showHiddenFilesOverride == 1 : Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
 
 			if (!showHiddenFiles)
 				continue;
@@ -1235,10 +1364,10 @@ void FolderData::getFilesRecursiveWithContext(std::vector<FileData*>& out, unsig
 					if (filter->filterKidGame && it->getKidGame())
 						continue;
 
-					if (typeMask == GAME && filter->hiddenExtensions.size() > 0)
+					if (typeMask == GAME && filter->hiddenExtensions != nullptr)
 					{
 						std::string extlow = Utils::String::toLower(Utils::FileSystem::getExtension(it->getFileName(), false));
-						if (filter->hiddenExtensions.find(extlow) != filter->hiddenExtensions.cend())
+						if (filter->hiddenExtensions->find(extlow) != filter->hiddenExtensions->cend())
 							continue;
 					}
 				}
@@ -1274,21 +1403,15 @@ std::vector<FileData*> FolderData::getFilesRecursive(unsigned int typeMask, bool
 {
 	SystemData* pSystem = (system != nullptr ? system : mSystem);
 	
-	GetFileContext ctx;
-	ctx.showHiddenFiles = Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
+	auto settings = getSystem()->getSettings();
 
-	auto shv = Settings::getInstance()->getString(getSystem()->getName() + ".ShowHiddenFiles");
-	if (shv == "1")
-		ctx.showHiddenFiles = true;
-	else if (shv == "0")
-		ctx.showHiddenFiles = false;
+	GetFileContext ctx;
+	ctx.showHiddenFiles = settings->showHiddenFilesOverride >= 0 ? settings->showHiddenFilesOverride == 1 : Settings::ShowHiddenFiles() && !UIModeController::getInstance()->isUIModeKiosk();
+	ctx.hiddenExtensions = nullptr;
 
-	if (pSystem->isGameSystem() && !pSystem->isCollection())
-	{
-		for (auto ext : Utils::String::split(Utils::String::toLower(Settings::getInstance()->getString(pSystem->getName() + ".HiddenExt")), ';'))
-			if (ctx.hiddenExtensions.find(ext) == ctx.hiddenExtensions.cend())
-				ctx.hiddenExtensions.insert(ext);
-	}
+	auto systemSettings = pSystem->getSettings();
+	if (pSystem->isGameSystem() && !pSystem->isCollection() && systemSettings->hiddenExtensions.size() > 0)
+		ctx.hiddenExtensions = &systemSettings->hiddenExtensions;
 
 	ctx.filterKidGame = UIModeController::getInstance()->isUIModeKid();
 
@@ -1307,6 +1430,9 @@ void FolderData::addChild(FileData* file, bool assignParent)
 
 	if (assignParent)
 		file->setParent(this);	
+
+	if (mSystem != nullptr)
+		mSystem->onFilesChanged();
 }
 
 void FolderData::removeChild(FileData* file)
@@ -1322,6 +1448,9 @@ void FolderData::removeChild(FileData* file)
 		file->setParent(nullptr);
 		std::iter_swap(it, mChildren.end() - 1);
 		mChildren.pop_back();
+
+		if (mSystem != nullptr)
+			mSystem->onFilesChanged();
 	}
 
 	// File somehow wasn't in our children.
@@ -1348,6 +1477,9 @@ void FolderData::bulkRemoveChildren(std::vector<FileData*>& mChildren, const std
 		),
 		mChildren.end()
 	);
+
+	if (mSystem != nullptr && !filesToRemove.empty())
+		mSystem->onFilesChanged();
 }
 
 FileData* FolderData::FindByPath(const std::string& path)
@@ -1743,11 +1875,13 @@ FolderData::FolderData(const std::string& startpath, SystemData* system, bool ow
 {
 	mIsDisplayableAsVirtualFolder = false;
 	mOwnsChildrens = ownsChildrens;
+	mPreparedChildrenList = nullptr;
 }
 
 FolderData::~FolderData()
 {
 	clear();
+	setPreparedChildrenListToDisplay(nullptr);
 }
 
 void FolderData::clear() {
@@ -45,7 +45,7 @@ struct GetFileContext
 {
 	bool showHiddenFiles;
 	bool filterKidGame;
-	std::set<std::string> hiddenExtensions;
+	const std::set<std::string>* hiddenExtensions; // Owned by the system settings, may be null
 };
 
 struct LaunchGameOptions
@@ -127,6 +127,7 @@ public:
   	const bool isWheelGame();
     	const bool isTrackballGame();
       	const bool isSpinnerGame();
+	unsigned int getDeviceFlags();
 	inline std::string getFullPath() { return getPath(); };
 	inline std::string getFileName() { return Utils::FileSystem::getFileName(getPath()); };
 	virtual FileData* getSourceFileData();
@@ -135,6 +136,9 @@ public:
 	// Returns our best guess at the "real" name for this file (will attempt to perform MAME name translation)
 	virtual std::string& getDisplayName();
 
+	// Id of the game in the web api, the md5 of its path. Computed once, UI thread only.
+	const std::string& getGameId();
+
 	// As above, but also remove parenthesis
 	std::string getCleanName();
 
@@ -148,7 +152,14 @@ public:
 	virtual const MetaDataList& getMetadata() const { return mMetadata; }
 	virtual MetaDataList& getMetadata() { return mMetadata; }
 
-	void setMetadata(MetaDataList value) { getMetadata() = value; } 
+	void setMetadata(MetaDataList value) 
+	{ 
+		getMetadata() = value; 
+		getMetadata().touch();
+
+		if (getMetadata().wasChanged())
+			getMetadata().setDirty();
+	} 
 	
 	std::string getMetadata(MetaDataId key) const { return getMetadata().get(key); }
 	void setMetadata(MetaDataId key, const std::string& value) { return getMetadata().set(key, value); }
@@ -186,6 +197,9 @@ public:
 
 	std::string getGenre();
 
+	// Estimated bytes of the file and its metadata, children excluded
+	size_t getMemoryUsage() const;
+
 private:
 	std::string getKeyboardMappingFilePath();
 	std::string getMessageFromExitCode(int exitCode);
@@ -201,6 +215,8 @@ protected:
 	FileType mType;
 	SystemData* mSystem;
 	std::string* mDisplayName;
+	std::string* mGameId;
+	unsigned char mDeviceFlags; // ArcadeRomType device bits, computed on first use
 };
 
 class CollectionFileData : public FileData
@@ -244,6 +260,8 @@ public:
 
 	inline const std::vector<FileData*>& getChildren() const { return mChildren; }
 	const std::vector<FileData*> getChildrenListToDisplay();
+	// List computed in advance on a worker thread : returned once by the next getChildrenListToDisplay, nullptr drops it
+	void setPreparedChildrenListToDisplay(const std::vector<FileData*>* list);
 	std::shared_ptr<std::vector<FileData*>> findChildrenListToDisplayAtCursor(FileData* toFind, std::stack<FileData*>& stack);
 
 	std::vector<FileData*> getFilesRecursive(unsigned int typeMask, bool displayedOnly = false, SystemData* system = nullptr, bool includeVirtualStorage = true) const;
@@ -266,6 +284,7 @@ private:
 
 
 	std::vector<FileData*> mChildren;
+	std::vector<FileData*>* mPreparedChildrenList;
 	bool	mOwnsChildrens;
 	bool	mIsDisplayableAsVirtualFolder;
 };
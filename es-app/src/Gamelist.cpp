@@ -5,15 +5,24 @@
 #include "FileData.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "Trace.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include <pugixml/src/pugixml.hpp>
 #include "Genres.h"
 #include "Paths.h"
+#include "utils/ZipFile.h"
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
 
 #ifdef WIN32
 #include <Windows.h>
 #include <direct.h>
+#include <io.h>
 #else
 #include <unistd.h>
 #endif
@@ -23,14 +32,176 @@ std::string getGamelistRecoveryPath(SystemData* system)
 	return Utils::FileSystem::getGenericPath(Paths::getUserEmulationStationPath() + "/recovery/" + system->getName());
 }
 
+// Metadata journal : every metadata change appends a checksummed record to <recovery path>/metadata.journal.
+// Records are replayed at boot, and the journal is deleted once the changes are written to gamelist.xml.
+//
+// File   : "ESJL" + version (uint32)
+// Record : payload size (uint32) + payload crc32 (uint32) + payload
+// Payload: type (uint8) + game path + '\0' + <gameList> xml (JOURNAL_METADATA only)
+
+#define JOURNAL_FILENAME	"metadata.journal"
+#define JOURNAL_MAGIC		"ESJL"
+#define JOURNAL_VERSION		1
+#define JOURNAL_SYNC_DELAY	2000 // Minimum delay between two fsync (ms)
+
+enum JournalRecordType : unsigned char
+{
+	JOURNAL_METADATA = 1,
+	JOURNAL_REMOVE = 2
+};
+
+struct GamelistJournal
+{
+	FILE* file;
+	std::chrono::steady_clock::time_point lastSync;
+	bool needSync;
+};
+
+static std::map<std::string, GamelistJournal> sJournals;
+static std::mutex sJournalsLock;
+
+static std::string getGamelistJournalPath(SystemData* system)
+{
+	return getGamelistRecoveryPath(system) + "/" + JOURNAL_FILENAME;
+}
+
+static void syncJournalFile(FILE* file)
+{
+#ifdef WIN32
+	_commit(_fileno(file));
+#else
+	fsync(fileno(file));
+#endif
+}
+
+static void closeGamelistJournal(SystemData* system)
+{
+	std::unique_lock<std::mutex> lock(sJournalsLock);
+
+	auto it = sJournals.find(system->getName());
+	if (it == sJournals.cend())
+		return;
+
+	if (it->second.needSync)
+		syncJournalFile(it->second.file);
+
+	fclose(it->second.file);
+	sJournals.erase(it);
+}
+
+static bool appendToGamelistJournal(SystemData* system, JournalRecordType type, const std::string& path, const std::string& xml = "")
+{
+	std::unique_lock<std::mutex> lock(sJournalsLock);
+
+	auto it = sJournals.find(system->getName());
+	if (it == sJournals.cend())
+	{
+		std::string journalPath = getGamelistJournalPath(system);
+
+		std::string folder = Utils::FileSystem::getParent(journalPath);
+		if (!Utils::FileSystem::exists(folder))
+			Utils::FileSystem::createDirectory(folder);
+
+		bool exists = Utils::FileSystem::exists(journalPath);
+
+#if WIN32
+		FILE* file = _wfopen(WINSTRINGW(journalPath).c_str(), L"ab");
+#else
+		FILE* file = fopen(journalPath.c_str(), "ab");
+#endif
+		if (file == nullptr)
+		{
+			LOG(LogError) << "Error opening metadata journal \"" << journalPath << "\"";
+			return false;
+		}
+
+		// Unbuffered : each record goes to the file with a single write
+		setvbuf(file, nullptr, _IONBF, 0);
+
+		if (!exists)
+		{
+			unsigned int version = JOURNAL_VERSION;
+
+			std::string header(JOURNAL_MAGIC);
+			header.append((const char*)&version, sizeof(version));
+			fwrite(header.data(), 1, header.size(), file);
+		}
+
+		GamelistJournal journal;
+		journal.file = file;
+		journal.lastSync = std::chrono::steady_clock::now();
+		journal.needSync = true;
+
+		it = sJournals.insert(std::pair<std::string, GamelistJournal>(system->getName(), journal)).first;
+	}
+
+	std::string payload;
+	payload.reserve(1 + path.size() + 1 + xml.size());
+	payload += (char)type;
+	payload += path;
+	payload += '\0';
+	payload += xml;
+
+	unsigned int size = (unsigned int)payload.size();
+	unsigned int crc = Utils::Zip::ZipFile::computeCRC(0, payload.data(), payload.size());
+
+	std::string record;
+	record.reserve(sizeof(size) + sizeof(crc) + payload.size());
+	record.append((const char*)&size, sizeof(size));
+	record.append((const char*)&crc, sizeof(crc));
+	record.append(payload);
+
+	if (fwrite(record.data(), 1, record.size(), it->second.file) != record.size())
+	{
+		LOG(LogError) << "Error writing metadata journal for system " << system->getName();
+		return false;
+	}
+
+	// Batch fsync calls : the last records of a burst are synced by syncGamelistJournals
+	auto now = std::chrono::steady_clock::now();
+	if (std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.lastSync).count() >= JOURNAL_SYNC_DELAY)
+	{
+		syncJournalFile(it->second.file);
+		it->second.lastSync = now;
+		it->second.needSync = false;
+	}
+	else
+		it->second.needSync = true;
+
+	return true;
+}
+
+void syncGamelistJournals(bool force)
+{
+	std::unique_lock<std::mutex> lock(sJournalsLock);
+	if (sJournals.empty())
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+
+	for (auto& journal : sJournals)
+	{
+		if (!journal.second.needSync)
+			continue;
+
+		if (!force && std::chrono::duration_cast<std::chrono::milliseconds>(now - journal.second.lastSync).count() < JOURNAL_SYNC_DELAY)
+			continue;
+
+		syncJournalFile(journal.second.file);
+		journal.second.lastSync = now;
+		journal.second.needSync = false;
+	}
+}
+
 FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType type, std::unordered_map<std::string, FileData*>& fileMap)
 {
 	auto pGame = fileMap.find(path);
 	if (pGame != fileMap.end())
 		return pGame->second;
 
-	// first, verify that path is within the system's root folder
-	FolderData* root = system->getRootFolder();
+	// first, verify that path is within the system's root folder. Systems loaded in background build their tree in a detached root folder
+	auto pRoot = fileMap.find(system->getStartPath());
+	FolderData* root = (pRoot != fileMap.end() && pRoot->second->getType() == FOLDER) ? (FolderData*)pRoot->second : system->getRootFolder();
 	bool contains = false;
 	std::string relative = Utils::FileSystem::removeCommonPath(path, root->getPath(), contains);
 
@@ -106,28 +277,10 @@ FileData* findOrCreateFile(SystemData* system, const std::string& path, FileType
 	return NULL;
 }
 
-std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
-{	
+static std::vector<FileData*> loadGamelistRoot(pugi::xml_node root, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
+{
 	std::vector<FileData*> ret;
 
-	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
-
-	pugi::xml_document doc;
-	pugi::xml_parse_result result = fromFile ? doc.load_file(WINSTRINGW(xmlpath).c_str()) : doc.load_string(xmlpath.c_str());
-
-	if (!result)
-	{
-		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
-		return ret;
-	}
-
-	pugi::xml_node root = doc.child("gameList");
-	if (!root)
-	{
-		LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
-		return ret;
-	}
-
 	if (checkSize != SIZE_MAX)
 	{
 		auto parentSize = root.attribute("parentHash").as_uint();
@@ -208,23 +361,133 @@ std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* s
 	return ret;
 }
 
+std::vector<FileData*> loadGamelistFile(const std::string xmlpath, SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize, bool fromFile)
+{	
+	LOG(LogInfo) << "Parsing XML file \"" << xmlpath << "\"...";
+
+	pugi::xml_document doc;
+	pugi::xml_parse_result result = fromFile ? doc.load_file(WINSTRINGW(xmlpath).c_str()) : doc.load_string(xmlpath.c_str());
+
+	if (!result)
+	{
+		LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
+		return std::vector<FileData*>();
+	}
+
+	pugi::xml_node root = doc.child("gameList");
+	if (!root)
+	{
+		LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlpath << "\"!";
+		return std::vector<FileData*>();
+	}
+
+	return loadGamelistRoot(root, system, fileMap, checkSize, fromFile);
+}
+
+// Sequential scan of the journal : the last record of each game wins. Stops at the first incomplete or corrupted record.
+static void loadGamelistJournal(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap, size_t checkSize)
+{
+	std::string journalPath = getGamelistJournalPath(system);
+	if (!Utils::FileSystem::exists(journalPath))
+		return;
+
+	std::ifstream stream(WINSTRINGW(journalPath), std::ios::in | std::ios::binary);
+	std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	stream.close();
+
+	const size_t headerSize = 4 + sizeof(unsigned int);
+
+	unsigned int version = 0;
+	if (data.size() >= headerSize)
+		memcpy(&version, data.data() + 4, sizeof(version));
+
+	if (data.size() < headerSize || data.compare(0, 4, JOURNAL_MAGIC) != 0 || version != JOURNAL_VERSION)
+	{
+		LOG(LogError) << "Invalid metadata journal \"" << journalPath << "\"";
+		return;
+	}
+
+	LOG(LogInfo) << "Replaying metadata journal \"" << journalPath << "\"...";
+
+	std::vector<std::string> order;
+	std::unordered_map<std::string, std::string> records;
+
+	size_t pos = headerSize;
+	while (pos + 2 * sizeof(unsigned int) <= data.size())
+	{
+		unsigned int size, crc;
+		memcpy(&size, data.data() + pos, sizeof(size));
+		memcpy(&crc, data.data() + pos + sizeof(size), sizeof(crc));
+
+		const char* payload = data.data() + pos + 2 * sizeof(unsigned int);
+		if (size < 2 || pos + 2 * sizeof(unsigned int) + size > data.size() || Utils::Zip::ZipFile::computeCRC(0, payload, size) != crc)
+		{
+			LOG(LogWarning) << "Metadata journal \"" << journalPath << "\" is truncated or corrupted at offset " << pos;
+			break;
+		}
+
+		pos += 2 * sizeof(unsigned int) + size;
+
+		JournalRecordType type = (JournalRecordType)payload[0];
+
+		std::string path(payload + 1, strnlen(payload + 1, size - 1));
+		size_t xmlOffset = 1 + path.size() + 1;
+
+		if (type == JOURNAL_REMOVE)
+			records.erase(path);
+		else if (type == JOURNAL_METADATA && xmlOffset < size)
+		{
+			if (records.find(path) == records.cend())
+				order.push_back(path);
+
+			records[path] = std::string(payload + xmlOffset, size - xmlOffset);
+		}
+	}
+
+	for (auto path : order)
+	{
+		auto record = records.find(path);
+		if (record == records.cend())
+			continue;
+
+		pugi::xml_document doc;
+		if (!doc.load_buffer(record->second.data(), record->second.size()))
+			continue;
+
+		pugi::xml_node root = doc.child("gameList");
+		if (root)
+			loadGamelistRoot(root, system, fileMap, checkSize, true);
+
+		// Only once, even if the path was removed & added again
+		records.erase(record);
+	}
+}
+
 void clearTemporaryGamelistRecovery(SystemData* system)
 {	
+	closeGamelistJournal(system);
+
 	auto path = getGamelistRecoveryPath(system);
 	Utils::FileSystem::deleteDirectoryFiles(path, true);
 }
 
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap)
 {
+	TRACE_SCOPE_DETAIL("parseGamelist", system->getName());
+
 	std::string xmlpath = system->getGamelistPath(false);
 
 	auto size = Utils::FileSystem::getFileSize(xmlpath);
 	if (size != 0)
 		loadGamelistFile(xmlpath, system, fileMap, SIZE_MAX, true);
 
+	// Recovery files written by previous versions, one per game : older than any journal record, so they are replayed first
 	auto files = Utils::FileSystem::getDirContent(getGamelistRecoveryPath(system), true);
 	for (auto file : files)
-		loadGamelistFile(file, system, fileMap, size, true);
+		if (Utils::String::toLower(Utils::FileSystem::getExtension(file)) == ".xml")
+			loadGamelistFile(file, system, fileMap, size, true);
+
+	loadGamelistJournal(system, fileMap, size);
 
 	if (size != SIZE_MAX)
 		system->setGamelistHash(size);	
@@ -304,14 +567,18 @@ bool saveToGamelistRecovery(FileData* file)
 	if (!Settings::HiddenSystemsShowGames() && !system->isVisible())
 		return false;
 
-	std::string fp = file->getFullPath();
-	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
-	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
+	pugi::xml_document doc;
+	pugi::xml_node root = doc.append_child("gameList");
+	root.append_attribute("parentHash").set_value(system->getGamelistHash());
 
-	std::string path = Utils::FileSystem::getAbsolutePath(fp, getGamelistRecoveryPath(system));
-	path = Utils::FileSystem::getCanonicalPath(path);
+	// Full paths : no need to compute relative paths, they are resolved the same way when replaying
+	if (!addFileDataNode(root, file, file->getType() == GAME ? "game" : "folder", system, true))
+		return appendToGamelistJournal(system, JOURNAL_REMOVE, file->getPath()); // Only default values left
+
+	std::ostringstream xml;
+	doc.save(xml, "", pugi::format_raw);
 
-	return saveToXml(file, path);
+	return appendToGamelistJournal(system, JOURNAL_METADATA, file->getPath(), xml.str());
 }
 
 bool removeFromGamelistRecovery(FileData* file)
@@ -320,6 +587,9 @@ bool removeFromGamelistRecovery(FileData* file)
 	if (system == nullptr)
 		return false;
 
+	if (Utils::FileSystem::exists(getGamelistJournalPath(system)))
+		appendToGamelistJournal(system, JOURNAL_REMOVE, file->getPath());
+
 	std::string fp = file->getFullPath();
 	fp = Utils::FileSystem::createRelativePath(file->getFullPath(), system->getRootFolder()->getFullPath(), true);
 	fp = Utils::FileSystem::getParent(fp) + "/" + Utils::FileSystem::getStem(fp) + ".xml";
@@ -338,18 +608,68 @@ bool hasDirtyFile(SystemData* system)
 	if (system == nullptr || !system->isGameSystem() || (!Settings::HiddenSystemsShowGames() && !system->isVisible())) // || system->hasPlatformId(PlatformIds::IMAGEVIEWER))
 		return false;
 
-	FolderData* rootFolder = system->getRootFolder();
-	if (rootFolder == nullptr)
+	return system->hasDirtyFiles();
+}
+
+// Gamelist entries and games are matched on their canonical paths, so that entries written through symlinked or '..' folders still match.
+// Entries share a few folders : these are canonicalized once per save of a system, instead of every path.
+class GamelistPathKeys
+{
+public:
+	std::string get(const std::string& path)
+	{
+		std::string fileName = Utils::FileSystem::getFileName(path);
+		if (fileName == "." || fileName == "..")
+			return get(Utils::FileSystem::getCanonicalPath(path));
+
+		return getFolder(Utils::FileSystem::getParent(path)) + "/" + fileName;
+	}
+
+private:
+	const std::string& getFolder(const std::string& folder)
+	{
+		auto it = mFolders.find(folder);
+		if (it != mFolders.cend())
+			return it->second;
+
+		std::string canonical = Utils::FileSystem::getCanonicalPath(folder);
+
+#ifndef WIN32
+		char* resolved = realpath(canonical.c_str(), nullptr);
+		if (resolved != nullptr)
+		{
+			canonical = resolved;
+			free(resolved);
+		}
+#endif
+
+		return mFolders[folder] = canonical;
+	}
+
+	std::unordered_map<std::string, std::string> mFolders;
+};
+
+// Write to a temporary file, then replace the gamelist so that it's never left truncated
+static bool saveGamelistDocument(pugi::xml_document& doc, const std::string& path)
+{
+	std::string tmpPath = path + ".tmp";
+
+	if (!doc.save_file(WINSTRINGW(tmpPath).c_str()))
 		return false;
 
-	for (auto file : rootFolder->getFilesRecursive(GAME | FOLDER))
-		if (file->getMetadata().wasChanged())
-			return true;
+#if WIN32
+	if (MoveFileExW(Utils::String::convertToWideString(tmpPath).c_str(), Utils::String::convertToWideString(path).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+		return true;
+#else
+	if (std::rename(tmpPath.c_str(), path.c_str()) == 0)
+		return true;
+#endif
 
+	Utils::FileSystem::removeFile(tmpPath);
 	return false;
 }
 
-void updateGamelist(SystemData* system)
+GamelistUpdate::GamelistUpdate(SystemData* system) : mSystem(nullptr), mSaved(false)
 {
 	// We do this by reading the XML again, adding changes and then writing it back,
 	// because there might be information missing in our systemdata which would then miss in the new XML.
@@ -369,42 +689,69 @@ void updateGamelist(SystemData* system)
 		return;
 	}
 
-	std::vector<FileData*> dirtyFiles;
-	
-	auto files = rootFolder->getFilesRecursive(GAME | FOLDER, false, nullptr, false);
-	for (auto file : files)
+	mSystem = system;
+
+	for (auto file : system->getDirtyFiles())
 		if (file->getSystem() == system && file->getMetadata().wasChanged())
-			dirtyFiles.push_back(file);
+			mFiles.push_back(file);
+
+	if (mFiles.size() == 0)
+		return;
+
+	// The dirty set is unordered : write the entries in path order, so that saving the same changes gives the same file
+	std::sort(mFiles.begin(), mFiles.end(), [](FileData* a, FileData* b) { return a->getPath() < b->getPath(); });
 
-	if (dirtyFiles.size() == 0)
+	// Copy everything write() needs : it may run on another thread
+	mName = system->getName();
+	mReadPath = system->getGamelistPath(false);
+	mWritePath = system->getGamelistPath(true);
+	mStartPath = system->getStartPath();
+
+	mNodes = std::make_shared<pugi::xml_document>();
+	pugi::xml_node root = mNodes->append_child("gameList");
+
+	for (auto file : mFiles)
 	{
-		clearTemporaryGamelistRecovery(system);
+		Entry entry;
+		entry.path = file->getPath();
+		entry.hasNode = addFileDataNode(root, file, file->getType() == GAME ? "game" : "folder", system);
+		mEntries.push_back(entry);
+	}
+}
+
+void GamelistUpdate::write()
+{
+	if (mEntries.size() == 0)
+	{
+		mSaved = true;
 		return;
 	}
 
+	auto startTime = std::chrono::steady_clock::now();
+
 	int numUpdated = 0;
 
 	pugi::xml_document doc;
 	pugi::xml_node root;
-	std::string xmlReadPath = system->getGamelistPath(false);
 
-	if(Utils::FileSystem::exists(xmlReadPath))
+	if(Utils::FileSystem::exists(mReadPath))
 	{
 		//parse an existing file first
-		pugi::xml_parse_result result = doc.load_file(WINSTRINGW(xmlReadPath).c_str());
+		pugi::xml_parse_result result = doc.load_file(WINSTRINGW(mReadPath).c_str());
 		if(!result)
-			LOG(LogError) << "Error parsing XML file \"" << xmlReadPath << "\"!\n	" << result.description();
+			LOG(LogError) << "Error parsing XML file \"" << mReadPath << "\"!\n	" << result.description();
 
 		root = doc.child("gameList");
 		if(!root)
 		{
-			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << xmlReadPath << "\"!";
+			LOG(LogError) << "Could not find <gameList> node in gamelist \"" << mReadPath << "\"!";
 			root = doc.append_child("gameList");
 		}
 	}
 	else //set up an empty gamelist to append to		
 		root = doc.append_child("gameList");
 
+	GamelistPathKeys keys;
 	std::map<std::string, pugi::xml_node> xmlMap;
 
 	for (pugi::xml_node fileNode : root.children())
@@ -412,30 +759,34 @@ void updateGamelist(SystemData* system)
 		pugi::xml_node path = fileNode.child("path");
 		if (path)
 		{
-			std::string nodePath = Utils::FileSystem::getCanonicalPath(Utils::FileSystem::resolveRelativePath(path.text().get(), system->getStartPath(), true));
+			std::string nodePath = keys.get(Utils::FileSystem::resolveRelativePath(path.text().get(), mStartPath, true));
 			xmlMap[nodePath] = fileNode;
 		}
 	}
 	
 	// iterate through all files, checking if they're already in the XML
-	for(auto file : dirtyFiles)
+	pugi::xml_node node = mNodes->child("gameList").first_child();
+
+	for (auto& entry : mEntries)
 	{
 		bool removed = false;
 
 		// check if the file already exists in the XML
 		// if it does, remove it before adding
-		auto xmf = xmlMap.find(Utils::FileSystem::getCanonicalPath(file->getPath()));
+		auto xmf = xmlMap.find(keys.get(entry.path));
 		if (xmf != xmlMap.cend())
 		{
 			removed = true;
 			root.remove_child(xmf->second);
 		}
 		
-		const char* tag = (file->getType() == GAME) ? "game" : "folder";
-
 		// it was either removed or never existed to begin with; either way, we can add it now
-		if (addFileDataNode(root, file, tag, system))
+		if (entry.hasNode)
+		{
+			root.append_copy(node);
+			node = node.next_sibling();
 			++numUpdated; // Only if really added
+		}
 		else if (removed)
 			++numUpdated; // Only if really removed
 	}
@@ -444,18 +795,36 @@ void updateGamelist(SystemData* system)
 	if (numUpdated > 0) 
 	{
 		//make sure the folders leading up to this path exist (or the write will fail)
-		std::string xmlWritePath(system->getGamelistPath(true));
-		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(xmlWritePath));
+		Utils::FileSystem::createDirectory(Utils::FileSystem::getParent(mWritePath));
 
-		LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << xmlReadPath << "'";
+		if (!saveGamelistDocument(doc, mWritePath))
+		{
+			LOG(LogError) << "Error saving gamelist.xml to \"" << mWritePath << "\" (for system " << mName << ")!";
+			return;
+		}
 
-		if (!doc.save_file(WINSTRINGW(xmlWritePath).c_str()))
-			LOG(LogError) << "Error saving gamelist.xml to \"" << xmlWritePath << "\" (for system " << system->getName() << ")!";
-		else
-			clearTemporaryGamelistRecovery(system);
+		LOG(LogInfo) << "Added/Updated " << numUpdated << " entities in '" << mReadPath << "' in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count() << "ms";
 	}
-	else
-		clearTemporaryGamelistRecovery(system);
+
+	mSaved = true;
+}
+
+void GamelistUpdate::commit()
+{
+	if (mSystem == nullptr || !mSaved)
+		return;
+
+	for (auto file : mFiles)
+		file->getMetadata().resetChangedFlag();
+
+	clearTemporaryGamelistRecovery(mSystem);
+}
+
+void updateGamelist(SystemData* system)
+{
+	GamelistUpdate update(system);
+	update.write();
+	update.commit();
 }
 
 void resetGamelistUsageData(SystemData* system)
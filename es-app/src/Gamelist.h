@@ -3,6 +3,7 @@
 #define ES_APP_GAME_LIST_H
 
 #include <cstdint>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -10,17 +11,55 @@
 class SystemData;
 class FileData;
 
+namespace pugi { class xml_document; }
+
 // Loads gamelist.xml data into a SystemData.
 void parseGamelist(SystemData* system, std::unordered_map<std::string, FileData*>& fileMap);
 
 // Writes currently loaded metadata for a SystemData to gamelist.xml.
 void updateGamelist(SystemData* system);
+
+// updateGamelist in steps, to save several gamelists in parallel.
+// The constructor copies the changes and commit() marks them saved : both read the FileData, on the thread owning them.
+// write() only works on the copy, and may run on any thread.
+class GamelistUpdate
+{
+public:
+	GamelistUpdate(SystemData* system);
+
+	void write();
+	void commit();
+
+private:
+	struct Entry
+	{
+		std::string path;
+		bool hasNode;
+	};
+
+	SystemData* mSystem;
+	std::vector<FileData*> mFiles;
+
+	std::string mName;
+	std::string mReadPath;
+	std::string mWritePath;
+	std::string mStartPath;
+
+	// The <game> nodes of the entries which have one, in the same order
+	std::vector<Entry> mEntries;
+	std::shared_ptr<pugi::xml_document> mNodes;
+
+	bool mSaved;
+};
 void cleanupGamelist(SystemData* system);
 void resetGamelistUsageData(SystemData* system);
 
 bool saveToGamelistRecovery(FileData* file);
 bool removeFromGamelistRecovery(FileData* file);
 
+// Syncs the metadata journal records written since the last fsync : once JOURNAL_SYNC_DELAY has elapsed, or right away if force is set
+void syncGamelistJournals(bool force = false);
+
 bool saveToXml(FileData* file, const std::string& fileName, bool fullPaths = false);
 
 bool hasDirtyFile(SystemData* system);
@@ -9,6 +9,8 @@
 #include "Settings.h"
 #include "FileData.h"
 #include "ImageIO.h"
+#include "MemoryAccounting.h"
+#include <atomic>
 
 std::vector<MetaDataDecl> MetaDataList::mMetaDataDecls;
 
@@ -140,15 +142,23 @@ MetaDataId MetaDataList::getId(const std::string& key) const
 	return mGameIdMap[key];
 }
 
+static std::atomic<unsigned int> sMetaDataVersion(0);
+
 MetaDataList::MetaDataList(MetaDataListType type) : mType(type), mWasChanged(false), mRelativeTo(nullptr)
 {
+	touch();
+}
 
+void MetaDataList::touch()
+{
+	mVersion = ++sMetaDataVersion;
 }
 
 void MetaDataList::loadFromXML(MetaDataListType type, pugi::xml_node& node, SystemData* system)
 {
 	mType = type;
 	mRelativeTo = system;	
+	touch();
 
 	mUnKnownElements.clear();
 	mScrapeDates.clear();
@@ -357,7 +367,7 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 			return;
 
 		mName = value;
-		mWasChanged = true;
+		setDirty();
 		return;
 	}
 
@@ -377,7 +387,7 @@ void MetaDataList::set(MetaDataId id, const std::string& value)
 	else
 		mMap[id] = Utils::String::trim(value);
 
-	mWasChanged = true;
+	setDirty();
 }
 
 const std::string MetaDataList::get(MetaDataId id, bool resolveRelativePaths) const
@@ -435,9 +445,21 @@ bool MetaDataList::wasChanged() const
 
 void MetaDataList::resetChangedFlag()
 {
+	if (mWasChanged && mOwner.file != nullptr && mOwner.file->getSystem() != nullptr)
+		mOwner.file->getSystem()->setDirtyFile(mOwner.file, false);
+
 	mWasChanged = false;
 }
 
+void MetaDataList::setDirty()
+{
+	mWasChanged = true;
+	touch();
+
+	if (mOwner.file != nullptr && mOwner.file->getSystem() != nullptr)
+		mOwner.file->getSystem()->setDirtyFile(mOwner.file, true);
+}
+
 void MetaDataList::importScrappedMetadata(const MetaDataList& source)
 {
 	int type = MetaDataImportType::Types::ALL;
@@ -568,7 +590,7 @@ void MetaDataList::setScrapeDate(const std::string& scraper)
 		return;
 
 	mScrapeDates[it->second] = Utils::Time::DateTime::now();
-	mWasChanged = true;
+	setDirty();
 }
 
 Utils::Time::DateTime* MetaDataList::getScrapeDate(const std::string& scraper)
@@ -582,4 +604,23 @@ Utils::Time::DateTime* MetaDataList::getScrapeDate(const std::string& scraper)
 	}
 
 	return nullptr;
-}
\ No newline at end of file
+}
+
+// Nodes of std::map cost about 32 bytes besides their value
+#define MAP_NODE_SIZE 32
+
+size_t MetaDataList::getMemoryUsage() const
+{
+	size_t size = MemoryAccounting::getStringSize(mName);
+
+	for (auto& value : mMap)
+		size += MAP_NODE_SIZE + sizeof(value) + MemoryAccounting::getStringSize(value.second);
+
+	size += mScrapeDates.size() * (MAP_NODE_SIZE + sizeof(std::pair<int, Utils::Time::DateTime>));
+
+	size += mUnKnownElements.capacity() * sizeof(std::tuple<std::string, std::string, bool>);
+	for (auto& element : mUnKnownElements)
+		size += MemoryAccounting::getStringSize(std::get<0>(element)) + MemoryAccounting::getStringSize(std::get<1>(element));
+
+	return size;
+}
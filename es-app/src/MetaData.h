@@ -158,10 +158,14 @@ public:
 
 	bool wasChanged() const;
 	void resetChangedFlag();
-	const void setDirty() 
-	{ 
-		mWasChanged = true; 
-	}
+	void setDirty();
+
+	// Changes whenever a value changes. Versions are unique across all the lists, so a version identifies one state of one list.
+	inline unsigned int getVersion() const { return mVersion; }
+	void touch();
+
+	// The owner is registered in its system's dirty set when the metadata changes
+	void setOwner(FileData* file) { mOwner.file = file; }
 
 	inline MetaDataListType getType() const { return mType; }
 	static const std::vector<MetaDataDecl>& getMDD() { return mMetaDataDecls; }
@@ -176,6 +180,9 @@ public:
 	void setScrapeDate(const std::string& scraper);
 	Utils::Time::DateTime* getScrapeDate(const std::string& scraper);
 
+	// Estimated heap bytes, for the memory accounting
+	size_t getMemoryUsage() const;
+
 private:
 	std::map<int, Utils::Time::DateTime> mScrapeDates;
 
@@ -184,6 +191,17 @@ private:
 	std::map<MetaDataId, std::string> mMap;
 	bool mWasChanged;
 	SystemData*		mRelativeTo;
+	unsigned int	mVersion;
+
+	// Not copied : a copy of the metadata doesn't belong to the file
+	struct Owner
+	{
+		Owner() : file(nullptr) { }
+		Owner(const Owner&) : file(nullptr) { }
+		Owner& operator=(const Owner&) { return *this; }
+
+		FileData* file;
+	} mOwner;
 
 	static std::vector<MetaDataDecl> mMetaDataDecls;
 
@@ -0,0 +1,118 @@
+#include "NetPlayIndex.h"
+#include "SystemData.h"
+#include "FileData.h"
+#include "utils/FileSystemUtil.h"
+#include "utils/StringUtil.h"
+#include "Log.h"
+#include "Trace.h"
+#include <cstdlib>
+#include <algorithm>
+
+std::mutex NetPlayIndex::mLock;
+std::unordered_map<SystemData*, NetPlayIndex::SystemIndex> NetPlayIndex::mIndexes;
+
+std::string NetPlayIndex::normalizeName(const std::string& name)
+{
+	auto ret = Utils::String::toLower(name);
+	ret = Utils::String::replace(ret, "_", " ");
+	ret = Utils::String::replace(ret, ".", "");
+	ret = Utils::String::replace(ret, "'", "");
+	return Utils::String::removeParenthesis(ret);
+}
+
+bool NetPlayIndex::parseCrc(const std::string& crc, uint32_t& value)
+{
+	if (crc.empty() || crc.size() > 8)
+		return false;
+
+	char* end = nullptr;
+	unsigned long ret = strtoul(crc.c_str(), &end, 16);
+	if (end == nullptr || *end != 0 || ret == 0)
+		return false;
+
+	value = (uint32_t)ret;
+	return true;
+}
+
+NetPlayIndex::SystemIndex& NetPlayIndex::getSystemIndex(SystemData* system)
+{
+	// Drop the systems which don't exist anymore
+	if (mIndexes.size() > SystemData::sSystemVector.size())
+	{
+		for (auto it = mIndexes.begin(); it != mIndexes.end(); )
+		{
+			if (std::find(SystemData::sSystemVector.cbegin(), SystemData::sSystemVector.cend(), it->first) == SystemData::sSystemVector.cend())
+				it = mIndexes.erase(it);
+			else
+				++it;
+		}
+	}
+
+	// Versions are unique across systems : a new system allocated at the same address is rebuilt too
+	auto it = mIndexes.find(system);
+	if (it != mIndexes.cend() && it->second.version == system->getDataVersion())
+		return it->second;
+
+	TRACE_SCOPE_DETAIL("NetPlayIndex::build", system->getName());
+
+	SystemIndex& index = mIndexes[system];
+	index.version = system->getDataVersion();
+	index.crcs.clear();
+	index.names.clear();
+	index.namesWithoutSpaces.clear();
+
+	// The first game wins, as with a linear search
+	for (auto file : system->getRootFolder()->getFilesRecursive(GAME, false, system))
+	{
+		uint32_t crc;
+		if (parseCrc(file->getMetadata(MetaDataId::Crc32), crc))
+			index.crcs.emplace(crc, file);
+
+		std::string name = normalizeName(file->getName());
+		index.names.emplace(name, file);
+		index.names.emplace(normalizeName(Utils::FileSystem::getStem(file->getPath())), file);
+		index.namesWithoutSpaces.emplace(Utils::String::replace(name, " ", ""), file);
+	}
+
+	LOG(LogDebug) << "NetPlayIndex : indexed " << index.names.size() << " names and " << index.crcs.size() << " crcs for " << system->getName();
+	return index;
+}
+
+FileData* NetPlayIndex::findByCrc(SystemData* system, const std::string& crc)
+{
+	uint32_t value;
+	if (system == nullptr || !parseCrc(crc, value))
+		return nullptr;
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto& index = getSystemIndex(system);
+
+	auto it = index.crcs.find(value);
+	return it == index.crcs.cend() ? nullptr : it->second;
+}
+
+FileData* NetPlayIndex::findByName(SystemData* system, const std::string& name)
+{
+	if (system == nullptr || name.empty())
+		return nullptr;
+
+	std::string normalizedName = normalizeName(name);
+
+	std::unique_lock<std::mutex> lock(mLock);
+
+	auto& index = getSystemIndex(system);
+
+	auto it = index.names.find(normalizedName);
+	if (it != index.names.cend())
+		return it->second;
+
+	it = index.namesWithoutSpaces.find(Utils::String::replace(normalizedName, " ", ""));
+	return it == index.namesWithoutSpaces.cend() ? nullptr : it->second;
+}
+
+void NetPlayIndex::clear()
+{
+	std::unique_lock<std::mutex> lock(mLock);
+	mIndexes.clear();
+}
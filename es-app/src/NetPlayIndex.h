@@ -0,0 +1,43 @@
+#pragma once
+#ifndef ES_APP_NETPLAY_INDEX_H
+#define ES_APP_NETPLAY_INDEX_H
+
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+class SystemData;
+class FileData;
+
+// Games of the library by CRC32 and by normalized name, used to match the netplay lobby entries.
+// The index of a system is rebuilt when its data version changes, i.e. when games are added or removed
+// or when their metadata is updated (the CRC32 set by ThreadedHasher, a renamed game...)
+class NetPlayIndex
+{
+public:
+	static FileData* findByCrc(SystemData* system, const std::string& crc);
+	static FileData* findByName(SystemData* system, const std::string& name);
+
+	static void clear();
+
+	static std::string normalizeName(const std::string& name);
+	static bool parseCrc(const std::string& crc, uint32_t& value);
+
+private:
+	struct SystemIndex
+	{
+		unsigned int version;
+
+		std::unordered_map<uint32_t, FileData*> crcs;
+		std::unordered_map<std::string, FileData*> names; // Normalized names and file stems
+		std::unordered_map<std::string, FileData*> namesWithoutSpaces;
+	};
+
+	static SystemIndex& getSystemIndex(SystemData* system);
+
+	static std::mutex mLock;
+	static std::unordered_map<SystemData*, SystemIndex> mIndexes;
+};
+
+#endif // ES_APP_NETPLAY_INDEX_H
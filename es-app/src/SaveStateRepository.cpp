@@ -3,6 +3,8 @@
 #include "FileData.h"
 #include "utils/StringUtil.h"
 #include <regex>
+#include <unordered_set>
+#include <algorithm>
 #include "Log.h"
 
 #include <time.h>
@@ -37,6 +39,7 @@ void SaveStateRepository::clear()
 			delete state;
 
 	mStates.clear();
+	mScans.clear();
 }
 
 bool SaveStateRepository::supportsAutoSave()
@@ -59,70 +62,132 @@ bool SaveStateRepository::supportsIncrementalSaveStates()
 
 void SaveStateRepository::refresh()
 {
-	clear();
-
 	auto list = SaveStateConfigFile::getSaveStateConfigs(mSystem);
+
+	// Forget the configs which are not used anymore
+	for (auto it = mScans.begin(); it != mScans.end(); )
+	{
+		if (std::find_if(list.cbegin(), list.cend(), [it](const std::shared_ptr<SaveStateConfig>& rs) { return rs.get() == it->first; }) == list.cend())
+		{
+			removeStates(it->first);
+			it = mScans.erase(it);
+		}
+		else
+			++it;
+	}
+
+	time_t now = time(NULL);
+
 	for (auto rs : list)
 	{
 		std::string path = rs->getDirectory(mSystem);
+		time_t modificationTime = Utils::FileSystem::exists(path) ? Utils::FileSystem::getFileModificationDate(path).getTime() : 0;
 
-		if (!Utils::FileSystem::exists(path))
+		// Adding, removing or renaming a state changes the time of its directory. A directory modified during the second
+		// of the last scan may have changed again since.
+		auto it = mScans.find(rs.get());
+		if (it != mScans.cend() && it->second.path == path && it->second.modificationTime == modificationTime && modificationTime < it->second.scanTime)
 			continue;
 
-		auto files = Utils::FileSystem::getDirectoryFiles(path);
-		for (auto file : files)
+		removeStates(rs.get());
+
+		if (modificationTime != 0)
+			loadStates(rs);
+
+		mScans[rs.get()] = { path, modificationTime, now };
+	}
+}
+
+void SaveStateRepository::removeStates(const SaveStateConfig* config)
+{
+	for (auto it = mStates.begin(); it != mStates.end(); )
+	{
+		auto& states = it->second;
+
+		for (auto state = states.begin(); state != states.end(); )
 		{
-			if (file.hidden || file.directory)
-				continue;
+			if ((*state)->config.get() == config)
+			{
+				delete *state;
+				state = states.erase(state);
+			}
+			else
+				++state;
+		}
 
-			std::string ext = Utils::String::toLower(Utils::FileSystem::getExtension(file.path));
+		if (states.empty())
+			it = mStates.erase(it);
+		else
+			++it;
+	}
+}
 
-			std::string rom;
-			int slot = -1;
+void SaveStateRepository::loadStates(const std::shared_ptr<SaveStateConfig>& rs)
+{
+	std::string path = rs->getDirectory(mSystem);
+	if (!Utils::FileSystem::exists(path))
+		return;
 
-			std::string fileName = Utils::FileSystem::getFileName(file.path);
-			if (!rs->matchSlotFile(fileName, rom, slot) && !rs->matchAutoFile(fileName, rom))
-				continue;
+	auto files = Utils::FileSystem::getDirectoryFiles(path);
 
-			SaveState* state = new SaveState();
-			state->config = rs;
-			state->fileName = file.path;
-			state->rom = rom;
-			state->slot = slot;
+	// Screenshots are looked up in the listing rather than probed one by one
+	std::unordered_set<std::string> fileNames;
+	for (auto& file : files)
+		if (!file.directory)
+			fileNames.insert(Utils::FileSystem::getFileName(file.path));
 
-			// generators are the same for autosave and slots
-			state->fileGenerator = Utils::String::replace(rs->file, "{{romfilename}}", rom);
-			state->imageGenerator = Utils::String::replace(rs->image, "{{romfilename}}", rom);
+	for (auto& file : files)
+	{
+		if (file.hidden || file.directory)
+			continue;
 
-			// screenshot
-			if (Utils::FileSystem::exists(state->fileName + ".png"))
-				state->screenshot = state->fileName + ".png";
-			else
-			{
-				std::string screenshot = Utils::FileSystem::combine(path, slot < 0 ? rs->autosave_image : rs->image);
-				std::string basename = Utils::FileSystem::getFileName(file.path);
+		std::string fileName = Utils::FileSystem::getFileName(file.path);
 
-				screenshot = Utils::String::replace(screenshot, "{{romfilename}}", rom);
-				screenshot = Utils::String::replace(screenshot, "{{slot}}", state->slot == 0 ? "" : std::to_string(state->slot));
-				screenshot = Utils::String::replace(screenshot, "{{slot0}}", std::to_string(state->slot));
-				screenshot = Utils::String::replace(screenshot, "{{slot00}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
-				screenshot = Utils::String::replace(screenshot, "{{slot2d}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+		std::string rom;
+		int slot = -1;
 
-				if (Utils::FileSystem::exists(screenshot))
-					state->screenshot = screenshot;
-			}
+		if (!rs->matchSlotFile(fileName, rom, slot) && !rs->matchAutoFile(fileName, rom))
+			continue;
 
-			// retroarch specific commands
-			state->racommands = rs->racommands;
-			state->hasAutosave = rs->autosave;
+		SaveState* state = new SaveState();
+		state->config = rs;
+		state->fileName = file.path;
+		state->rom = rom;
+		state->slot = slot;
+
+		// generators are the same for autosave and slots
+		state->fileGenerator = Utils::String::replace(rs->file, "{{romfilename}}", rom);
+		state->imageGenerator = Utils::String::replace(rs->image, "{{romfilename}}", rom);
+
+		// screenshot
+		if (fileNames.find(fileName + ".png") != fileNames.cend())
+			state->screenshot = state->fileName + ".png";
+		else
+		{
+			std::string screenshot = slot < 0 ? rs->autosave_image : rs->image;
+
+			screenshot = Utils::String::replace(screenshot, "{{romfilename}}", rom);
+			screenshot = Utils::String::replace(screenshot, "{{slot}}", state->slot == 0 ? "" : std::to_string(state->slot));
+			screenshot = Utils::String::replace(screenshot, "{{slot0}}", std::to_string(state->slot));
+			screenshot = Utils::String::replace(screenshot, "{{slot00}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+			screenshot = Utils::String::replace(screenshot, "{{slot2d}}", Utils::String::padLeft(std::to_string(state->slot), 2, '0'));
+
+			// Images stored in another directory still have to be probed
+			bool inDirectory = screenshot.find('/') == std::string::npos && screenshot.find('\\') == std::string::npos;
+			if (inDirectory ? fileNames.find(screenshot) != fileNames.cend() : Utils::FileSystem::exists(Utils::FileSystem::combine(path, screenshot)))
+				state->screenshot = Utils::FileSystem::combine(path, screenshot);
+		}
+
+		// retroarch specific commands
+		state->racommands = rs->racommands;
+		state->hasAutosave = rs->autosave;
 
 #if WIN32
-			state->creationDate.setTime(file.lastWriteTime);
+		state->creationDate.setTime(file.lastWriteTime);
 #else
-			state->creationDate = Utils::FileSystem::getFileModificationDate(state->fileName);
+		state->creationDate = Utils::FileSystem::getFileModificationDate(state->fileName);
 #endif
-			mStates[state->rom].push_back(state);
-		}
+		mStates[state->rom].push_back(state);
 	}
 }
 
@@ -3,6 +3,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <time.h>
 
 #include "SaveState.h"
 
@@ -27,7 +29,7 @@ public:
 	std::vector<SaveState*> getSaveStates(FileData* game, std::shared_ptr<SaveStateConfig> config = nullptr);
 
 	void clear();
-	void refresh();
+	void refresh(); // Only the directories modified since their last scan are listed again
 
 	SaveState* getGameAutoSave(FileData* game);
 	SaveState* getDefaultAutoSaveSaveState();
@@ -38,9 +40,22 @@ public:
 private:
 	// std::string getDefaultSavesPath();
 
+	struct DirectoryScan
+	{
+		std::string path;
+		time_t modificationTime;
+		time_t scanTime;
+	};
+
+	void loadStates(const std::shared_ptr<SaveStateConfig>& config);
+	void removeStates(const SaveStateConfig* config);
+
 	SystemData* mSystem;
 	std::map<std::string, std::vector<SaveState*>> mStates;
 
+	// Directories are only scanned again when their modification time changes
+	std::map<const SaveStateConfig*, DirectoryScan> mScans;
+
 	static SaveState* _empty;
 	SaveState* _autosave;
 	SaveState* _newGame;
@@ -8,6 +8,7 @@
 #include "FileSorts.h"
 #include "Gamelist.h"
 #include "Log.h"
+#include "Trace.h"
 #include "utils/Platform.h"
 #include "Settings.h"
 #include "ThemeData.h"
@@ -25,6 +26,10 @@
 #include "SaveStateRepository.h"
 #include "Paths.h"
 #include "SystemRandomPlaylist.h"
+#include "NetPlayIndex.h"
+#include <thread>
+#include <condition_variable>
+#include <SDL_timer.h>
 
 #if WIN32
 #include "Win32ApiSystem.h"
@@ -61,8 +66,50 @@ static std::map<std::string, std::function<BindableProperty(SystemData*)>> prope
 };
 
 VectorEx<SystemData*> SystemData::sSystemVector;
+std::atomic<unsigned int> SystemData::sVersionCounter(0);
+std::atomic<unsigned int> SystemData::sSettingsGeneration(1);
+
+// Boolean settings which can be overridden per system, see SystemData::getBoolSetting
+static const std::vector<std::string> sSystemFlagSettings = { "ShowManualIcon", "ShowSaveStates", "ShowCheevosIcon", "ShowGunIconOnGames", "ShowWheelIconOnGames", "ShowTrackballIconOnGames", "ShowSpinnerIconOnGames" };
+
+// Changing one of these settings, globally or for a system, invalidates the SystemSettings of every system
+static const std::set<std::string> sSystemScopedSettings = { "ShowHiddenFiles", "ShowFilenames", "ShowParentFolder", "FavoritesFirst", "ShowFlags", "FolderViewMode", "HiddenExt",
+	"ShowManualIcon", "ShowSaveStates", "ShowCheevosIcon", "ShowGunIconOnGames", "ShowWheelIconOnGames", "ShowTrackballIconOnGames", "ShowSpinnerIconOnGames" };
+
+class SystemSettingsInvalidator : public ISettingsChangedEvent
+{
+public:
+	void onSettingChanged(const std::string& name) override
+	{
+		auto dot = name.rfind('.');
+		if (sSystemScopedSettings.find(dot == std::string::npos ? name : name.substr(dot + 1)) != sSystemScopedSettings.cend())
+			SystemData::resetSettings();
+	}
+};
+
+static SystemSettingsInvalidator sSettingsInvalidator;
+static bool sSettingsInvalidatorRegistered = false;
 bool SystemData::IsManufacturerSupported = false;
 
+// Game counts saved by the previous session : systems found here can be displayed before their games are loaded
+struct CachedGameCount
+{
+	std::string path;
+	GameCountInfo counts;
+};
+
+static std::map<std::string, CachedGameCount> sGameCountCache;
+static bool sLazyLoading = false; // Set while loadConfig creates the systems
+
+// Background loading of the systems created without their games
+static std::thread*				sLazyLoadingThread = nullptr;
+static std::vector<SystemData*>	sLazyLoadingQueue;
+static std::mutex				sLazyLoadingLock;
+static std::condition_variable	sLazyLoadingEvent;
+static bool						sLazyLoadingExit = false;
+static int						sLazyLoadingGeneration = 0; // Functions posted to the UI thread are ignored once systems are reloaded
+static int						sLazyLoadingStartTime = 0;
+
 SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envData, std::vector<EmulatorData>* pEmulators, bool CollectionSystem, bool groupedSystem, bool withTheme, bool loadThemeOnlyIfElements) :
 	mMetadata(meta), mEnvData(envData), mIsCollectionSystem(CollectionSystem), mIsGameSystem(true)
 {
@@ -72,6 +119,12 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 	mIsGroupSystem = groupedSystem;
 	mGameListHash = 0;
 	mGameCountInfo = nullptr;
+	mLazyState = LAZY_POPULATED;
+	mLazyRoot = nullptr;
+	mLoadedInBackground = false;
+	mFilesVersion = mDataVersion = ++sVersionCounter;
+	mMemoryUsage = 0;
+	mMemoryUsageVersion = 0;
 	mSortId = Settings::getInstance()->getInt(getName() + ".sort");
 	mGridSizeOverride = Vector2f(0, 0);
 
@@ -91,28 +144,38 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 		mRootFolder = new FolderData(mEnvData->mStartPath, this);
 		mRootFolder->getMetadata().set(MetaDataId::Name, mMetadata.fullName);
 
-		std::unordered_map<std::string, FileData*> fileMap;
-		fileMap[mEnvData->mStartPath] = mRootFolder;
-
-		if (!Settings::ParseGamelistOnly())
+		// Grouped systems are merged into their parent right after loading : they are always loaded now
+		auto cache = (sLazyLoading && withTheme && !mHidden && mEnvData->mGroup.empty()) ? sGameCountCache.find(getName()) : sGameCountCache.cend();
+		if (cache != sGameCountCache.cend() && cache->second.path == mEnvData->mStartPath && (cache->second.counts.totalGames > 0 || UIModeController::LoadEmptySystems()))
+		{
+			mLazyState = LAZY_PENDING;
+			mLoadedInBackground = true;
+		}
+		else
 		{
-			populateFolder(mRootFolder, fileMap);
+			std::unordered_map<std::string, FileData*> fileMap;
+			fileMap[mEnvData->mStartPath] = mRootFolder;
 
-			if (!UIModeController::LoadEmptySystems())
+			if (!Settings::ParseGamelistOnly())
 			{
-				if (mRootFolder->getChildren().size() == 0)
-					return;
+				populateFolder(mRootFolder, fileMap);
 
-				if (mHidden && !Settings::HiddenSystemsShowGames())
-					return;
+				if (!UIModeController::LoadEmptySystems())
+				{
+					if (mRootFolder->getChildren().size() == 0)
+						return;
+
+					if (mHidden && !Settings::HiddenSystemsShowGames())
+						return;
+				}
 			}
-		}
 
-		if (!Settings::IgnoreGamelist())
-			parseGamelist(this, fileMap);		
-		
-		if (Settings::RemoveMultiDiskContent())
-			removeMultiDiskContent(fileMap);
+			if (!Settings::IgnoreGamelist())
+				parseGamelist(this, fileMap);
+
+			if (Settings::RemoveMultiDiskContent())
+				removeMultiDiskContent(mRootFolder, fileMap);
+		}
 	}
 	else
 	{
@@ -123,7 +186,7 @@ SystemData::SystemData(const SystemMetadata& meta, SystemEnvironmentData* envDat
 
 	mRootFolder->getMetadata().resetChangedFlag();
 
-	if (withTheme && (!loadThemeOnlyIfElements || UIModeController::LoadEmptySystems() || mRootFolder->mChildren.size() > 0))
+	if (withTheme && (!loadThemeOnlyIfElements || UIModeController::LoadEmptySystems() || mRootFolder->mChildren.size() > 0 || !isPopulated()))
 	{
 		loadTheme();
 
@@ -146,6 +209,9 @@ SystemData::~SystemData()
 	if (mRootFolder)
 		delete mRootFolder;
 
+	if (mLazyRoot)
+		delete mLazyRoot;
+
 	if (!mIsCollectionSystem && mEnvData != nullptr)
 		delete mEnvData;
 
@@ -159,7 +225,7 @@ SystemData::~SystemData()
 		delete mFilterIndex;
 }
 
-void SystemData::removeMultiDiskContent(std::unordered_map<std::string, FileData*>& fileMap)
+void SystemData::removeMultiDiskContent(FolderData* root, std::unordered_map<std::string, FileData*>& fileMap)
 {	
 	if (mEnvData == nullptr ||!(mEnvData->isValidExtension(".cue") || mEnvData->isValidExtension(".ccd") || mEnvData->isValidExtension(".gdi") || mEnvData->isValidExtension(".m3u")))
 		return;
@@ -171,7 +237,7 @@ void SystemData::removeMultiDiskContent(std::unordered_map<std::string, FileData
 	std::vector<FolderData*> folders;
 
 	std::stack<FolderData*> stack;
-	stack.push(mRootFolder);
+	stack.push(root);
 
 	while (stack.size())
 	{
@@ -228,6 +294,8 @@ void SystemData::setIsGameSystemStatus()
 
 void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap)
 {
+	TRACE_SCOPE_DETAIL("SystemData::populateFolder", folder->getPath());
+
 	const std::string& folderPath = folder->getPath();
 
 	if(!Utils::FileSystem::isDirectory(folderPath))
@@ -248,13 +316,9 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 	std::string filePath;
 	std::string extension;
 	bool isGame;
-	bool showHidden = Settings::ShowHiddenFiles();
+	bool showHidden = getSettings()->showHiddenFiles;
 	bool preloadMedias = Settings::PreloadMedias();
 
-	auto shv = Settings::getInstance()->getString(getName() + ".ShowHiddenFiles");
-	if (shv == "1") showHidden = true;
-	else if (shv == "0") showHidden = false;
-
 	Utils::FileSystem::fileList dirContent = Utils::FileSystem::getDirectoryFiles(folderPath);
 	for (auto fileInfo : dirContent)
 	{
@@ -342,6 +406,105 @@ void SystemData::populateFolder(FolderData* folder, std::unordered_map<std::stri
 	}
 }
 
+// Builds the game tree in a detached root folder : can run on any thread
+FolderData* SystemData::loadGames()
+{
+	FolderData* root = new FolderData(mEnvData->mStartPath, this);
+	root->getMetadata().set(MetaDataId::Name, mMetadata.fullName);
+
+	std::unordered_map<std::string, FileData*> fileMap;
+	fileMap[mEnvData->mStartPath] = root;
+
+	if (!Settings::ParseGamelistOnly())
+		populateFolder(root, fileMap);
+
+	if (!Settings::IgnoreGamelist())
+		parseGamelist(this, fileMap);
+
+	if (Settings::RemoveMultiDiskContent())
+		removeMultiDiskContent(root, fileMap);
+
+	return root;
+}
+
+// Moves the games loaded in background to the root folder
+void SystemData::applyLoadedGames()
+{
+	if (mLazyState != LAZY_LOADED || mLazyRoot == nullptr)
+		return;
+
+	for (auto child : mLazyRoot->mChildren)
+		child->setParent(mRootFolder);
+
+	mRootFolder->mChildren.insert(mRootFolder->mChildren.end(), mLazyRoot->mChildren.cbegin(), mLazyRoot->mChildren.cend());
+	mLazyRoot->mChildren.clear();
+
+	delete mLazyRoot;
+	mLazyRoot = nullptr;
+
+	mLazyState = LAZY_POPULATED;
+
+	if (mFilterIndex != nullptr)
+	{
+		deleteIndex();
+		getIndex(true);
+	}
+
+	updateDisplayedGameCount();
+	onFilesChanged();
+}
+
+void SystemData::ensurePopulated()
+{
+	if (mLazyState == LAZY_POPULATED)
+		return;
+
+	StopWatch stopWatch("SystemData::ensurePopulated - " + getName() + " :", LogDebug);
+
+	std::unique_lock<std::mutex> lock(sLazyLoadingLock);
+
+	if (mLazyState == LAZY_PENDING)
+	{
+		// Not started by the background thread yet : load it now, the thread will skip it
+		mLazyState = LAZY_LOADING;
+		lock.unlock();
+
+		FolderData* root = loadGames();
+
+		lock.lock();
+		mLazyRoot = root;
+		mLazyState = LAZY_LOADED;
+	}
+	else
+		sLazyLoadingEvent.wait(lock, [this] { return mLazyState != LAZY_LOADING; });
+
+	lock.unlock();
+	applyLoadedGames();
+}
+
+std::vector<SystemData*> SystemData::getPendingSystems()
+{
+	std::vector<SystemData*> ret;
+
+	for (auto system : sSystemVector)
+		if (!system->isPopulated())
+			ret.push_back(system);
+
+	return ret;
+}
+
+bool SystemData::populatePendingSystems()
+{
+	auto pending = getPendingSystems();
+	if (pending.empty())
+		return false;
+
+	for (auto system : pending)
+		system->ensurePopulated();
+
+	return true;
+}
+
 FileFilterIndex* SystemData::getIndex(bool createIndex)
 {
 	if (mFilterIndex == nullptr && createIndex)
@@ -785,10 +948,18 @@ void SystemData::loadAdditionnalConfig(pugi::xml_node& srcSystems)
 //creates systems from information located in a config file
 bool SystemData::loadConfig(Window* window)
 {
+	TRACE_SCOPE("SystemData::loadConfig");
+
 	deleteSystems();
 	ThemeData::setDefaultTheme(nullptr);
 	UIModeController::getInstance(); // Init UIModeController before loading systems
 
+	if (!sSettingsInvalidatorRegistered)
+	{
+		Settings::settingChanged += &sSettingsInvalidator;
+		sSettingsInvalidatorRegistered = true;
+	}
+
 	std::string path = getConfigPath();
 
 	LOG(LogInfo) << "Loading system config file " << path << "...";
@@ -838,6 +1009,11 @@ bool SystemData::loadConfig(Window* window)
 
 	CustomFeatures::loadEsFeaturesFile();
 
+	// Systems known from the last session are created without their games, they are loaded in background once the UI is up
+	sLazyLoading = window != nullptr && std::thread::hardware_concurrency() > 1 && Settings::ThreadedLoading() && Settings::LazySystemLoading();
+	if (sLazyLoading)
+		loadGameCountCache();
+
 	int currentSystem = 0;
 
 	typedef SystemData* SystemDataPtr;
@@ -941,21 +1117,227 @@ bool SystemData::loadConfig(Window* window)
 		}
 	}
 
-	if (window != nullptr && !ThreadedHasher::isRunning())
+	ThemeData::clearThemeCache();
+
+	// Settings resolved while loading didn't know the groups and the collections
+	resetSettings();
+
+	sLazyLoading = false;
+
+	if (getPendingSystems().size() > 0)
+		startLazyLoading(window); // Index checks need every game : they are started once loading is over
+	else
+		startIndexChecks(window);
+
+	return true;
+}
+
+void SystemData::startIndexChecks(Window* window)
+{
+	if (window == nullptr || ThreadedHasher::isRunning())
+		return;
+
+	int checkIndex = 0;
+
+	if (Settings::CheevosCheckIndexesAtStart())
+		checkIndex |= (int) ThreadedHasher::HASH_CHEEVOS_MD5;
+
+	if (SystemConf::getInstance()->getBool("global.netplay") && Settings::NetPlayCheckIndexesAtStart())
+		checkIndex |= (int) ThreadedHasher::HASH_NETPLAY_CRC;
+
+	if (checkIndex != 0)
+		ThreadedHasher::start(window, (ThreadedHasher::HasherType)checkIndex, false, true);
+}
+
+void SystemData::startLazyLoading(Window* window)
+{
+	std::vector<SystemData*> queue;
+
+	auto enqueue = [&queue](SystemData* system)
 	{
-		int checkIndex = 0;
+		if (system != nullptr && !system->isPopulated() && std::find(queue.cbegin(), queue.cend(), system) == queue.cend())
+			queue.push_back(system);
+	};
 
-		if (Settings::CheevosCheckIndexesAtStart())
-			checkIndex |= (int) ThreadedHasher::HASH_CHEEVOS_MD5;
+	// The system shown at startup first, then the visible systems in carousel order
+	auto startupSystem = Settings::getInstance()->getString("StartupSystem");
+	if (startupSystem == "lastsystem")
+		startupSystem = Settings::getInstance()->getString("LastSystem");
 
-		if (SystemConf::getInstance()->getBool("global.netplay") && Settings::NetPlayCheckIndexesAtStart())
-			checkIndex |= (int) ThreadedHasher::HASH_NETPLAY_CRC;
+	enqueue(getSystem(startupSystem));
+	enqueue(getSystem(Settings::getInstance()->getString("LastSystem")));
 
-		if (checkIndex != 0)
-			ThreadedHasher::start(window, (ThreadedHasher::HasherType)checkIndex, false, true);
+	for (auto system : sSystemVector)
+		if (system->isVisible())
+			enqueue(system);
+
+	for (auto system : sSystemVector)
+		enqueue(system);
+
+	LOG(LogInfo) << "Loading " << queue.size() << " systems in background";
+
+	std::unique_lock<std::mutex> lock(sLazyLoadingLock);
+	sLazyLoadingQueue = queue;
+	sLazyLoadingExit = false;
+	sLazyLoadingStartTime = SDL_GetTicks();
+	sLazyLoadingThread = new std::thread(&SystemData::lazyLoadingThread, window, sLazyLoadingGeneration);
+}
+
+void SystemData::stopLazyLoading()
+{
+	std::thread* thread = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(sLazyLoadingLock);
+		sLazyLoadingExit = true;
+		sLazyLoadingQueue.clear();
+		sLazyLoadingGeneration++;
+
+		thread = sLazyLoadingThread;
+		sLazyLoadingThread = nullptr;
 	}
 
-	return true;
+	// The system being loaded is finished first
+	if (thread != nullptr)
+	{
+		thread->join();
+		delete thread;
+	}
+}
+
+void SystemData::lazyLoadingThread(Window* window, int generation)
+{
+	while (true)
+	{
+		SystemData* system = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock(sLazyLoadingLock);
+
+			while (!sLazyLoadingExit && system == nullptr && !sLazyLoadingQueue.empty())
+			{
+				auto next = sLazyLoadingQueue.front();
+				sLazyLoadingQueue.erase(sLazyLoadingQueue.begin());
+
+				// Systems opened by the user are loaded by the UI thread
+				if (next->mLazyState == LAZY_PENDING)
+				{
+					next->mLazyState = LAZY_LOADING;
+					system = next;
+				}
+			}
+
+			if (system == nullptr)
+				break;
+		}
+
+		FolderData* root = system->loadGames();
+
+		{
+			std::unique_lock<std::mutex> lock(sLazyLoadingLock);
+			system->mLazyRoot = root;
+			system->mLazyState = LAZY_LOADED;
+			sLazyLoadingEvent.notify_all();
+
+			if (sLazyLoadingExit)
+				return;
+		}
+
+		window->postToUiThread([system, generation]
+		{
+			if (generation == sLazyLoadingGeneration)
+				system->applyLoadedGames();
+		});
+	}
+
+	window->postToUiThread([window, generation]
+	{
+		if (generation == sLazyLoadingGeneration)
+			onLazyLoadingCompleted(window);
+	});
+}
+
+void SystemData::onLazyLoadingCompleted(Window* window)
+{
+	{
+		std::unique_lock<std::mutex> lock(sLazyLoadingLock);
+		if (sLazyLoadingThread != nullptr)
+		{
+			sLazyLoadingThread->join();
+			delete sLazyLoadingThread;
+			sLazyLoadingThread = nullptr;
+		}
+	}
+
+	LOG(LogInfo) << "Systems loaded in background in " << SDL_GetTicks() - sLazyLoadingStartTime << "ms";
+
+	// Collections were built with the systems loaded at startup
+	ViewController::get()->refreshCollections();
+	startIndexChecks(window);
+}
+
+void SystemData::loadGameCountCache()
+{
+	sGameCountCache.clear();
+
+	std::string path = Paths::getUserEmulationStationPath() + "/gamecounts.xml";
+	if (!Utils::FileSystem::exists(path))
+		return;
+
+	pugi::xml_document doc;
+	if (!doc.load_file(WINSTRINGW(path).c_str()))
+	{
+		LOG(LogWarning) << "Could not parse " << path;
+		return;
+	}
+
+	for (pugi::xml_node node = doc.child("systems").child("system"); node; node = node.next_sibling("system"))
+	{
+		CachedGameCount entry;
+		entry.path = node.attribute("path").as_string();
+		entry.counts.visibleGames = node.attribute("visible").as_int();
+		entry.counts.totalGames = node.attribute("total").as_int();
+		entry.counts.playCount = node.attribute("playCount").as_int();
+		entry.counts.favoriteCount = node.attribute("favorites").as_int();
+		entry.counts.hiddenCount = node.attribute("hidden").as_int();
+		entry.counts.gamesPlayed = node.attribute("played").as_int();
+		entry.counts.playTime = node.attribute("playTime").as_llong();
+		entry.counts.mostPlayed = node.attribute("mostPlayed").as_string();
+		entry.counts.lastPlayedDate = node.attribute("lastPlayed").as_string();
+
+		sGameCountCache[node.attribute("name").as_string()] = entry;
+	}
+}
+
+void SystemData::saveGameCountCache()
+{
+	pugi::xml_document doc;
+	pugi::xml_node root = doc.append_child("systems");
+
+	for (auto system : sSystemVector)
+	{
+		if (system->isCollection() || system->isGroupSystem() || !system->isGameSystem() || !system->getSystemEnvData()->mGroup.empty())
+			continue;
+
+		GameCountInfo* counts = system->getGameCountInfo();
+
+		pugi::xml_node node = root.append_child("system");
+		node.append_attribute("name").set_value(system->getName().c_str());
+		node.append_attribute("path").set_value(system->getStartPath().c_str());
+		node.append_attribute("visible").set_value(counts->visibleGames);
+		node.append_attribute("total").set_value(counts->totalGames);
+		node.append_attribute("playCount").set_value(counts->playCount);
+		node.append_attribute("favorites").set_value(counts->favoriteCount);
+		node.append_attribute("hidden").set_value(counts->hiddenCount);
+		node.append_attribute("played").set_value(counts->gamesPlayed);
+		node.append_attribute("playTime").set_value((long long)counts->playTime);
+		node.append_attribute("mostPlayed").set_value(counts->mostPlayed.c_str());
+		node.append_attribute("lastPlayed").set_value(counts->lastPlayedDate.c_str());
+	}
+
+	std::string path = Paths::getUserEmulationStationPath() + "/gamecounts.xml";
+	if (!doc.save_file(WINSTRINGW(path).c_str()))
+		LOG(LogWarning) << "Could not save " << path;
 }
 
 SystemData* SystemData::loadSystem(std::string systemName, bool fullMode)
@@ -1175,7 +1557,7 @@ SystemData* SystemData::loadSystem(pugi::xml_node system, bool fullMode)
 	if (!fullMode)
 		return newSys;
 
-	if (!UIModeController::LoadEmptySystems() && newSys->getRootFolder()->getChildren().size() == 0)
+	if (!UIModeController::LoadEmptySystems() && newSys->isPopulated() && newSys->getRootFolder()->getChildren().size() == 0)
 	{
 		LOG(LogWarning) << "System \"" << md.name << "\" has no games! Ignoring it.";
 		delete newSys;
@@ -1188,6 +1570,67 @@ SystemData* SystemData::loadSystem(pugi::xml_node system, bool fullMode)
 	return newSys;
 }
 
+void SystemData::setDirtyFile(FileData* file, bool dirty)
+{
+	std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+
+	if (dirty)
+	{
+		mDirtyFiles.insert(file);
+		mDataVersion = ++sVersionCounter;
+	}
+	else
+		mDirtyFiles.erase(file);
+}
+
+std::vector<FileData*> SystemData::getDirtyFiles()
+{
+	std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+	return std::vector<FileData*>(mDirtyFiles.cbegin(), mDirtyFiles.cend());
+}
+
+bool SystemData::hasDirtyFiles()
+{
+	std::unique_lock<std::mutex> lock(mDirtyFilesLock);
+	return !mDirtyFiles.empty();
+}
+
+size_t SystemData::getMemoryUsage()
+{
+	// Games loaded in background aren't owned by the UI thread yet
+	if (!isPopulated() || mRootFolder == nullptr)
+		return mMemoryUsage;
+
+	unsigned int version = mDataVersion;
+	if (version == mMemoryUsageVersion)
+		return mMemoryUsage;
+
+	size_t size = sizeof(SystemData);
+
+	std::stack<FolderData*> stack;
+	stack.push(mRootFolder);
+
+	while (stack.size())
+	{
+		FolderData* current = stack.top();
+		stack.pop();
+
+		size += current->getMemoryUsage();
+
+		for (auto it : current->getChildren())
+		{
+			if (it->getType() == FOLDER)
+				stack.push((FolderData*)it);
+			else
+				size += it->getMemoryUsage();
+		}
+	}
+
+	mMemoryUsage = size;
+	mMemoryUsageVersion = version;
+	return size;
+}
+
 bool SystemData::hasDirtySystems()
 {
 	bool saveOnExit = !Settings::IgnoreGamelist() && Settings::SaveGamelistsOnExit();
@@ -1209,19 +1652,47 @@ bool SystemData::hasDirtySystems()
 
 void SystemData::deleteSystems()
 {
+	stopLazyLoading();
+
+	if (Settings::LazySystemLoading() && sSystemVector.size() > 0)
+		saveGameCountCache();
+
 	bool saveOnExit = !Settings::IgnoreGamelist() && Settings::SaveGamelistsOnExit();
 
-	for (unsigned int i = 0; i < sSystemVector.size(); i++)
+	for (auto system : sSystemVector)
+		system->getRootFolder()->removeVirtualFolders();
+
+	// Gamelists are independant files : save them in parallel. The workers only see copies of the changes, games are read here
+	if (saveOnExit)
 	{
-		SystemData* pData = sSystemVector.at(i);
-		pData->getRootFolder()->removeVirtualFolders();
+		std::vector<GamelistUpdate*> updates;
+		Utils::ThreadPool pool;
+
+		for (auto system : sSystemVector)
+		{
+			if (system->mIsCollectionSystem || !hasDirtyFile(system))
+				continue;
 
-		if (saveOnExit && !pData->mIsCollectionSystem)
-			updateGamelist(pData);
+			GamelistUpdate* update = new GamelistUpdate(system);
+			updates.push_back(update);
 
-		delete pData;
+			pool.queueWorkItem([update] { update->write(); });
+		}
+
+		pool.wait();
+
+		for (auto update : updates)
+		{
+			update->commit();
+			delete update;
+		}
 	}
 
+	NetPlayIndex::clear();
+
+	for (auto system : sSystemVector)
+		delete system;
+
 	sSystemVector.clear();
 	IsManufacturerSupported = false;
 }
@@ -1394,6 +1865,16 @@ GameCountInfo* SystemData::getGameCountInfo()
 	if (mGameCountInfo != nullptr)
 		return mGameCountInfo;	
 
+	if (!isPopulated())
+	{
+		auto cache = sGameCountCache.find(getName());
+		if (cache != sGameCountCache.cend())
+		{
+			mGameCountInfo = new GameCountInfo(cache->second.counts);
+			return mGameCountInfo;
+		}
+	}
+
 	std::vector<FileData*> games = mRootFolder->getFilesRecursive(GAME, true);
 
 	int realTotal = games.size();
@@ -1467,6 +1948,8 @@ void SystemData::updateDisplayedGameCount()
 
 void SystemData::loadTheme()
 {
+	TRACE_SCOPE_DETAIL("SystemData::loadTheme", getName());
+
 	mTheme = std::make_shared<ThemeData>();
 
 	std::string path = getThemePath();
@@ -1959,8 +2442,76 @@ bool SystemData::shouldExtractHashesFromArchives()
 
 void SystemData::resetSettings()
 {
-	for(auto sys : sSystemVector)
-		sys->mShowFilenames.reset();
+	sSettingsGeneration++;
+}
+
+static bool getSystemBoolSetting(const std::string& systemName, const std::string& settingName)
+{
+	auto value = Settings::getInstance()->getString(systemName + "." + settingName);
+	if (value == "1")
+		return true;
+	else if (value == "0")
+		return false;
+
+	return Settings::getInstance()->getBool(settingName);
+}
+
+SystemSettingsRef SystemData::loadSettings()
+{
+	std::unique_lock<std::mutex> lock(mSettingsLock);
+
+	unsigned int generation = sSettingsGeneration;
+
+	SystemSettingsRef current = std::atomic_load(&mSettings);
+	if (current != nullptr && current->generation == generation)
+		return current;
+
+	Settings* config = Settings::getInstance();
+	std::string name = getName();
+
+	auto settings = std::make_shared<SystemSettings>();
+	settings->generation = generation;
+
+	auto showHiddenFiles = config->getString(name + ".ShowHiddenFiles");
+	settings->showHiddenFilesOverride = showHiddenFiles == "1" ? 1 : showHiddenFiles == "0" ? 0 : -1;
+	settings->showHiddenFiles = settings->showHiddenFilesOverride < 0 ? config->getBool("ShowHiddenFiles") : settings->showHiddenFilesOverride == 1;
+
+	auto group = getParentGroupSystem();
+	auto showFilenames = config->getString((group ? group->getName() : name) + ".ShowFilenames");
+	settings->showFilenames = showFilenames.empty() ? config->getBool("ShowFilenames") : showFilenames == "1";
+
+	settings->showParentFolder = getSystemBoolSetting(name, "ShowParentFolder");
+	settings->favoritesFirst = getShowFavoritesIcon() && getSystemBoolSetting(name, "FavoritesFirst");
+
+	for (auto& flag : sSystemFlagSettings)
+		settings->flags[flag] = getSystemBoolSetting(name, flag);
+
+	// Flags
+	settings->showFlags = 0;
+	if (getShowFavoritesIcon() && !hasPlatformId(PlatformIds::IMAGEVIEWER) && !hasPlatformId(PlatformIds::PLATFORM_IGNORE))
+	{
+		auto spf = config->getString(name + ".ShowFlags");
+		if (spf == "" || spf == "auto")
+			settings->showFlags = Utils::String::toInteger(config->getString("ShowFlags"));
+		else
+			settings->showFlags = Utils::String::toInteger(spf);
+	}
+
+	// Folder view mode
+	auto fvm = config->getString(name + ".FolderViewMode");
+	if (this == CollectionSystemManager::get()->getCustomCollectionsBundle() || name == "windows_installers")
+		settings->folderViewMode = "always";
+	else if (!fvm.empty() && fvm != "auto")
+		settings->folderViewMode = fvm;
+	else
+		settings->folderViewMode = config->getString("FolderViewMode");
+
+	for (auto ext : Utils::String::split(Utils::String::toLower(config->getString(name + ".HiddenExt")), ';', true))
+		settings->hiddenExtensions.insert(ext);
+
+	// Readers holding the previous settings keep them alive
+	std::atomic_store(&mSettings, SystemSettingsRef(settings));
+	return settings;
 }
 
 SaveStateRepository* SystemData::getSaveStateRepository()
@@ -1973,64 +2524,33 @@ SaveStateRepository* SystemData::getSaveStateRepository()
 
 bool SystemData::getShowFilenames()
 {
-	if (mShowFilenames == nullptr)
-	{
-		auto group = getParentGroupSystem();
-		std::string name = group ? group->getName() : getName();
-
-		auto curFn = Settings::getInstance()->getString(name + ".ShowFilenames");
-		if (curFn.empty())
-			mShowFilenames = std::make_shared<bool>(Settings::getInstance()->getBool("ShowFilenames"));
-		else
-			mShowFilenames = std::make_shared<bool>(curFn == "1");
-	}
-
-	return *mShowFilenames;
+	return getSettings()->showFilenames;
 }
 
 bool SystemData::getBoolSetting(const std::string& settingName)
 {
-	bool show = Settings::getInstance()->getBool(settingName);
+	auto settings = getSettings();
 
-	auto spf = Settings::getInstance()->getString(getName() + "." + settingName);
-	if (spf == "1")
-		return true;
-	else if (spf == "0")
-		return false;
+	auto it = settings->flags.find(settingName);
+	if (it != settings->flags.cend())
+		return it->second;
 
-	return show;
+	return getSystemBoolSetting(getName(), settingName);
 }
 
 bool SystemData::getShowParentFolder()
 {
-	return getBoolSetting("ShowParentFolder");
+	return getSettings()->showParentFolder;
 }
 
 std::string SystemData::getFolderViewMode()
 {
-	if (this == CollectionSystemManager::get()->getCustomCollectionsBundle())
-		return "always";
-
-	std::string showFoldersMode = Settings::getInstance()->getString("FolderViewMode");
-
-	auto fvm = Settings::getInstance()->getString(getName() + ".FolderViewMode");
-	if (!fvm.empty() && fvm != "auto") 
-		showFoldersMode = fvm;
-
-	if ((fvm.empty() || fvm == "auto") && this == CollectionSystemManager::get()->getCustomCollectionsBundle())
-		showFoldersMode = "always";
-	else if (getName() == "windows_installers")
-		showFoldersMode = "always";
-
-	return showFoldersMode;
+	return getSettings()->folderViewMode;
 }
 
 bool SystemData::getShowFavoritesFirst()
 {
-	if (!getShowFavoritesIcon())
-		return false;
-
-	return getBoolSetting("FavoritesFirst");
+	return getSettings()->favoritesFirst;
 }
 
 bool SystemData::getShowFavoritesIcon()
@@ -2048,19 +2568,7 @@ bool SystemData::getShowCheevosIcon()
 
 int SystemData::getShowFlags()
 {
-	if (!getShowFavoritesIcon())
-		return false;
-
-	if (hasPlatformId(PlatformIds::IMAGEVIEWER) || hasPlatformId(PlatformIds::PLATFORM_IGNORE))
-		return false;
-
-	int show = Utils::String::toInteger(Settings::getInstance()->getString("ShowFlags"));
-
-	auto spf = Settings::getInstance()->getString(getName() + ".ShowFlags");
-	if (spf == "" || spf == "auto")
-		return show;
-	
-	return Utils::String::toInteger(spf);
+	return getSettings()->showFlags;
 }
 
 BindableRandom::BindableRandom(SystemData* system)
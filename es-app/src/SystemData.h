@@ -12,6 +12,8 @@
 #include <pugixml/src/pugixml.hpp>
 #include <unordered_map>
 #include <unordered_set>
+#include <mutex>
+#include <atomic>
 #include "FileFilterIndex.h"
 #include "KeyboardMapping.h"
 #include "math/Vector2f.h"
@@ -25,6 +27,27 @@ class ThemeData;
 class Window;
 class SaveStateRepository;
 
+// Settings which can be overridden per system with "<system>.<name>", resolved once.
+// They are built again after one of them has changed, see SystemData::getSettings()
+struct SystemSettings
+{
+	unsigned int generation;
+
+	bool showHiddenFiles;
+	int showHiddenFilesOverride; // -1 when the system uses the global setting
+	bool showFilenames;
+	bool showParentFolder;
+	bool favoritesFirst;
+	int showFlags;
+	std::string folderViewMode;
+	std::set<std::string> hiddenExtensions; // Lower case, without the dot
+	std::map<std::string, bool> flags; // Other boolean settings, read by getBoolSetting()
+};
+
+// Immutable settings of a system, returned by SystemData::getSettings(). Replaced settings are freed with their last
+// reference : keep the reference for as long as its values are used, not the values alone.
+typedef std::shared_ptr<const SystemSettings> SystemSettingsRef;
+
 struct GameCountInfo
 {
 	int visibleGames;
@@ -110,6 +133,13 @@ public:
 	GameCountInfo* getGameCountInfo();
 	void updateDisplayedGameCount();
 
+	// LazySystemLoading : systems are created with the game counts of the last session, their games are loaded afterwards by a background thread
+	inline bool isPopulated() const { return mLazyState == LAZY_POPULATED; }
+	inline bool isLoadedInBackground() const { return mLoadedInBackground; }
+	void ensurePopulated(); // Blocks until the games of this system are loaded. UI thread only
+	static std::vector<SystemData*> getPendingSystems();
+	static bool populatePendingSystems(); // Loads every pending system now, returns false if there was none. UI thread only
+
 	static bool IsManufacturerSupported;
 	static bool hasDirtySystems();
 	static void deleteSystems();
@@ -177,6 +207,19 @@ public:
 	void setGamelistHash(size_t size) { mGameListHash = size; }
 	size_t getGamelistHash() { return mGameListHash; }
 
+	// Files with unsaved metadata changes
+	void setDirtyFile(FileData* file, bool dirty);
+	std::vector<FileData*> getDirtyFiles();
+	bool hasDirtyFiles();
+
+	// Versions are unique across systems : FilesVersion changes when games are added or removed, DataVersion on any change
+	unsigned int getFilesVersion() { return mFilesVersion; }
+	unsigned int getDataVersion() { return mDataVersion; }
+	void onFilesChanged() { mFilesVersion = mDataVersion = ++sVersionCounter; }
+
+	// Estimated bytes of the games, folders and metadata, measured again when DataVersion changes. UI thread
+	size_t getMemoryUsage();
+
 	bool isNetplaySupported();
 	bool isCheevosSupported();
 
@@ -223,6 +266,16 @@ public:
 	std::string getFolderViewMode();
 	bool getBoolSetting(const std::string& settingName);
 
+	// Can be called from any thread : only the first call after a change builds the settings again
+	inline SystemSettingsRef getSettings()
+	{
+		SystemSettingsRef settings = std::atomic_load(&mSettings);
+		if (settings != nullptr && settings->generation == sSettingsGeneration.load(std::memory_order_relaxed))
+			return settings;
+
+		return loadSettings();
+	}
+
 	static void resetSettings();
 
 	SaveStateRepository* getSaveStateRepository();
@@ -251,7 +304,21 @@ private:
 	void populateFolder(FolderData* folder, std::unordered_map<std::string, FileData*>& fileMap);
 	void indexAllGameFilters(const FolderData* folder);
 	void setIsGameSystemStatus();
-	void removeMultiDiskContent(std::unordered_map<std::string, FileData*>& fileMap);
+	void removeMultiDiskContent(FolderData* root, std::unordered_map<std::string, FileData*>& fileMap);
+
+	enum LazyState { LAZY_POPULATED, LAZY_PENDING, LAZY_LOADING, LAZY_LOADED };
+
+	FolderData* loadGames();
+	void applyLoadedGames();
+
+	static void startLazyLoading(Window* window);
+	static void stopLazyLoading();
+	static void lazyLoadingThread(Window* window, int generation);
+	static void onLazyLoadingCompleted(Window* window);
+	static void startIndexChecks(Window* window);
+
+	static void loadGameCountCache();
+	static void saveGameCountCache();
 
 	static SystemData* loadSystem(pugi::xml_node system, bool fullMode = true);
 	static void loadAdditionnalConfig(pugi::xml_node& srcSystems);
@@ -267,12 +334,32 @@ private:
 	std::string mViewMode;
 	Vector2f    mGridSizeOverride;	
 	
-	std::shared_ptr<bool> mShowFilenames;
+	SystemSettingsRef loadSettings();
+
+	SystemSettingsRef mSettings; // Accessed with std::atomic_load / std::atomic_store
+	std::mutex mSettingsLock;
+
+	static std::atomic<unsigned int> sSettingsGeneration;
 
 	GameCountInfo* mGameCountInfo;
 	SaveStateRepository* mSaveRepository;
 
 	bool mHidden;
+
+	std::atomic<int> mLazyState;
+	FolderData* mLazyRoot; // Games loaded in background, waiting to be moved to mRootFolder on the UI thread
+	bool mLoadedInBackground;
+
+	std::unordered_set<FileData*> mDirtyFiles;
+	std::mutex mDirtyFilesLock;
+
+	std::atomic<unsigned int> mFilesVersion;
+	std::atomic<unsigned int> mDataVersion;
+
+	size_t mMemoryUsage;
+	unsigned int mMemoryUsageVersion;
+
+	static std::atomic<unsigned int> sVersionCounter;
 };
 
 #endif // ES_APP_SYSTEM_DATA_H
@@ -320,6 +320,17 @@ unsigned long SystemScreenSaver::countGameListNodes(bool video)
 		if (!system->isGameSystem() || system->isCollection() || system->hasPlatformId(PlatformIds::IMAGEVIEWER) || system->hasPlatformId(PlatformIds::PLATFORM_IGNORE))
 			continue;
 
+		// Not loaded yet : the list is built again once every system is loaded
+		if (!system->isPopulated())
+		{
+			if (video)
+				mGamesWithVideosLoaded = false;
+			else
+				mGamesWithImagesLoaded = false;
+
+			continue;
+		}
+
 		auto games = system->getRootFolder()->getFilesRecursive(GAME, true);
 		for (auto game : games)
 		{
@@ -202,6 +202,8 @@ void ThreadedHasher::start(Window* window, HasherType type, bool forceAllGames,
 		if (!sys->isGameSystem() || sys->getRootFolder() == nullptr)
 			continue;
 
+		sys->ensurePopulated();
+
 		if (sys->isGroupChildSystem() ? sys->isHidden() : !sys->isVisible())
 			continue;
 
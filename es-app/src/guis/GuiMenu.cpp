@@ -715,6 +715,17 @@ void GuiMenu::openDeveloperSettings()
 	max_vram->setValue((float)(Settings::getInstance()->getInt("MaxVRAM")));
 	s->addWithLabel(_("VRAM LIMIT"), max_vram);
 	s->addSaveFunc([max_vram] { Settings::getInstance()->setInt("MaxVRAM", (int)round(max_vram->getValue())); });
+
+	// gamelist views kept in memory
+	auto max_gamelists = std::make_shared<SliderComponent>(mWindow, 0.f, 150.f, 1.f, "");
+	max_gamelists->setValue((float)(Settings::getInstance()->getInt("GameListViewsMaxCount")));
+	s->addWithDescription(_("MAXIMUM GAMELISTS KEPT IN MEMORY"), _("Least recently used gamelists are released above this limit. 0 = unlimited"), max_gamelists);
+	s->addSaveFunc([max_gamelists] { Settings::getInstance()->setInt("GameListViewsMaxCount", (int)round(max_gamelists->getValue())); });
+
+	auto max_gamelists_memory = std::make_shared<SliderComponent>(mWindow, 0.f, 1000.f, 10.f, "Mb");
+	max_gamelists_memory->setValue((float)(Settings::getInstance()->getInt("GameListViewsMaxMemory")));
+	s->addWithDescription(_("GAMELISTS MEMORY LIMIT"), _("Least recently used gamelists are released above this limit. 0 = unlimited"), max_gamelists_memory);
+	s->addSaveFunc([max_gamelists_memory] { Settings::getInstance()->setInt("GameListViewsMaxMemory", (int)round(max_gamelists_memory->getValue())); });
 	
 	s->addSwitch(_("SHOW FRAMERATE"), _("Also turns on the emulator's native FPS counter, if available."), "DrawFramerate", true, nullptr);
 	s->addSwitch(_("VSYNC"), "VSync", true, [] { Renderer::setSwapInterval(); });
@@ -780,7 +791,7 @@ void GuiMenu::openDeveloperSettings()
 
 	auto webAccess = std::make_shared<SwitchComponent>(mWindow);
 	webAccess->setState(Settings::getInstance()->getBool("PublicWebAccess"));
-	s->addWithDescription(_("ENABLE PUBLIC WEB API ACCESS"), Utils::String::format(_("Allow public web access API using %s").c_str(), std::string("http://" + hostName + ":1234").c_str()), webAccess);
+	s->addWithDescription(_("ENABLE PUBLIC WEB API ACCESS"), Utils::String::format(_("Allow public web access API using %s").c_str(), std::string("http://" + hostName + ":" + std::to_string(Settings::getInstance()->getInt("HttpServerPort"))).c_str()), webAccess);
 	s->addSaveFunc([webAccess, window, s]
 	{ 
 	  if (Settings::getInstance()->setBool("PublicWebAccess", webAccess->getState())) 
@@ -882,6 +893,10 @@ void GuiMenu::openDeveloperSettings()
 	s->addEntry(_("REDETECT ALL GAMES' LANG/REGION"), false, [this]
 	{
 		Window* window = mWindow;
+
+		// The games are updated by another thread
+		SystemData::populatePendingSystems();
+
 		window->pushGui(new GuiLoading<int>(window, _("PLEASE WAIT"), [](auto gui)
 		{
 			for (auto system : SystemData::sSystemVector)
@@ -927,6 +942,7 @@ void GuiMenu::openDeveloperSettings()
 				}
 
 				mWindow->renderSplashScreen(_("Building image cache") + ": " + sys->getFullName(), (float)idx / (float)SystemData::sSystemVector.size());
+				sys->ensurePopulated();
 
 				for (auto file : sys->getRootFolder()->getFilesRecursive(GAME))
 				{
@@ -1150,6 +1166,12 @@ void GuiMenu::openDeveloperSettings()
 	s->addWithLabel(_("THREADED LOADING"), threadedLoading);
 	s->addSaveFunc([threadedLoading] { Settings::getInstance()->setBool("ThreadedLoading", threadedLoading->getState()); });
 
+	// lazy system loading
+	auto lazyLoading = std::make_shared<SwitchComponent>(mWindow);
+	lazyLoading->setState(Settings::getInstance()->getBool("LazySystemLoading"));
+	s->addWithDescription(_("LOAD GAMES IN BACKGROUND"), _("Shows systems with the game counts of the last session and loads their games after boot"), lazyLoading);
+	s->addSaveFunc([lazyLoading] { Settings::getInstance()->setBool("LazySystemLoading", lazyLoading->getState()); });
+
 	// threaded loading
 	auto asyncImages = std::make_shared<SwitchComponent>(mWindow);
 	asyncImages->setState(Settings::getInstance()->getBool("AsyncImages"));
@@ -1167,6 +1189,10 @@ void GuiMenu::openDeveloperSettings()
 	optimizeVideo->setState(Settings::getInstance()->getBool("OptimizeVideo"));
 	s->addWithLabel(_("OPTIMIZE VIDEO VRAM USAGE"), optimizeVideo);
 	s->addSaveFunc([optimizeVideo] { Settings::getInstance()->setBool("OptimizeVideo", optimizeVideo->getState()); });
+
+	// video pixel format
+	if (Renderer::supportYUVTextures())
+		s->addOptionList(_("VIDEO PIXEL FORMAT"), _("YUV formats reduce CPU usage and texture uploads, colour conversion is done by the GPU"), { { "RGBA", "" },{ "I420", "i420" },{ "NV12", "nv12" } }, "VideoPixelFormat", true, nullptr);
 	
 	s->onFinalize([s, window]
 	{					
@@ -1,7 +1,6 @@
 #include "GuiNetPlay.h"
 #include "Window.h"
 #include <string>
-#include <future>
 #include <fcntl.h>
 #include "Log.h"
 #include "Settings.h"
@@ -12,6 +11,7 @@
 #include "guis/GuiMsgBox.h"
 #include "SystemData.h"
 #include "FileData.h"
+#include "NetPlayIndex.h"
 #include "ThemeData.h"
 #include "components/MenuComponent.h"
 #include "components/ButtonComponent.h"
@@ -478,15 +478,6 @@ std::vector<HelpPrompt> GuiNetPlay::getHelpPrompts()
 
 FileData* GuiNetPlay::getFileData(std::string gameInfo, bool crc, std::string coreName)
 {
-	auto normalizeName = [](const std::string name)
-	{
-		auto ret = Utils::String::toLower(name);
-		ret = Utils::String::replace(ret, "_", " ");
-		ret = Utils::String::replace(ret, ".", "");
-		ret = Utils::String::replace(ret, "'", "");
-		return Utils::String::removeParenthesis(ret);
-	};
-
 	std::string lowCore;
 
 	auto coreInfo = coreList.find(coreName);
@@ -495,10 +486,6 @@ FileData* GuiNetPlay::getFileData(std::string gameInfo, bool crc, std::string co
 	else
 		lowCore = Utils::String::toLower(Utils::String::replace(coreName, " ", "_"));
 	
-	std::string normalizedName = normalizeName(gameInfo);
-	std::string normalizedNameNoSpace = Utils::String::replace(normalizedName, " ", "");
-
-	std::vector<std::future<FileData*>> futures;
 	for (auto sys : SystemData::sSystemVector)
 	{
 		if (!sys->isNetplaySupported())
@@ -520,38 +507,9 @@ FileData* GuiNetPlay::getFileData(std::string gameInfo, bool crc, std::string co
 				continue;
 		}
 
-		futures.push_back(std::async(std::launch::async, [sys, crc, gameInfo, normalizedName, normalizedNameNoSpace, &normalizeName]() -> FileData* {
-			for (auto file : sys->getRootFolder()->getFilesRecursive(GAME, false, sys))
-			{
-				if (crc)
-				{
-					if (file->getMetadata(MetaDataId::Crc32) == gameInfo)
-						return file;
+		sys->ensurePopulated();
 
-					continue;
-				}
-				else
-				{
-					std::string stem = normalizeName(file->getName());
-					if (stem == normalizedName)
-						return file;
-
-					stem = normalizeName(Utils::FileSystem::getStem(file->getPath()));
-					if (stem == normalizedName)
-						return file;
-
-					stem = Utils::String::replace(normalizeName(file->getName()), " ", "");
-					if (stem == Utils::String::replace(normalizedName, " ", ""))
-						return file;
-				}
-			}
-			return nullptr;
-		}));
-	}
-
-	for (auto& fut : futures)
-	{
-		FileData* file = fut.get();
+		FileData* file = crc ? NetPlayIndex::findByCrc(sys, gameInfo) : NetPlayIndex::findByName(sys, gameInfo);
 		if (file != nullptr)
 			return file;
 	}
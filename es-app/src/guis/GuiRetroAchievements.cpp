@@ -383,6 +383,8 @@ FileData* GuiRetroAchievements::getFileData(const std::string& cheevosGameId)
 		if (!sys->isCheevosSupported())
 			continue;
 
+		sys->ensurePopulated();
+
 		for (auto file : sys->getRootFolder()->getFilesRecursive(GAME))
 			if (file->getMetadata(MetaDataId::CheevosId) == cheevosGameId)
 				return file;
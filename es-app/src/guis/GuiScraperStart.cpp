@@ -167,6 +167,10 @@ void GuiScraperStart::start()
 		return;
 	}
 
+	// The searches are built by another thread : systems still loading in background must be complete
+	for (auto system : mSystems->getSelectedObjects())
+		system->ensurePopulated();
+
 	mWindow->pushGui(new GuiLoading<std::queue<ScraperSearchParams>>(mWindow, _("PLEASE WAIT"),
 		[this](IGuiLoadingHandler* gui)
 		{
@@ -2,6 +2,7 @@
 //http://www.aloshi.com
 
 #include "services/HttpServerThread.h"
+#include "services/LibrarySnapshot.h"
 #include "guis/GuiDetectDevice.h"
 #include "guis/GuiMsgBox.h"
 #include "utils/FileSystemUtil.h"
@@ -16,6 +17,7 @@
 #include "PowerSaver.h"
 #include "Settings.h"
 #include "SystemData.h"
+#include "Gamelist.h"
 #include "SystemScreenSaver.h"
 #include <SDL_events.h>
 #include <SDL_main.h>
@@ -39,9 +41,15 @@
 #include "Paths.h"
 #include "resources/TextureData.h"
 #include "Scripting.h"
+#include "Trace.h"
+#include "FrameTimings.h"
+#include "MemoryAccounting.h"
+#include "ThemeData.h"
+#include "Benchmark.h"
 #include "watchers/WatchersManager.h"
 #include "HttpReq.h"
 #include <thread>
+#include <unordered_set>
 
 #ifdef WIN32
 #include <Windows.h>
@@ -74,6 +82,26 @@ bool parseArgs(int argc, char* argv[])
 		}
 	}
 
+	// The benchmark can generate its own home, it must be known before the settings are loaded too
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--benchmark-output") == 0)
+			Benchmark::setOutputPath(argv[i + 1]);
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+			Benchmark::setHeadless();
+		else if (strcmp(argv[i], "--benchmark") == 0 && i < argc - 1)
+		{
+			if (!Benchmark::load(argv[i + 1]))
+				return false;
+
+			break;
+		}
+	}
+
 	for(int i = 1; i < argc; i++)
 	{
 		if (strcmp(argv[i], "--videoduration") == 0)
@@ -249,6 +277,9 @@ bool parseArgs(int argc, char* argv[])
 				"--force-kiosk		Force the UI mode to be Kiosk\n"
 				"--force-disable-filters		Force the UI to ignore applied filters in gamelist\n"
 				"--home [path]		Directory to use as home path\n"
+				"--benchmark [script]		Replay a benchmark script, see Benchmark.h\n"
+				"--benchmark-output [path]	Save the benchmark report to this file instead of stdout\n"
+				"--headless		Use SDL offscreen video and dummy audio drivers\n"
 				"--help, -h			summon a sentient, angry tuba\n\n"
 				"--monitor [index]			monitor index\n\n"				
 				"More information available in README.md.\n";
@@ -512,6 +543,11 @@ int main(int argc, char* argv[])
 
 	LOG(LogInfo) << "EmulationStation - v" << PROGRAM_VERSION_STRING << ", built " << PROGRAM_BUILT_STRING;
 
+	Trace::setThreadName("main");
+	Trace::installSignalHandler();
+	if (Settings::getInstance()->getBool("Trace"))
+		Trace::setEnabled(true);
+
 	//always close the log on exit
 	atexit(&onExit);
 
@@ -577,6 +613,8 @@ int main(int argc, char* argv[])
 		window.pushGui(new GuiMsgBox(&window, errorMsg, _("QUIT"), [] { Utils::Platform::quitES(); }));
 	}
 
+	Benchmark::markBoot("systemsLoaded");
+
 	SystemConf* systemConf = SystemConf::getInstance();
 
 #ifdef _ENABLE_KODI_
@@ -603,6 +641,7 @@ int main(int argc, char* argv[])
 	// preload what we can right away instead of waiting for the user to select it
 	// this makes for no delays when accessing content, but a longer startup time
 	ViewController::get()->preload();
+	Benchmark::markBoot("preloaded");
 
 	// Initialize input
 	InputConfig::AssignActionButtons();
@@ -610,8 +649,39 @@ int main(int argc, char* argv[])
 	SDL_StopTextInput();
 
 	NetworkThread* nthread = new NetworkThread(&window);
+
+	LibrarySnapshot::publish(true);
 	HttpServerThread httpServer(&window);
 
+	MemoryAccounting::setProvider(MemoryAccounting::LIBRARY, []()
+	{
+		int64_t size = 0;
+		for (auto system : SystemData::sSystemVector)
+			size += system->getMemoryUsage();
+
+		return size;
+	});
+
+	MemoryAccounting::setProvider(MemoryAccounting::THEMES, []()
+	{
+		// Most systems share the same theme
+		std::unordered_set<ThemeData*> themes;
+		for (auto system : SystemData::sSystemVector)
+			if (system->getTheme() != nullptr)
+				themes.insert(system->getTheme().get());
+
+		int64_t size = 0;
+		for (auto theme : themes)
+			size += theme->getMemoryUsage();
+
+		return size;
+	});
+
+	MemoryAccounting::setProvider(MemoryAccounting::GAMELIST_VIEWS, []()
+	{
+		return ViewController::hasInstance() ? (int64_t)ViewController::get()->getGameListViewsMemoryUsage() : (int64_t)0;
+	});
+
 	// tts
 	TextToSpeech::getInstance()->enable(Settings::getInstance()->getBool("TTS"), false);
 	
@@ -622,6 +692,7 @@ int main(int argc, char* argv[])
 
 	// Create a flag in  temporary directory to signal READY state
 	ApiSystem::getInstance()->setReadyFlag();
+	Benchmark::markBoot("ready");
 
 	// Play music
 	AudioManager::getInstance()->init();
@@ -663,8 +734,17 @@ int main(int argc, char* argv[])
 
 		SDL_Event event;
 
+		FrameTimings::beginFrame();
+		Benchmark::update(&window);
+
 		bool ps_standby = PowerSaver::getState() && (int) SDL_GetTicks() - ps_time > PowerSaver::getMode();
-		if(ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : SDL_PollEvent(&event))
+		bool hasEvent = ps_standby ? SDL_WaitEventTimeout(&event, PowerSaver::getTimeout()) : SDL_PollEvent(&event);
+
+		// Waiting for events isn't part of the frame
+		if (ps_standby)
+			FrameTimings::beginFrame();
+
+		if (hasEvent)
 		{
 			// PowerSaver can push events to exit SDL_WaitEventTimeout immediatly
 			// Reset this event's state
@@ -700,6 +780,9 @@ int main(int argc, char* argv[])
 		  //	ps_time = SDL_GetTicks();
 		}
 
+		// Metadata changes written in a burst are synced once the burst is over
+		TRYCATCH("Gamelist.syncJournals", syncGamelistJournals())
+
 		if (window.isSleeping())
 		{
 			lastTime = SDL_GetTicks();
@@ -707,6 +790,8 @@ int main(int argc, char* argv[])
 			continue;
 		}
 
+		FrameTimings::endPhase(FrameTimings::PHASE_INPUT);
+
 		int curTime = SDL_GetTicks();
 		int deltaTime = curTime - lastTime;
 		lastTime = curTime;
@@ -716,7 +801,11 @@ int main(int argc, char* argv[])
 			deltaTime = 1000;
 
 		TRYCATCH("Window.update" ,window.update(deltaTime))	
+		TRYCATCH("LibrarySnapshot.publish", LibrarySnapshot::publish())
+		FrameTimings::endPhase(FrameTimings::PHASE_UPDATE);
+
 		TRYCATCH("Window.render", window.render())
+		FrameTimings::endPhase(FrameTimings::PHASE_RENDER);
 
 /*
 #ifdef WIN32		
@@ -731,8 +820,10 @@ int main(int argc, char* argv[])
 */
 
 		Renderer::swapBuffers();
+		FrameTimings::endPhase(FrameTimings::PHASE_SWAP);
+		FrameTimings::endFrame();
 
-		Log::flush();
+		Trace::processSignal();
 	}
 
 	if (Utils::Platform::isFastShutdown())
@@ -741,6 +832,8 @@ int main(int argc, char* argv[])
 	WatchersManager::stop();
 	ThreadedHasher::stop();
 	ThreadedScraper::stop();
+	LibrarySnapshot::stop();
+	syncGamelistJournals(true);
 
 	ApiSystem::getInstance()->deinit();
 
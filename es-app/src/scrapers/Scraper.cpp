@@ -5,6 +5,7 @@
 #include "GamesDBJSONScraper.h"
 #include "ScreenScraper.h"
 #include "Log.h"
+#include "Trace.h"
 #include "Settings.h"
 #include "SystemData.h"
 #include <FreeImage.h>
@@ -187,6 +188,8 @@ bool Scraper::isMediaSupported(const Scraper::ScraperMediaSource& md)
 
 std::unique_ptr<ScraperSearchHandle> Scraper::search(const ScraperSearchParams& params)
 {
+	TRACE_SCOPE("Scraper::search");
+
 	std::unique_ptr<ScraperSearchHandle> handle(new ScraperSearchHandle());
 	generateRequests(params, handle->mRequestQueue, handle->mResults);
 	return handle;
@@ -301,6 +304,8 @@ void ScraperHttpRequest::update()
 
 	if(status == HttpReq::REQ_SUCCESS)
 	{
+		TRACE_SCOPE_DETAIL("Scraper::process", mRequest->getUrl());
+
 		setStatus(ASYNC_DONE); // if process() has an error, status will be changed to ASYNC_ERROR
 		process(mRequest, mResults);
 		return;
@@ -363,6 +368,8 @@ std::unique_ptr<MDResolveHandle> ScraperSearchResult::resolveMetaDataAssets(cons
 // metadata resolving stuff
 MDResolveHandle::MDResolveHandle(const ScraperSearchResult& result, const ScraperSearchParams& search) : mResult(result)
 {
+	TRACE_SCOPE("Scraper::resolveMetaDataAssets");
+
 	mPercent = -1;
 
 	bool overWriteMedias = Settings::getInstance()->getBool("ScrapeOverWrite") && search.overWriteMedias;
@@ -663,6 +670,8 @@ bool resizeImage(const std::string& path, int maxWidth, int maxHeight)
 	if(maxWidth == 0 && maxHeight == 0)
 		return true;
 
+	TRACE_SCOPE_DETAIL("Scraper::resizeImage", path);
+
 	FREE_IMAGE_FORMAT format = FIF_UNKNOWN;
 	FIBITMAP* image = NULL;
 	
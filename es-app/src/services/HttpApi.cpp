@@ -15,84 +15,147 @@
 #include "utils/StringUtil.h"
 #include "utils/md5.h"
 #include "scrapers/Scraper.h"
+#include "LibrarySnapshot.h"
+#include "FrameTimings.h"
+#include "MemoryAccounting.h"
 #include <unordered_map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stack>
+#include <random>
+#include <chrono>
+
+// Number of games written in each chunk of a streamed games list
+#define GAMES_PER_CHUNK 200
+
+// Games of a system by id. Rebuilt when the system's files version changes.
+struct GameIdIndex
+{
+	GameIdIndex() : version(0) { }
+
+	unsigned int version;
+	std::unordered_map<std::string, FileData*> gamesById;
+};
+
+static std::map<SystemData*, GameIdIndex> sGameIdIndexes;
+static std::mutex sGameIdIndexesLock;
 
-void HttpApi::getSystemDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, SystemData* sys, bool localpaths)
+// sGameIdIndexesLock must be held
+static GameIdIndex& getGameIdIndex(SystemData* system, const std::function<std::string(FileData*)>& getId)
 {
-	writer.StartObject();
-	writer.Key("name"); writer.String(sys->getName().c_str());
-	writer.Key("fullname"); writer.String(sys->getFullName().c_str());
+	GameIdIndex& index = sGameIdIndexes[system];
+
+	unsigned int version = system->getFilesVersion();
+	if (index.version == version)
+		return index;
 
-	writer.Key("hardwareType"); writer.String(sys->getSystemMetadata().hardwareType.c_str());
-	writer.Key("manufacturer"); writer.String(sys->getSystemMetadata().manufacturer.c_str());
+	// Forget systems which have been deleted
+	for (auto it = sGameIdIndexes.begin(); it != sGameIdIndexes.end(); )
+	{
+		if (it->first != system && std::find(SystemData::sSystemVector.cbegin(), SystemData::sSystemVector.cend(), it->first) == SystemData::sSystemVector.cend())
+			it = sGameIdIndexes.erase(it);
+		else
+			++it;
+	}
+
+	index.version = version;
+	index.gamesById.clear();
+
+	std::stack<FolderData*> stack;
+	stack.push(system->getRootFolder());
 
-	if (sys->getSystemMetadata().releaseYear != 0)
+	while (stack.size())
 	{
-		writer.Key("releaseYear"); writer.Int(sys->getSystemMetadata().releaseYear);
+		FolderData* current = stack.top();
+		stack.pop();
+
+		for (auto it : current->getChildren())
+		{
+			if (it->getType() == FOLDER)
+				stack.push((FolderData*)it);
+			else if (it->getType() == GAME)
+			{
+				std::string id = getId(it);
+				if (index.gamesById.find(id) == index.gamesById.cend())
+					index.gamesById[id] = it;
+			}
+		}
 	}
 
-	writer.Key("theme"); writer.String(sys->getSystemMetadata().themeFolder.c_str());
+	return index;
+}
+
+void HttpApi::getSystemDataJson(JsonWriter& writer, const SystemSnapshot& sys, bool localpaths)
+{
+	writer.StartObject();
+	writer.Key("name"); writer.String(sys.name.c_str());
+	writer.Key("fullname"); writer.String(sys.fullName.c_str());
+
+	writer.Key("hardwareType"); writer.String(sys.hardwareType.c_str());
+	writer.Key("manufacturer"); writer.String(sys.manufacturer.c_str());
+
+	if (sys.releaseYear != 0)
+	{
+		writer.Key("releaseYear"); writer.Int(sys.releaseYear);
+	}
 
 	// writer.Key("startpath"); writer.String(sys->getStartPath().c_str());
-	writer.Key("theme"); writer.String(sys->getThemeFolder().c_str());
+	writer.Key("theme"); writer.String(sys.themeFolder.c_str());
 
-	auto exts = sys->getExtensions();
-	if (exts.size() > 0)
+	if (sys.extensions.size() > 0)
 	{
 		writer.Key("extensions");
 		writer.StartArray();
 
-		for (auto ext : exts)
+		for (auto& ext : sys.extensions)
 			writer.String(ext.c_str());
 
 		writer.EndArray();
 	}
 
-	writer.Key("visible"); writer.String(sys->isVisible() ? "true" : "false");
+	writer.Key("visible"); writer.String(sys.visible ? "true" : "false");
 
-	if (!sys->getSystemEnvData()->mGroup.empty())
+	if (!sys.group.empty())
 	{
-		writer.Key("group"); writer.String(sys->getSystemEnvData()->mGroup.c_str());
+		writer.Key("group"); writer.String(sys.group.c_str());
 	}
 
-	writer.Key("collection"); writer.String(sys->isCollection() ? "true" : "false");
-	writer.Key("gamesystem"); writer.String(sys->isGameSystem() ? "true" : "false");
-	writer.Key("groupsystem"); writer.String(sys->isGroupSystem() ? "true" : "false");
+	writer.Key("collection"); writer.String(sys.collection ? "true" : "false");
+	writer.Key("gamesystem"); writer.String(sys.gameSystem ? "true" : "false");
+	writer.Key("groupsystem"); writer.String(sys.groupSystem ? "true" : "false");
 
-	GameCountInfo* info = sys->getGameCountInfo();
+	const GameCountInfo& info = sys.gameCountInfo;
 
-	writer.Key("totalGames"); writer.Int(info->totalGames);
-	writer.Key("visibleGames"); writer.Int(info->visibleGames);
-	writer.Key("favoriteGames"); writer.Int(info->favoriteCount);
-	writer.Key("playedGames"); writer.Int(info->gamesPlayed);
-	writer.Key("hiddenGames"); writer.Int(info->hiddenCount);
-	writer.Key("mostPlayedGame"); writer.String(info->mostPlayed.c_str());
+	writer.Key("totalGames"); writer.Int(info.totalGames);
+	writer.Key("visibleGames"); writer.Int(info.visibleGames);
+	writer.Key("favoriteGames"); writer.Int(info.favoriteCount);
+	writer.Key("playedGames"); writer.Int(info.gamesPlayed);
+	writer.Key("hiddenGames"); writer.Int(info.hiddenCount);
+	writer.Key("mostPlayedGame"); writer.String(info.mostPlayed.c_str());
 
-	auto theme = sys->getTheme();
-	if (theme != nullptr)
+	if (!sys.logo.empty())
 	{
-		const ThemeData::ThemeElement* elem = theme->getElement("system", "logo", "image");
-		if (elem && elem->has("path")) {
-		  if(localpaths) {
-		    writer.Key("logo"); writer.String(elem->get<std::string>("path").c_str());
-		  } else {
-		    writer.Key("logo"); writer.String(("/systems/" + sys->getName() + "/logo").c_str());
-		  }
-		}
+		writer.Key("logo");
+
+		if (localpaths)
+			writer.String(sys.logo.c_str());
+		else
+			writer.String(("/systems/" + sys.name + "/logo").c_str());
 	}
 
 	writer.EndObject();
 }
 
-std::string HttpApi::getSystemList()
+std::string HttpApi::getSystemList(const std::shared_ptr<const LibrarySnapshot>& library)
 {
 	rapidjson::StringBuffer s;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+	JsonWriter writer(s);
 
 	writer.StartArray();
 
-	for (auto sys : SystemData::sSystemVector)
-		getSystemDataJson(writer, sys);
+	for (auto& sys : library->systems)
+		getSystemDataJson(writer, *sys);
 
 	writer.EndArray();
 
@@ -100,68 +163,110 @@ std::string HttpApi::getSystemList()
 }
 
 std::string HttpApi::getFileDataId(FileData* game)
+{
+	return game->getGameId();
+}
+
+std::string HttpApi::getGameId(const std::string& path)
 {
 	MD5 md5;
-	md5.update(game->getPath().c_str(), game->getPath().size());
+	md5.update(path.c_str(), path.size());
 	md5.finalize();
 	return md5.hexdigest();
 }
 
 FileData* HttpApi::findFileData(SystemData* system, const std::string& id)
 {
-	std::stack<FolderData*> stack;
-	stack.push(system->getRootFolder());
+	system->ensurePopulated();
 
-	while (stack.size())
-	{
-		FolderData* current = stack.top();
-		stack.pop();
+	std::unique_lock<std::mutex> lock(sGameIdIndexesLock);
 
-		for (auto it : current->getChildren())
-		{			
-			if (it->getType() == FOLDER)
-				stack.push((FolderData*)it);
-			else if (getFileDataId(it) == id)
-				return it;
-		}
-	}
+	auto& index = getGameIdIndex(system, getFileDataId);
+
+	auto it = index.gamesById.find(id);
+	if (it != index.gamesById.cend())
+		return it->second;
 
 	return nullptr;
 }
 
-void HttpApi::getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths)
+// Data versions restart at 0 on each launch : the boot nonce keeps an ETag from a previous run from matching
+static const std::string& getBootNonce()
+{
+	static const std::string nonce = []()
+	{
+		std::random_device rd;
+		unsigned long long value = ((unsigned long long) rd() << 32) ^ rd() ^ (unsigned long long) std::chrono::system_clock::now().time_since_epoch().count();
+
+		char buf[17];
+		snprintf(buf, sizeof(buf), "%016llx", value);
+		return std::string(buf);
+	}();
+
+	return nonce;
+}
+
+std::string HttpApi::getETag(const SystemSnapshot& system)
+{
+	std::string etag = "W/\"" + getBootNonce() + "-" + std::to_string(system.version);
+
+	if (system.sourcesVersion != 0)
+		etag += "-" + std::to_string(system.sourcesVersion);
+
+	return etag + "\"";
+}
+
+// Metadata declarations indexed by id
+static const MetaDataDecl* getMetaDataDecl(MetaDataId id)
 {
-	if (game->getType() != GAME)
-		return;
+	static const std::vector<const MetaDataDecl*> decls = []()
+	{
+		std::vector<const MetaDataDecl*> ret;
+
+		for (auto& mdd : MetaDataList::getMDD())
+		{
+			if ((size_t)mdd.id >= ret.size())
+				ret.resize((size_t)mdd.id + 1, nullptr);
+
+			ret[(size_t)mdd.id] = &mdd;
+		}
+
+		return ret;
+	}();
 
-	std::string id = getFileDataId(game);
+	return (size_t)id < decls.size() ? decls[(size_t)id] : nullptr;
+}
+
+void HttpApi::getFileDataJson(JsonWriter& writer, const GameSnapshot& game, bool localpaths, const std::set<std::string>* fields)
+{
+	auto hasField = [fields](const std::string& name)
+	{
+		return fields == nullptr || fields->empty() || fields->find(name) != fields->cend();
+	};
 
 	writer.StartObject();
-	writer.Key("id"); writer.String(id.c_str());
-	writer.Key("path"); writer.String(game->getPath().c_str());
-	writer.Key("name"); writer.String(game->getName().c_str());
 
-	writer.Key("systemName"); writer.String(game->getSystemName().c_str());
+	if (hasField("id")) { writer.Key("id"); writer.String(game.id.c_str()); }
+	if (hasField("path")) { writer.Key("path"); writer.String(game.path.c_str()); }
+	if (hasField("name")) { writer.Key("name"); writer.String(game.name.c_str()); }
+	if (hasField("systemName")) { writer.Key("systemName"); writer.String(game.systemName.c_str()); }
 
-	auto meta = game->getMetadata();
-	for (auto mdd : MetaDataList::getMDD())
+	for (auto& value : game.metadata)
 	{
-		if (mdd.id == MetaDataId::Name)
+		auto mdd = getMetaDataDecl(value.first);
+		if (mdd == nullptr)
 			continue;
 
-		std::string value = game->getMetadata(mdd.id);
-		if (!value.empty())
-		{
-			if (meta.getType(mdd.id) == MD_PATH && localpaths == false)
-				value = "/systems/" + game->getSourceFileData()->getSystemName() + "/games/" + id + "/media/" + mdd.key;
+		const std::string& key = mdd->id == MetaDataId::ScraperId ? "scraperId" : mdd->key;
+		if (!hasField(key))
+			continue;
 
-			if (mdd.id == MetaDataId::ScraperId)
-				writer.Key("scraperId");
-			else 
-				writer.Key(mdd.key.c_str());
+		writer.Key(key.c_str());
 
-			writer.String(value.c_str());
-		}
+		if (mdd->type == MD_PATH && localpaths == false)
+			writer.String(("/systems/" + game.sourceSystemName + "/games/" + game.id + "/media/" + mdd->key).c_str());
+		else
+			writer.String(value.second.c_str());
 	}
 
 	writer.EndObject();
@@ -264,53 +369,210 @@ bool HttpApi::ImportMedia(FileData* file, const std::string& mediaType, const st
 	return false;
 }
 
-std::string HttpApi::ToJson(FileData* file, bool localpaths)
+std::string HttpApi::getFrameTimings()
 {
+	auto stats = FrameTimings::getStats();
+
 	rapidjson::StringBuffer s;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
-	getFileDataJson(writer, file, localpaths);
+	JsonWriter writer(s);
+
+	// Durations are in microseconds
+	writer.StartObject();
+	writer.Key("stallThreshold"); writer.Int64(stats.threshold);
+	writer.Key("stallCount"); writer.Uint64(stats.stallCount);
+
+	writer.Key("phases");
+	writer.StartObject();
+
+	for (int i = 0; i < FrameTimings::PHASE_COUNT; i++)
+	{
+		auto& phase = stats.phases[i];
+
+		writer.Key(FrameTimings::getPhaseName((FrameTimings::Phase)i));
+		writer.StartObject();
+		writer.Key("count"); writer.Uint64(phase.count);
+		writer.Key("mean"); writer.Int64(phase.mean);
+		writer.Key("p50"); writer.Int64(phase.p50);
+		writer.Key("p95"); writer.Int64(phase.p95);
+		writer.Key("p99"); writer.Int64(phase.p99);
+		writer.Key("max"); writer.Int64(phase.max);
+		writer.EndObject();
+	}
+
+	writer.EndObject();
+
+	writer.Key("stalls");
+	writer.StartArray();
+
+	for (auto& stall : stats.stalls)
+	{
+		writer.StartObject();
+		writer.Key("time"); writer.Int64(stall.time);
+
+		for (int i = 0; i < FrameTimings::PHASE_COUNT; i++)
+		{
+			writer.Key(FrameTimings::getPhaseName((FrameTimings::Phase)i));
+			writer.Int64(stall.durations[i]);
+		}
+
+		writer.Key("scopes");
+		writer.StartArray();
+		for (auto& scope : stall.scopes)
+			writer.String(scope.c_str());
+		writer.EndArray();
+
+		writer.EndObject();
+	}
+
+	writer.EndArray();
+	writer.EndObject();
+
 	return s.GetString();
 }
 
-std::string HttpApi::ToJson(SystemData* system, bool localpaths)
+std::string HttpApi::getMemory()
 {
+	auto stats = MemoryAccounting::getStats();
+
 	rapidjson::StringBuffer s;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
-	getSystemDataJson(writer, system, localpaths);
+	JsonWriter writer(s);
+
+	// Sizes are in bytes, except peakRss which is in KB
+	writer.StartObject();
+
+	writer.Key("categories");
+	writer.StartObject();
+
+	for (int i = 0; i < MemoryAccounting::CATEGORY_COUNT; i++)
+	{
+		writer.Key(MemoryAccounting::getCategoryName((MemoryAccounting::Category)i));
+		writer.StartObject();
+		writer.Key("current"); writer.Int64(stats.categories[i].current);
+		writer.Key("peak"); writer.Int64(stats.categories[i].peak);
+		writer.EndObject();
+	}
+
+	writer.EndObject();
+
+	writer.Key("total");
+	writer.StartObject();
+	writer.Key("current"); writer.Int64(stats.total.current);
+	writer.Key("peak"); writer.Int64(stats.total.peak);
+	writer.EndObject();
+
+	writer.Key("heapInUse"); writer.Int64(stats.heapInUse);
+	writer.Key("peakRss"); writer.Int64(stats.peakRss);
+	writer.Key("maxVRAM"); writer.Int64(stats.maxVRAM);
+
+	writer.EndObject();
+
 	return s.GetString();
 }
 
-std::string HttpApi::getSystemGames(SystemData* system)
+std::string HttpApi::getEvent(const std::string& eventName, const std::vector<std::string>& args)
 {
 	rapidjson::StringBuffer s;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+	JsonWriter writer(s);
 
+	writer.StartObject();
+	writer.Key("event"); writer.String(eventName.c_str());
+
+	writer.Key("args");
 	writer.StartArray();
+	for (auto& arg : args)
+		writer.String(arg.c_str());
+	writer.EndArray();
 
-	std::vector<FileData*> files;
+	writer.EndObject();
 
-	std::stack<FolderData*> stack;
-	stack.push(system->getRootFolder());
+	return s.GetString();
+}
 
-	while (stack.size())
+std::string HttpApi::ToJson(const GameSnapshot& game, bool localpaths)
+{
+	rapidjson::StringBuffer s;
+	JsonWriter writer(s);
+	getFileDataJson(writer, game, localpaths);
+	return s.GetString();
+}
+
+std::string HttpApi::ToJson(FileData* file, bool localpaths)
+{
+	if (file->getType() != GAME)
+		return "";
+
+	return ToJson(GameSnapshot(file), localpaths);
+}
+
+std::string HttpApi::ToJson(const SystemSnapshot& system, bool localpaths)
+{
+	rapidjson::StringBuffer s;
+	JsonWriter writer(s);
+	getSystemDataJson(writer, system, localpaths);
+	return s.GetString();
+}
+
+JsonStream HttpApi::getSystemGames(const std::shared_ptr<const SystemSnapshot>& system, size_t offset, size_t limit, const std::set<std::string>& fields, bool localpaths)
+{
+	struct GamesStream
 	{
-		FolderData* current = stack.top();
-		stack.pop();
+		std::shared_ptr<const SystemSnapshot> system;
+		size_t position;
+		size_t end;
+		size_t written;
+		bool started;
+		bool ended;
+		std::set<std::string> fields;
+		bool localpaths;
+	};
+
+	auto stream = std::make_shared<GamesStream>();
+	stream->system = system;
+	stream->position = std::min(offset, system->games.size());
+	stream->end = (limit > 0 && limit < system->games.size() - stream->position) ? stream->position + limit : system->games.size();
+	stream->written = 0;
+	stream->started = false;
+	stream->ended = false;
+	stream->fields = fields;
+	stream->localpaths = localpaths;
+
+	// The snapshot is immutable : the stream always ends with a complete array, even if the library changes
+	// while it is written. The response carries the ETag of this snapshot, never the one of a newer version.
+	return [stream](std::string& chunk)
+	{
+		chunk.clear();
 
-		for (auto it : current->getChildren())
+		if (stream->ended)
+			return true;
+
+		rapidjson::StringBuffer s;
+
+		if (!stream->started)
 		{
-			files.push_back(it);
-			if (it->getType() == FOLDER)
-				stack.push((FolderData*)it);
+			chunk = "[";
+			stream->started = true;
 		}
-	}
 
-	for (auto game : files)
-		getFileDataJson(writer, game);
+		size_t end = std::min(stream->position + GAMES_PER_CHUNK, stream->end);
+		for (; stream->position < end; stream->position++)
+		{
+			if (stream->written++ > 0)
+				chunk += ",";
 
-	writer.EndArray();
+			s.Clear();
+			JsonWriter writer(s);
+			getFileDataJson(writer, *stream->system->games[stream->position], stream->localpaths, &stream->fields);
+			chunk += s.GetString();
+		}
 
-	return s.GetString();
+		if (stream->position >= stream->end)
+		{
+			chunk += "]";
+			stream->ended = true;
+		}
+
+		return true;
+	};
 }
 
 std::string HttpApi::getRunnningGameInfo()
@@ -325,7 +587,7 @@ std::string HttpApi::getRunnningGameInfo()
 std::string HttpApi::getCaps()
 {
 	rapidjson::StringBuffer s;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(s);
+	JsonWriter writer(s);
 
 	writer.StartObject();
 
@@ -1,27 +1,50 @@
 #pragma once
 
 #include <string>
+#include <set>
+#include <vector>
+#include <functional>
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/pointer.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/stringbuffer.h>
 
+typedef rapidjson::Writer<rapidjson::StringBuffer> JsonWriter;
+
+// Produces the next part of a streamed response. Returns false on failure, an empty chunk means the end of the stream.
+typedef std::function<bool(std::string& chunk)> JsonStream;
+
+#include <memory>
+
 class SystemData;
 class FileData;
+class LibrarySnapshot;
+struct SystemSnapshot;
+struct GameSnapshot;
 
+// Read functions work on a LibrarySnapshot and can be called from any thread. Functions using FileData must run on the UI thread.
 class HttpApi
 {
 public:
 	static std::string getCaps();
-	static std::string getSystemList();
-	static std::string getSystemGames(SystemData* system);
+	static std::string getSystemList(const std::shared_ptr<const LibrarySnapshot>& library);
+	static JsonStream getSystemGames(const std::shared_ptr<const SystemSnapshot>& system, size_t offset = 0, size_t limit = 0, const std::set<std::string>& fields = std::set<std::string>(), bool localpaths = false);
+
+	// Weak ETag, changes whenever a game of the system is added, removed or modified, and on each launch
+	static std::string getETag(const SystemSnapshot& system);
 
 	static std::string getRunnningGameInfo();
+	static std::string getFrameTimings();
+	static std::string getMemory();
+	static std::string getEvent(const std::string& eventName, const std::vector<std::string>& args);
 
-	static std::string ToJson(SystemData* system, bool localpaths = false);
+	static std::string ToJson(const SystemSnapshot& system, bool localpaths = false);
+	static std::string ToJson(const GameSnapshot& game, bool localpaths = false);
 	static std::string ToJson(FileData* file, bool localpaths = false);
 
-	static FileData*   findFileData(SystemData* system, const std::string& id);
+	static std::string getFileDataId(FileData* game);
+	static std::string getGameId(const std::string& path);
+	static FileData*   findFileData(SystemData* system, const std::string& id); // UI thread, loads the system if it's still pending
 
 	static bool ImportFromJson(FileData* file, const std::string& json);
 
@@ -29,7 +52,6 @@ public:
 	
 
 private:
-	static std::string getFileDataId(FileData* game);
-	static void getFileDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, FileData* game, bool localpaths = false);
-	static void getSystemDataJson(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, SystemData* sys, bool localpaths = false);
+	static void getFileDataJson(JsonWriter& writer, const GameSnapshot& game, bool localpaths = false, const std::set<std::string>* fields = nullptr);
+	static void getSystemDataJson(JsonWriter& writer, const SystemSnapshot& sys, bool localpaths = false);
 };
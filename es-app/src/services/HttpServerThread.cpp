@@ -1,6 +1,10 @@
 #include "HttpServerThread.h"
 #include "httplib.h"
 #include "Log.h"
+#include "Trace.h"
+#include "FrameTimings.h"
+#include "MemoryAccounting.h"
+#include "Scripting.h"
 
 #ifdef WIN32
 #include <Windows.h>
@@ -12,11 +16,20 @@
 #include "FileData.h"
 #include "views/ViewController.h"
 #include <unordered_map>
+#include <memory>
+#include <future>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
 #include "CollectionSystemManager.h"
 #include "guis/GuiMenu.h"
 #include "guis/GuiMsgBox.h"
 #include "utils/FileSystemUtil.h"
 #include "HttpApi.h"
+#include "LibrarySnapshot.h"
 #include "Settings.h"
 #include "ApiSystem.h"
 
@@ -39,12 +52,21 @@ POST /notify													-> body must contain the message text as text/plain
 POST /launch													-> body must contain the exact file path as text/plain
 GET  /runningGame
 GET  /isIdle
+GET  /trace														-> Chrome trace events recorded since tracing was started
+GET  /trace/start
+GET  /trace/stop
+GET  /frametimes												-> Frame time percentiles per phase (us), and the latest stalls
+GET  /frametimes/reset
+GET  /memory													-> Current and peak bytes per category (textures, fonts, library, themes...), heap and peak RSS
+GET  /memory/reset												-> Resets the peaks
+GET  /events													-> Server-sent events stream of the script events ("game-selected", "game-start"...), data is { event, args }
 
 System/Games APIS
 -----------------
 GET  /systems
 GET  /systems/{systemName}
 GET  /systems/{systemName}/logo
+GET  /systems/{systemName}/games?offset=&limit=&fields=		-> fields is a comma separated list of the game properties to return
 GET  /systems/{systemName}/games/{gameId}		
 POST /systems/{systemName}/games/{gameId}						-> body must contain the game metadata to save as application/json
 GET  /systems/{systemName}/games/{gameId}/media/{mediaType}
@@ -137,6 +159,252 @@ static bool isAllowed(const httplib::Request& req, httplib::Response& res)
 	return true;
 }
 
+// Size of the buffer used to send files
+#define FILE_CHUNK_SIZE 65536
+
+// Each GET /events client holds an http worker thread
+#define MAX_EVENT_STREAMS		4
+#define EVENT_STREAM_KEEPALIVE	15000 // ms without event before a comment is sent, so that closed connections are detected
+#define EVENT_STREAM_MAX_QUEUE	256 // Events kept for a client which doesn't read them, the oldest are dropped
+
+// Script events received through Scripting::subscribe, waiting to be sent to a GET /events client
+struct EventStream
+{
+	EventStream() : subscription(0), released(false) { lastWrite = std::chrono::steady_clock::now(); }
+
+	std::mutex lock;
+	std::condition_variable changed;
+	std::deque<std::string> events;
+	std::chrono::steady_clock::time_point lastWrite;
+
+	int subscription;
+	std::atomic<bool> released;
+};
+
+static std::atomic<int> sEventStreams(0);
+
+struct ServedFile
+{
+	ServedFile() : file(nullptr), position(0) { }
+	~ServedFile() { if (file != nullptr) fclose(file); }
+
+	FILE* file;
+	unsigned long long position;
+	char buffer[FILE_CHUNK_SIZE];
+};
+
+static std::string getHttpDate(time_t time)
+{
+	char buffer[64];
+
+	struct tm gmt;
+#if WIN32
+	gmtime_s(&gmt, &time);
+#else
+	gmtime_r(&time, &gmt);
+#endif
+
+	strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+	return buffer;
+}
+
+// Streams a file from disk, without loading it in memory. Range requests are handled by httplib from the content provider.
+// Returns false if the file doesn't exist.
+static bool serveFile(const httplib::Request& req, httplib::Response& res, const std::string& path, const std::string& mimeType)
+{
+	std::string filePath = ResourceManager::getInstance()->getResourcePath(path);
+
+	unsigned long long size = Utils::FileSystem::getFileSize(filePath);
+	if (size == 0)
+		return false;
+
+	auto servedFile = std::make_shared<ServedFile>();
+
+#if WIN32
+	servedFile->file = _wfopen(WINSTRINGW(filePath).c_str(), L"rb");
+#else
+	servedFile->file = fopen(filePath.c_str(), "rb");
+#endif
+	if (servedFile->file == nullptr)
+		return false;
+
+	time_t modified = Utils::FileSystem::getFileModificationDate(filePath).getTime();
+
+	char etag[64];
+	snprintf(etag, sizeof(etag), "\"%llx-%llx\"", size, (unsigned long long) modified);
+
+	std::string lastModified = getHttpDate(modified);
+
+	res.set_header("ETag", etag);
+	res.set_header("Last-Modified", lastModified);
+	res.set_header("Accept-Ranges", "bytes");
+
+	if (req.has_header("If-None-Match") ? req.get_header_value("If-None-Match") == etag : req.get_header_value("If-Modified-Since") == lastModified)
+	{
+		res.status = 304;
+		return true;
+	}
+
+	// httplib applies the ranges after the handler without clamping them to the content length : clamp them here (RFC 7233 2.1).
+	// The request object itself isn't const, only the reference the handlers get.
+	if (!req.ranges.empty())
+	{
+		httplib::Ranges& ranges = const_cast<httplib::Request&>(req).ranges;
+		httplib::Ranges satisfiable;
+
+		for (auto range : ranges)
+		{
+			if (range.first < 0 && range.second < 0)
+				satisfiable.push_back(range);
+			else if (range.first < 0)
+			{
+				// Suffix : the last bytes, the whole file if it's shorter
+				if (range.second > 0)
+					satisfiable.push_back(httplib::Range(-1, (ssize_t) std::min((unsigned long long) range.second, size)));
+			}
+			else if (range.second >= 0 && range.second < range.first)
+			{
+				// Syntactically invalid : the Range header is ignored
+				satisfiable.clear();
+				ranges.clear();
+				break;
+			}
+			else if ((unsigned long long) range.first < size)
+			{
+				if (range.second < 0 || (unsigned long long) range.second >= size)
+					range.second = (ssize_t) (size - 1);
+
+				satisfiable.push_back(range);
+			}
+		}
+
+		// Only a request whose ranges all start after the end of the file is unsatisfiable
+		if (satisfiable.empty() && !ranges.empty())
+		{
+			ranges.clear();
+			res.set_header("Content-Range", "bytes */" + std::to_string(size));
+			res.set_content("416 range not satisfiable", "text/html");
+			res.status = 416;
+			return true;
+		}
+
+		ranges = satisfiable;
+	}
+
+	res.set_header("Content-Type", mimeType);
+	res.set_content_provider((size_t) size, [servedFile](size_t offset, size_t length, httplib::DataSink& sink)
+	{
+		if (servedFile->position != offset)
+		{
+#if WIN32
+			if (_fseeki64(servedFile->file, offset, SEEK_SET) != 0)
+#else
+			if (fseeko(servedFile->file, offset, SEEK_SET) != 0)
+#endif
+				return false;
+
+			servedFile->position = offset;
+		}
+
+		size_t read = fread(servedFile->buffer, 1, std::min(length, (size_t) FILE_CHUNK_SIZE), servedFile->file);
+		if (read == 0)
+			return false;
+
+		servedFile->position += read;
+		sink.write(servedFile->buffer, read);
+		return true;
+	});
+
+	return true;
+}
+
+// Maximum time (ms) an api call waits for the UI thread to apply a change. The UI thread doesn't run while a game is running.
+#define UI_THREAD_TIMEOUT 10000
+#define MEMORY_UPDATE_TIMEOUT 100
+
+#define UI_TASK_PENDING		0
+#define UI_TASK_STARTED		1
+#define UI_TASK_CANCELLED	2
+
+// Runs a function on the UI thread, and waits for it : FileData and SystemData objects must only be used from there.
+// Returns false if the UI thread didn't start it in time, in which case it's cancelled and never runs.
+bool HttpServerThread::runOnUiThread(const std::function<void()>& func, int timeoutMs)
+{
+	auto done = std::make_shared<std::promise<void>>();
+	auto future = done->get_future();
+	auto state = std::make_shared<std::atomic<int>>(UI_TASK_PENDING);
+
+	mWindow->postToUiThread([func, done, state]()
+	{
+		int expected = UI_TASK_PENDING;
+		if (!state->compare_exchange_strong(expected, UI_TASK_STARTED))
+			return;
+
+		func();
+		done->set_value();
+	});
+
+	if (future.wait_for(std::chrono::milliseconds(timeoutMs < 0 ? UI_THREAD_TIMEOUT : timeoutMs)) == std::future_status::ready)
+		return true;
+
+	int expected = UI_TASK_PENDING;
+	if (state->compare_exchange_strong(expected, UI_TASK_CANCELLED))
+		return false;
+
+	// Already running : its result is reported
+	future.wait();
+	return true;
+}
+
+// Systems loaded in background have no games yet : the UI thread loads the requested one before it's served
+std::shared_ptr<const SystemSnapshot> HttpServerThread::getPopulatedSystem(const std::string& name)
+{
+	auto system = LibrarySnapshot::get()->getSystem(name);
+	if (system == nullptr || system->populated)
+		return system;
+
+	runOnUiThread([name]()
+	{
+		SystemData* system = SystemData::getSystem(name);
+		if (system == nullptr)
+			return;
+
+		system->ensurePopulated();
+		LibrarySnapshot::publish(true);
+	});
+
+	// The games are copied by the snapshot worker
+	LibrarySnapshot::waitForBuilds(UI_THREAD_TIMEOUT);
+	return LibrarySnapshot::get()->getSystem(name);
+}
+
+// Answers 503 if the games of the system are still loading
+static bool isLoading(httplib::Response& res, const SystemSnapshot& system)
+{
+	if (system.populated)
+		return false;
+
+	res.set_header("Retry-After", "5");
+	res.set_content("503 system is loading", "text/html");
+	res.status = 503;
+	return true;
+}
+
+// Sets the ETag of the system and answers 304 if the client copy is still valid
+static bool isNotModified(const httplib::Request& req, httplib::Response& res, const SystemSnapshot& system)
+{
+	std::string etag = HttpApi::getETag(system);
+	res.set_header("ETag", etag);
+
+	if (req.has_header("If-None-Match") && req.get_header_value("If-None-Match") == etag)
+	{
+		res.status = 304;
+		return true;
+	}
+
+	return false;
+}
+
 void HttpServerThread::run()
 {
 	mHttpServer = new httplib::Server();
@@ -265,7 +533,7 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
-		res.set_content(HttpApi::getSystemList(), "application/json");
+		res.set_content(HttpApi::getSystemList(LibrarySnapshot::get()), "application/json");
 	});
 
 	mHttpServer->Get("/runningGame", [](const httplib::Request& req, httplib::Response& res)
@@ -307,46 +575,189 @@ void HttpServerThread::run()
 		}
 	});	
 
-	mHttpServer->Get(R"(/systems/(/?.*)/logo)", [](const httplib::Request& req, httplib::Response& res)
-	{		
+	mHttpServer->Get("/trace", [](const httplib::Request& req, httplib::Response& res)
+	{
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
-		if (system != nullptr)
+		res.set_content(Trace::exportChromeTrace(), "application/json");
+	});
+
+	mHttpServer->Get("/trace/start", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		Trace::setEnabled(true);
+	});
+
+	mHttpServer->Get("/trace/stop", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		Trace::setEnabled(false);
+	});
+
+	mHttpServer->Get("/frametimes", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		res.set_content(HttpApi::getFrameTimings(), "application/json");
+	});
+
+	mHttpServer->Get("/frametimes/reset", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		FrameTimings::reset();
+	});
+
+	mHttpServer->Get("/memory", [this](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		// The UI thread measures again if it's free right away. Otherwise, e.g. while a game runs, the last sample is served
+		runOnUiThread([]() { MemoryAccounting::update(true); }, MEMORY_UPDATE_TIMEOUT);
+
+		res.set_content(HttpApi::getMemory(), "application/json");
+	});
+
+	mHttpServer->Get("/memory/reset", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		MemoryAccounting::resetPeaks();
+	});
+
+	mHttpServer->Get("/events", [](const httplib::Request& req, httplib::Response& res)
+	{
+		if (!isAllowed(req, res))
+			return;
+
+		if (++sEventStreams > MAX_EVENT_STREAMS)
 		{
-			auto theme = system->getTheme();
-			if (theme != nullptr)
+			sEventStreams--;
+
+			res.set_header("Retry-After", "5");
+			res.set_content("503 too many event streams", "text/html");
+			res.status = 503;
+			return;
+		}
+
+		auto stream = std::make_shared<EventStream>();
+		std::weak_ptr<EventStream> weakStream = stream;
+
+		// Called from the scripting thread : only formats and queues the event
+		stream->subscription = Scripting::subscribe([weakStream](const std::string& eventName, const std::vector<std::string>& args)
+		{
+			auto stream = weakStream.lock();
+			if (stream == nullptr)
+				return;
+
+			std::string event = "event: " + eventName + "\ndata: " + HttpApi::getEvent(eventName, args) + "\n\n";
+
+			std::unique_lock<std::mutex> lock(stream->lock);
+			if (stream->events.size() >= EVENT_STREAM_MAX_QUEUE)
+				stream->events.pop_front();
+
+			stream->events.push_back(event);
+			stream->changed.notify_one();
+		});
+
+		res.set_header("Content-Type", "text/event-stream");
+		res.set_header("Cache-Control", "no-cache");
+		res.set_chunked_content_provider([stream](size_t /*offset*/, httplib::DataSink& sink)
+		{
+			std::deque<std::string> events;
+
 			{
-				const ThemeData::ThemeElement* elem = theme->getElement("system", "logo", "image");
-				if (elem && elem->has("path"))
-				{
-					std::string logo = elem->get<std::string>("path");
-					auto data = ResourceManager::getInstance()->getFileData(logo);
-					if (data.ptr)
-					{
-						res.set_content((char*)data.ptr.get(), data.length, getMimeType(logo).c_str());
-						return;
-					}
-				}
+				// Returns every second so that the server can stop
+				std::unique_lock<std::mutex> lock(stream->lock);
+				stream->changed.wait_for(lock, std::chrono::seconds(1), [stream] { return !stream->events.empty(); });
+				events.swap(stream->events);
 			}
+
+			auto now = std::chrono::steady_clock::now();
+
+			if (events.empty() && std::chrono::duration_cast<std::chrono::milliseconds>(now - stream->lastWrite).count() >= EVENT_STREAM_KEEPALIVE)
+				events.push_back(": keepalive\n\n");
+
+			for (auto& event : events)
+				sink.write(event.data(), event.size());
+
+			if (!events.empty())
+				stream->lastWrite = now;
+
+			return sink.is_writable();
+		},
+		[stream]()
+		{
+			if (stream->released.exchange(true))
+				return;
+
+			Scripting::unsubscribe(stream->subscription);
+			sEventStreams--;
+		});
+	});
+
+	mHttpServer->Get(R"(/systems/(/?.*)/logo)", [](const httplib::Request& req, httplib::Response& res)
+	{		
+		if (!isAllowed(req, res))
+			return;
+
+		auto system = LibrarySnapshot::get()->getSystem(req.matches[1]);
+		if (system != nullptr && !system->logo.empty())
+		{
+			if (serveFile(req, res, system->logo, getMimeType(system->logo)))
+				return;
 		}
 
 		res.set_content("404 not found", "text/html");
 		res.status = 404;
 	});
 	
-	mHttpServer->Get(R"(/systems/(/?.*)/games)", [](const httplib::Request& req, httplib::Response& res)
+	mHttpServer->Get(R"(/systems/(/?.*)/games)", [this](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
+		auto system = getPopulatedSystem(req.matches[1]);
 		if (system != nullptr)
 		{
-			res.set_content(HttpApi::getSystemGames(system), "application/json");
+			if (isLoading(res, *system) || isNotModified(req, res, *system))
+				return;
+
+			size_t offset = req.has_param("offset") ? (size_t) Utils::String::toInteger(req.get_param_value("offset")) : 0;
+			size_t limit = req.has_param("limit") ? (size_t) Utils::String::toInteger(req.get_param_value("limit")) : 0;
+			bool localpaths = req.has_param("localpaths") && req.get_param_value("localpaths") == "true";
+
+			std::set<std::string> fields;
+			if (req.has_param("fields"))
+				for (auto field : Utils::String::split(req.get_param_value("fields"), ','))
+					fields.insert(Utils::String::trim(field));
+
+			auto stream = HttpApi::getSystemGames(system, offset, limit, fields, localpaths);
+
+			res.set_header("Content-Type", "application/json");
+			res.set_chunked_content_provider([stream](size_t /*offset*/, httplib::DataSink& sink)
+			{
+				std::string chunk;
+				if (!stream(chunk))
+					return false;
+
+				if (chunk.empty())
+					sink.done();
+				else
+					sink.write(chunk.data(), chunk.size());
+
+				return true;
+			});
+
 			return;
 		}
 		
@@ -354,35 +765,32 @@ void HttpServerThread::run()
 		res.status = 404;		
 	});
 
-	mHttpServer->Get(R"(/systems/(/?.*)/games/(/?.*)/media/(/?.*))", [](const httplib::Request& req, httplib::Response& res)
+	mHttpServer->Get(R"(/systems/(/?.*)/games/(/?.*)/media/(/?.*))", [this](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
+		auto system = getPopulatedSystem(req.matches[1]);
 		if (system != nullptr)
 		{
-			std::string gameId = req.matches[2];
-			auto game = HttpApi::findFileData(system, gameId);
+			if (isLoading(res, *system))
+				return;
+
+			auto game = system->findGame(req.matches[2]);
 			if (game != nullptr)
 			{
 				std::string metadataName = req.matches[3];
 
-				if (game->getMetadata().getType(metadataName) == MD_PATH)
+				for (auto& mdd : MetaDataList::getMDD())
 				{
-					std::string path = game->getMetadata().get(metadataName);
-					if (!path.empty())
-					{
-						auto data = ResourceManager::getInstance()->getFileData(path);
-						if (data.ptr)
-						{
-							res.set_content((char*)data.ptr.get(), data.length, getMimeType(path).c_str());
-							return;
-						}
+					if (mdd.key != metadataName || mdd.type != MD_PATH)
+						continue;
 
+					std::string path = game->get(mdd.id);
+					if (!path.empty() && serveFile(req, res, path, getMimeType(path)))
 						return;
-					}
+
+					break;
 				}
 			}
 		}
@@ -411,30 +819,42 @@ void HttpServerThread::run()
 		}
 
 		std::string contentType = req.get_header_value("Content-Type");
-		
 		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
-		if (system != nullptr)
+		std::string gameId = req.matches[2];
+		std::string metadataName = req.matches[3];
+		std::string body = req.body;
+
+		auto imported = std::make_shared<bool>(false);
+
+		bool done = runOnUiThread([systemName, gameId, metadataName, contentType, body, imported]()
 		{
-			std::string gameId = req.matches[2];
+			SystemData* system = SystemData::getSystem(systemName);
+			if (system == nullptr)
+				return;
+
 			auto game = HttpApi::findFileData(system, gameId);
-			if (game != nullptr)
-			{
-				std::string metadataName = req.matches[3];
+			if (game == nullptr || game->getMetadata().getType(metadataName) != MD_PATH)
+				return;
 
-				if (game->getMetadata().getType(metadataName) == MD_PATH)
-				{
-					if (HttpApi::ImportMedia(game, metadataName, contentType, req.body))
-					{
-						if (ViewController::hasInstance())
-							mWindow->postToUiThread([game]() { ViewController::get()->onFileChanged(game, FileChangeType::FILE_METADATA_CHANGED); });
+			if (HttpApi::ImportMedia(game, metadataName, contentType, body))
+			{
+				*imported = true;
 
-						return;
-					}
-				}
+				if (ViewController::hasInstance())
+					ViewController::get()->onFileChanged(game, FileChangeType::FILE_METADATA_CHANGED);
 			}
+		});
+
+		if (!done)
+		{
+			res.set_content("503 service unavailable", "text/html");
+			res.status = 503;
+			return;
 		}
 
+		if (*imported)
+			return;
+
 		res.set_content("404 media not found", "text/html");
 		res.status = 404;
 	});
@@ -453,43 +873,61 @@ void HttpServerThread::run()
 		}
 
 		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
-		if (system != nullptr)
+		std::string gameId = req.matches[2];
+		std::string body = req.body;
+
+		auto imported = std::make_shared<bool>(false);
+
+		bool done = runOnUiThread([systemName, gameId, body, imported]()
 		{
-			std::string gameId = req.matches[2];
+			SystemData* system = SystemData::getSystem(systemName);
+			if (system == nullptr)
+				return;
+
 			auto game = HttpApi::findFileData(system, gameId);
-			if (game != nullptr)
+			if (game != nullptr && HttpApi::ImportFromJson(game, body))
 			{
-				if (HttpApi::ImportFromJson(game, req.body))
-				{
-					if (ViewController::hasInstance())
-						mWindow->postToUiThread([game]() { ViewController::get()->onFileChanged(game, FileChangeType::FILE_METADATA_CHANGED); });					
+				*imported = true;
 
-					return;
-				}
+				if (ViewController::hasInstance())
+					ViewController::get()->onFileChanged(game, FileChangeType::FILE_METADATA_CHANGED);
 			}
+		});
+
+		if (!done)
+		{
+			res.set_content("503 service unavailable", "text/html");
+			res.status = 503;
+			return;
 		}
 
+		if (*imported)
+			return;
+
 		res.set_content("404 game not found", "text/html");
 		res.status = 404;
 	});
 
 
-	mHttpServer->Get(R"(/systems/(/?.*)/games/(/?.*))", [](const httplib::Request& req, httplib::Response& res)
+	mHttpServer->Get(R"(/systems/(/?.*)/games/(/?.*))", [this](const httplib::Request& req, httplib::Response& res)
 	{
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
+		auto system = getPopulatedSystem(req.matches[1]);
 		if (system != nullptr)
 		{
-			std::string gameId = req.matches[2];
-			auto game = HttpApi::findFileData(system, gameId);
+			if (isLoading(res, *system))
+				return;
+
+			auto game = system->findGame(req.matches[2]);
 			if (game != nullptr)
 			{
+				if (isNotModified(req, res, *system))
+					return;
+
 				bool localpaths = req.has_param("localpaths") && req.get_param_value("localpaths") == "true";
-				res.set_content(HttpApi::ToJson(game, localpaths), "application/json");
+				res.set_content(HttpApi::ToJson(*game, localpaths), "application/json");
 				return;
 			}
 		}
@@ -503,12 +941,14 @@ void HttpServerThread::run()
 		if (!isAllowed(req, res))
 			return;
 
-		std::string systemName = req.matches[1];
-		SystemData* system = SystemData::getSystem(systemName);
+		auto system = LibrarySnapshot::get()->getSystem(req.matches[1]);
 		if (system != nullptr)
 		{
+			if (isNotModified(req, res, *system))
+				return;
+
 			bool localpaths = req.has_param("localpaths") && req.get_param_value("localpaths") == "true";
-			res.set_content(HttpApi::ToJson(system, localpaths), "application/json");
+			res.set_content(HttpApi::ToJson(*system, localpaths), "application/json");
 			return;
 		}
 
@@ -574,21 +1014,57 @@ void HttpServerThread::run()
 		}
 
 		auto path = Utils::FileSystem::getAbsolutePath(req.body);
+		bool pendingSystems = false;
 
-		for (auto system : SystemData::sSystemVector)
+		for (auto& system : LibrarySnapshot::get()->systems)
 		{
-			if (system->isCollection() || !system->isGameSystem())
+			if (system->collection || !system->gameSystem)
 				continue;
 
-			for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
+			if (!system->populated)
+				pendingSystems = true;
+
+			for (auto& game : system->games)
 			{
-				if (file->getFullPath() == path || file->getPath() == path)
+				if (game->path == path)
 				{
-					mWindow->postToUiThread([file]() { ViewController::get()->launch(file); });					
+					std::string systemName = system->name;
+					std::string gameId = game->id;
+
+					mWindow->postToUiThread([systemName, gameId]() 
+					{ 
+						SystemData* system = SystemData::getSystem(systemName);
+						FileData* file = (system == nullptr ? nullptr : HttpApi::findFileData(system, gameId));
+						if (file != nullptr)
+							ViewController::get()->launch(file); 
+					});
+
 					return;
 				}
 			}
 		}
+
+		// The game may belong to a system which is still loading
+		if (pendingSystems)
+		{
+			mWindow->postToUiThread([path]()
+			{
+				SystemData::populatePendingSystems();
+
+				for (auto system : SystemData::sSystemVector)
+				{
+					if (system->isCollection() || !system->isGameSystem())
+						continue;
+
+					FileData* file = system->getRootFolder()->FindByPath(path);
+					if (file != nullptr && file->getType() == GAME)
+					{
+						ViewController::get()->launch(file);
+						return;
+					}
+				}
+			});
+		}
 	});
 
 	mHttpServer->Post(R"(/addgames/(/?.*))", [this](const httplib::Request& req, httplib::Response& res)
@@ -604,67 +1080,70 @@ void HttpServerThread::run()
 		}
 
 		std::string systemName = req.matches[1];
+		std::string body = req.body;
+		Window* w = mWindow;
 
-		bool deleteSystem = false;
+		auto result = std::make_shared<std::pair<int, std::string>>(200, "OK");
 
-		SystemData* system = SystemData::getSystem(systemName);		
-		if (system == nullptr)
+		bool done = runOnUiThread([systemName, body, w, result]()
 		{
-			system = SystemData::loadSystem(systemName, false);
+			bool deleteSystem = false;
+
+			SystemData* system = SystemData::getSystem(systemName);		
 			if (system == nullptr)
 			{
-				res.set_content("404 System not found", "text/html");
-				res.status = 404;
-				return;
-			}
+				system = SystemData::loadSystem(systemName, false);
+				if (system == nullptr)
+				{
+					*result = std::make_pair(404, "404 System not found");
+					return;
+				}
 
-			deleteSystem = true;
-		}
+				deleteSystem = true;
+			}
+			else
+				system->ensurePopulated();
 			
-		std::unordered_map<std::string, FileData*> fileMap;
-		for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
-			fileMap[file->getPath()] = file;
+			std::unordered_map<std::string, FileData*> fileMap;
+			for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
+				fileMap[file->getPath()] = file;
 
-		auto fileList = loadGamelistFile(req.body, system, fileMap, SIZE_MAX, false);
-		if (fileList.size() == 0)
-		{
-			res.set_content("204 No game added / updated", "text/html");
-			res.status = 204;
+			auto fileList = loadGamelistFile(body, system, fileMap, SIZE_MAX, false);
+			if (fileList.size() == 0)
+			{
+				*result = std::make_pair(204, "204 No game added / updated");
 
-			if (deleteSystem)
-				delete system;
+				if (deleteSystem)
+					delete system;
 
-			return;
-		}
+				return;
+			}
 	
-		for (auto file : fileList)
-			file->getMetadata().setDirty();
-
-		for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
-			if (fileMap.find(file->getPath()) != fileMap.cend())
+			for (auto file : fileList)
 				file->getMetadata().setDirty();
 
-		updateGamelist(system);
+			for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
+				if (fileMap.find(file->getPath()) != fileMap.cend())
+					file->getMetadata().setDirty();
 
-		if (deleteSystem)
-		{		
-			delete system;
+			updateGamelist(system);
 
-			res.set_content("201 Game added. System not updated", "text/html");
-			res.status = 201;
+			if (deleteSystem)
+			{		
+				delete system;
 
-			Window* w = mWindow;
-			mWindow->postToUiThread([w]() { GuiMenu::updateGameLists(w, false); });
-		}
-		else if (ViewController::hasInstance())
-		{
-			mWindow->postToUiThread([system]()
-			{
+				*result = std::make_pair(201, "201 Game added. System not updated");
+				GuiMenu::updateGameLists(w, false);
+			}
+			else if (ViewController::hasInstance())
 				ViewController::get()->onFileChanged(system->getRootFolder(), FILE_METADATA_CHANGED); // Update root folder			
-			});
-		}
+		});
 
-		res.set_content("OK", "text/html");
+		if (!done)
+			*result = std::make_pair(503, "503 service unavailable");
+
+		res.set_content(result->second, "text/html");
+		res.status = result->first;
 	});
 	
 	mHttpServer->Post(R"(/removegames/(/?.*))", [this](const httplib::Request& req, httplib::Response& res)
@@ -679,66 +1158,71 @@ void HttpServerThread::run()
 			return;
 		}
 
-		auto systemName = req.matches[1];
-
-		SystemData* system = SystemData::getSystem(systemName);
-		if (system == nullptr)
-		{
-			res.set_content("404 not found", "text/html");
-			res.status = 404;
-			return;
-		}
+		std::string systemName = req.matches[1];
+		std::string body = req.body;
 
-		std::unordered_map<std::string, FileData*> fileMap;
-		for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
-			fileMap[file->getPath()] = file;
+		auto result = std::make_shared<std::pair<int, std::string>>(200, "OK");
 
-		auto fileList = loadGamelistFile(req.body, system, fileMap, SIZE_MAX, false);
-		if (fileList.size() == 0)
+		bool done = runOnUiThread([systemName, body, result]()
 		{
-			res.set_content("204 No game removed", "text/html");
-			res.status = 204;
-			return;
-		}
+			SystemData* system = SystemData::getSystem(systemName);
+			if (system == nullptr)
+			{
+				*result = std::make_pair(404, "404 not found");
+				return;
+			}
 
-		std::vector<SystemData*> systems;
-		systems.push_back(system);
+			system->ensurePopulated();
 
-		for (auto file : fileList)
-		{
-			removeFromGamelistRecovery(file);
+			std::unordered_map<std::string, FileData*> fileMap;
+			for (auto file : system->getRootFolder()->getFilesRecursive(GAME))
+				fileMap[file->getPath()] = file;
+
+			auto fileList = loadGamelistFile(body, system, fileMap, SIZE_MAX, false);
+			if (fileList.size() == 0)
+			{
+				*result = std::make_pair(204, "204 No game removed");
+				return;
+			}
 
-			auto filePath = file->getPath();
-			if (Utils::FileSystem::exists(filePath))
-				Utils::FileSystem::removeFile(filePath);
+			std::vector<SystemData*> systems;
+			systems.push_back(system);
 
-			for (auto sys : SystemData::sSystemVector)
+			for (auto file : fileList)
 			{
-				if (!sys->isCollection())
-					continue;
+				removeFromGamelistRecovery(file);
 
-				auto copy = sys->getRootFolder()->FindByPath(filePath);
-				if (copy != nullptr)
+				auto filePath = file->getPath();
+				if (Utils::FileSystem::exists(filePath))
+					Utils::FileSystem::removeFile(filePath);
+
+				for (auto sys : SystemData::sSystemVector)
 				{
-					sys->getRootFolder()->removeFromVirtualFolders(file);
-					systems.push_back(sys);
+					if (!sys->isCollection())
+						continue;
+
+					auto copy = sys->getRootFolder()->FindByPath(filePath);
+					if (copy != nullptr)
+					{
+						sys->getRootFolder()->removeFromVirtualFolders(file);
+						systems.push_back(sys);
+					}
 				}
-			}
 
-			system->getRootFolder()->removeFromVirtualFolders(file);
-			// delete file; intentionnal mem leak
-		}
+				system->getRootFolder()->removeFromVirtualFolders(file);
+				// delete file; intentionnal mem leak
+			}
 
-		if (ViewController::hasInstance())
-		{
-			mWindow->postToUiThread([systems]()
-			{
+			if (ViewController::hasInstance())
 				for (auto changedSystem : systems)
 					ViewController::get()->onFileChanged(changedSystem->getRootFolder(), FILE_REMOVED); // Update root folder			
-			});
-		}
-		
-		res.set_content("OK", "text/html");
+		});
+
+		if (!done)
+			*result = std::make_pair(503, "503 service unavailable");
+
+		res.set_content(result->second, "text/html");
+		res.status = result->first;
 	});
 
 	mHttpServer->Get(R"(/resources/(/?.*))", [](const httplib::Request& req, httplib::Response& res)  // (.*)
@@ -747,10 +1231,7 @@ void HttpServerThread::run()
 			return;
 
 		std::string url = req.matches[1];
-		auto data = ResourceManager::getInstance()->getFileData(":/" + url);
-		if (data.ptr)
-			res.set_content((char*)data.ptr.get(), data.length, getMimeType(url).c_str());
-		else
+		if (!serveFile(req, res, ":/" + url, getMimeType(url)))
 		{
 			res.set_content("404 not found", "text/html");
 			res.status = 404;
@@ -765,10 +1246,7 @@ void HttpServerThread::run()
 
 		std::string url = req.matches[1];
 
-		auto data = ResourceManager::getInstance()->getFileData(":/services/" + url);
-		if (data.ptr)
-			res.set_content((char*)data.ptr.get(), data.length, getMimeType(url).c_str());
-		else 
+		if (!serveFile(req, res, ":/services/" + url, getMimeType(url)))
 		{
 			res.set_content("404 not found", "text/html");
 			res.status = 404;
@@ -783,7 +1261,7 @@ void HttpServerThread::run()
 		if (Settings::getInstance()->getBool("PublicWebAccess"))
 			ip = "0.0.0.0";
 
-		mHttpServer->listen(ip.c_str(), 1234);
+		mHttpServer->listen(ip.c_str(), Settings::getInstance()->getInt("HttpServerPort"));
 	}
 	catch (...)
 	{
@@ -2,6 +2,8 @@
 
 #include "Window.h"
 #include <thread>
+#include <functional>
+#include <memory>
 
 namespace httplib
 {
@@ -25,6 +27,9 @@ private:
 	httplib::Server* mHttpServer;
 
 	void run();
+	bool runOnUiThread(const std::function<void()>& func, int timeoutMs = -1); // -1 : UI_THREAD_TIMEOUT
+
+	std::shared_ptr<const struct SystemSnapshot> getPopulatedSystem(const std::string& name);
 };
 
 
@@ -0,0 +1,471 @@
+#include "LibrarySnapshot.h"
+#include "HttpApi.h"
+#include "FileData.h"
+#include "ThemeData.h"
+#include "Log.h"
+#include <chrono>
+#include <stack>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <algorithm>
+#include <tuple>
+
+// A changed library is published at most once in this delay (ms), so that scraping doesn't copy it on every frame
+#define SNAPSHOT_PUBLISH_DELAY 1000
+
+std::shared_ptr<const LibrarySnapshot> LibrarySnapshot::sSnapshot;
+
+static std::chrono::steady_clock::time_point sLastPublishTime;
+
+GameSnapshot::GameSnapshot(FileData* game)
+{
+	file = game;
+	metadataVersion = game->getMetadata().getVersion();
+
+	id = game->getGameId();
+	path = game->getPath();
+	name = game->getName();
+	systemName = game->getSystemName();
+	sourceSystemName = game->getSourceFileData()->getSystemName();
+
+	const MetaDataList& meta = game->getMetadata();
+	for (auto& mdd : MetaDataList::getMDD())
+	{
+		if (mdd.id == MetaDataId::Name)
+			continue;
+
+		std::string value = meta.get(mdd.id);
+		if (!value.empty())
+			metadata.push_back(std::pair<MetaDataId, std::string>(mdd.id, value));
+	}
+}
+
+std::string GameSnapshot::get(MetaDataId id) const
+{
+	for (auto& value : metadata)
+		if (value.first == id)
+			return value.second;
+
+	return "";
+}
+
+const GameSnapshot* SystemSnapshot::findGame(const std::string& id) const
+{
+	auto it = gamesById.find(id);
+	if (it == gamesById.cend())
+		return nullptr;
+
+	return games[it->second].get();
+}
+
+std::shared_ptr<const SystemSnapshot> LibrarySnapshot::getSystem(const std::string& name) const
+{
+	for (auto& system : systems)
+		if (system->name == name)
+			return system;
+
+	return nullptr;
+}
+
+std::shared_ptr<const LibrarySnapshot> LibrarySnapshot::get()
+{
+	auto snapshot = std::atomic_load(&sSnapshot);
+	if (snapshot == nullptr)
+		return std::make_shared<const LibrarySnapshot>();
+
+	return snapshot;
+}
+
+void LibrarySnapshot::clear()
+{
+	std::atomic_store(&sSnapshot, std::shared_ptr<const LibrarySnapshot>());
+}
+
+std::shared_ptr<SystemSnapshot> LibrarySnapshot::createSystemSnapshot(SystemData* system)
+{
+	auto snapshot = std::make_shared<SystemSnapshot>();
+
+	snapshot->version = system->getDataVersion();
+	snapshot->sourcesVersion = 0;
+	snapshot->visible = system->isVisible();
+	snapshot->populated = system->isPopulated();
+	snapshot->theme = system->getTheme().get();
+
+	snapshot->name = system->getName();
+	snapshot->fullName = system->getFullName();
+	snapshot->hardwareType = system->getSystemMetadata().hardwareType;
+	snapshot->manufacturer = system->getSystemMetadata().manufacturer;
+	snapshot->releaseYear = system->getSystemMetadata().releaseYear;
+	snapshot->themeFolder = system->getThemeFolder();
+	auto& extensions = system->getExtensions();
+	snapshot->extensions.assign(extensions.cbegin(), extensions.cend());
+	snapshot->group = system->getSystemEnvData()->mGroup;
+	snapshot->collection = system->isCollection();
+	snapshot->gameSystem = system->isGameSystem();
+	snapshot->groupSystem = system->isGroupSystem();
+	snapshot->gameCountInfo = *system->getGameCountInfo();
+
+	auto theme = system->getTheme();
+	if (theme != nullptr)
+	{
+		const ThemeData::ThemeElement* elem = theme->getElement("system", "logo", "image");
+		if (elem && elem->has("path"))
+			snapshot->logo = elem->get<std::string>("path");
+	}
+
+	return snapshot;
+}
+
+static bool isDerivedSystem(SystemData* system)
+{
+	return system->isCollection() || system->isGroupSystem();
+}
+
+typedef std::unordered_map<const void*, std::shared_ptr<const GameSnapshot>> GameSnapshotMap;
+
+// Lists the games of a system. A game whose metadata didn't change is shared with the previous snapshot, a changed game is copied once for all the systems showing it.
+static void listGames(SystemData* system, const SystemSnapshot* previous, GameSnapshotMap& created, std::vector<std::shared_ptr<const GameSnapshot>>& games)
+{
+	GameSnapshotMap previousByFile;
+	size_t cursor = 0;
+
+	std::stack<FolderData*> stack;
+	stack.push(system->getRootFolder());
+
+	while (stack.size())
+	{
+		FolderData* folder = stack.top();
+		stack.pop();
+
+		for (auto child : folder->getChildren())
+		{
+			if (child->getType() == FOLDER)
+			{
+				stack.push((FolderData*)child);
+				continue;
+			}
+
+			if (child->getType() != GAME)
+				continue;
+
+			FileData* game = child->getSourceFileData();
+			unsigned int version = game->getMetadata().getVersion();
+
+			// Games mostly come in the same order as in the previous snapshot
+			if (previous != nullptr && cursor < previous->games.size() && previous->games[cursor]->file == game && previous->games[cursor]->metadataVersion == version)
+			{
+				games.push_back(previous->games[cursor++]);
+				continue;
+			}
+
+			if (previous != nullptr && previousByFile.empty())
+				for (auto& previousGame : previous->games)
+					previousByFile[previousGame->file] = previousGame;
+
+			auto it = previousByFile.find(game);
+			if (it != previousByFile.cend() && it->second->metadataVersion == version)
+			{
+				games.push_back(it->second);
+				continue;
+			}
+
+			it = created.find(game);
+			if (it != created.cend() && it->second->metadataVersion == version)
+			{
+				games.push_back(it->second);
+				continue;
+			}
+
+			auto snapshot = std::make_shared<const GameSnapshot>(game);
+			created[game] = snapshot;
+			games.push_back(snapshot);
+		}
+	}
+}
+
+// Versions a system is built from : data, games of the game systems (collections and groups), theme and visibility
+typedef std::tuple<unsigned int, unsigned int, const void*, bool> SystemBuildKey;
+
+// A system whose games are listed by the UI thread. The worker indexes them and swaps the system in the current snapshot.
+struct SystemBuild
+{
+	unsigned int serial;
+	std::shared_ptr<SystemSnapshot> snapshot; // Without games yet
+	std::vector<std::shared_ptr<const GameSnapshot>> games;
+};
+
+static std::mutex						sPublishLock; // Serializes the updates of the current snapshot
+static std::thread*						sBuildThread = nullptr;
+static std::deque<SystemBuild>			sBuilds;
+static std::map<std::string, SystemBuildKey> sPendingBuilds; // Versions being built, by system name
+static std::map<std::string, unsigned int> sLatestBuilds; // Serial of the latest build, by system name
+static unsigned int						sBuildSerial = 0;
+static bool								sBuilding = false;
+static std::mutex						sBuildLock;
+static std::condition_variable			sBuildEvent;
+static std::condition_variable			sBuildDoneEvent;
+static bool								sBuildExit = false;
+
+void LibrarySnapshot::buildSystems()
+{
+	while (true)
+	{
+		SystemBuild build;
+
+		{
+			std::unique_lock<std::mutex> lock(sBuildLock);
+			sBuildEvent.wait(lock, [] { return sBuildExit || !sBuilds.empty(); });
+
+			if (sBuildExit)
+				return;
+
+			build = std::move(sBuilds.front());
+			sBuilds.pop_front();
+
+			// A newer build of the same system is queued
+			if (sLatestBuilds[build.snapshot->name] != build.serial)
+			{
+				sBuildDoneEvent.notify_all();
+				continue;
+			}
+
+			sBuilding = true;
+		}
+
+		auto& snapshot = build.snapshot;
+		snapshot->games.reserve(build.games.size());
+
+		for (auto& game : build.games)
+		{
+			if (snapshot->gamesById.find(game->id) != snapshot->gamesById.cend())
+				continue;
+
+			snapshot->gamesById[game->id] = snapshot->games.size();
+			snapshot->games.push_back(game);
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(sPublishLock);
+
+			auto current = std::atomic_load(&sSnapshot);
+			if (current != nullptr)
+			{
+				auto library = std::make_shared<LibrarySnapshot>(*current);
+
+				for (auto& system : library->systems)
+				{
+					if (system->name == snapshot->name)
+					{
+						system = snapshot;
+						break;
+					}
+				}
+
+				std::atomic_store(&sSnapshot, std::shared_ptr<const LibrarySnapshot>(library));
+			}
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(sBuildLock);
+			if (sLatestBuilds[snapshot->name] == build.serial)
+			{
+				sPendingBuilds.erase(snapshot->name);
+				sLatestBuilds.erase(snapshot->name);
+			}
+
+			sBuilding = false;
+		}
+
+		sBuildDoneEvent.notify_all();
+
+		LOG(LogDebug) << "LibrarySnapshot : " << snapshot->name << " built in background (" << snapshot->games.size() << " games)";
+	}
+}
+
+bool LibrarySnapshot::waitForBuilds(int timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(sBuildLock);
+	return sBuildDoneEvent.wait_for(lock, std::chrono::milliseconds(timeoutMs), [] { return sBuildExit || (sBuilds.empty() && !sBuilding); });
+}
+
+void LibrarySnapshot::stop()
+{
+	std::thread* thread = nullptr;
+
+	{
+		std::unique_lock<std::mutex> lock(sBuildLock);
+		sBuildExit = true;
+		sBuilds.clear();
+		sPendingBuilds.clear();
+		sLatestBuilds.clear();
+
+		thread = sBuildThread;
+		sBuildThread = nullptr;
+	}
+
+	sBuildEvent.notify_all();
+	sBuildDoneEvent.notify_all();
+
+	if (thread != nullptr)
+	{
+		thread->join();
+		delete thread;
+	}
+}
+
+void LibrarySnapshot::publish(bool force)
+{
+	auto current = std::atomic_load(&sSnapshot);
+
+	// Versions are unique and increasing : the highest one changes with any game system
+	unsigned int sourcesVersion = 0;
+	for (auto system : SystemData::sSystemVector)
+		if (!isDerivedSystem(system))
+			sourcesVersion = std::max(sourcesVersion, system->getDataVersion());
+
+	auto getBuildKey = [sourcesVersion](SystemData* system)
+	{
+		return SystemBuildKey(system->getDataVersion(), isDerivedSystem(system) ? sourcesVersion : 0, system->getTheme().get(), system->isVisible());
+	};
+
+	auto isUpToDate = [&getBuildKey](SystemData* system, const std::shared_ptr<const SystemSnapshot>& snapshot)
+	{
+		return snapshot->populated == system->isPopulated() && getBuildKey(system) == SystemBuildKey(snapshot->version, snapshot->sourcesVersion, snapshot->theme, snapshot->visible);
+	};
+
+	// Systems being built are up to date once their build is swapped in
+	std::map<std::string, SystemBuildKey> pending;
+
+	{
+		std::unique_lock<std::mutex> lock(sBuildLock);
+		pending = sPendingBuilds;
+	}
+
+	auto isPending = [&pending, &getBuildKey](SystemData* system)
+	{
+		auto it = pending.find(system->getName());
+		return it != pending.cend() && it->second == getBuildKey(system);
+	};
+
+	bool changed = (current == nullptr || current->systems.size() != SystemData::sSystemVector.size());
+	if (!changed)
+	{
+		for (size_t i = 0; i < SystemData::sSystemVector.size(); i++)
+		{
+			auto system = SystemData::sSystemVector[i];
+			if (current->systems[i]->name != system->getName() || (!isUpToDate(system, current->systems[i]) && !isPending(system)))
+			{
+				changed = true;
+				break;
+			}
+		}
+	}
+
+	if (!changed)
+		return;
+
+	auto now = std::chrono::steady_clock::now();
+	if (!force && current != nullptr && std::chrono::duration_cast<std::chrono::milliseconds>(now - sLastPublishTime).count() < SNAPSHOT_PUBLISH_DELAY)
+		return;
+
+	sLastPublishTime = now;
+
+	std::unordered_map<std::string, std::shared_ptr<const SystemSnapshot>> previous;
+	if (current != nullptr)
+		for (auto& system : current->systems)
+			previous[system->name] = system;
+
+	auto snapshot = std::make_shared<LibrarySnapshot>();
+	snapshot->systems.resize(SystemData::sSystemVector.size());
+
+	std::vector<SystemBuild> builds;
+	std::vector<size_t> building; // Systems served from the current snapshot until they are built
+	GameSnapshotMap created;
+
+	for (size_t i = 0; i < SystemData::sSystemVector.size(); i++)
+	{
+		auto system = SystemData::sSystemVector[i];
+
+		auto it = previous.find(system->getName());
+		if (it != previous.cend() && isUpToDate(system, it->second))
+		{
+			snapshot->systems[i] = it->second;
+			continue;
+		}
+
+		if (isPending(system))
+		{
+			building.push_back(i);
+			continue;
+		}
+
+		auto systemSnapshot = createSystemSnapshot(system);
+		systemSnapshot->sourcesVersion = isDerivedSystem(system) ? sourcesVersion : 0;
+
+		// Nothing to list while the games are loaded in background
+		if (!system->isPopulated())
+		{
+			snapshot->systems[i] = systemSnapshot;
+			continue;
+		}
+
+		SystemBuild build;
+		build.serial = 0;
+		build.snapshot = systemSnapshot;
+		listGames(system, it == previous.cend() ? nullptr : it->second.get(), created, build.games);
+
+		builds.push_back(std::move(build));
+		building.push_back(i);
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(sPublishLock);
+
+		// The worker may have swapped systems in since the copy started
+		auto latest = std::atomic_load(&sSnapshot);
+
+		for (auto i : building)
+		{
+			auto system = SystemData::sSystemVector[i];
+			auto systemSnapshot = latest == nullptr ? nullptr : latest->getSystem(system->getName());
+			if (systemSnapshot == nullptr)
+			{
+				// Never built yet : served as loading until the build is swapped in
+				auto placeholder = createSystemSnapshot(system);
+				placeholder->version = 0;
+				placeholder->populated = false;
+				systemSnapshot = placeholder;
+			}
+
+			snapshot->systems[i] = systemSnapshot;
+		}
+
+		std::atomic_store(&sSnapshot, std::shared_ptr<const LibrarySnapshot>(snapshot));
+	}
+
+	if (!builds.empty())
+	{
+		std::unique_lock<std::mutex> lock(sBuildLock);
+
+		for (auto& build : builds)
+		{
+			build.serial = ++sBuildSerial;
+			sLatestBuilds[build.snapshot->name] = build.serial;
+			sPendingBuilds[build.snapshot->name] = SystemBuildKey(build.snapshot->version, build.snapshot->sourcesVersion, build.snapshot->theme, build.snapshot->visible);
+			sBuilds.push_back(std::move(build));
+		}
+
+		if (sBuildThread == nullptr)
+		{
+			sBuildExit = false;
+			sBuildThread = new std::thread(&LibrarySnapshot::buildSystems);
+		}
+
+		sBuildEvent.notify_one();
+	}
+
+	LOG(LogDebug) << "LibrarySnapshot : published " << snapshot->systems.size() << " systems (" << builds.size() << " queued, " << created.size() << " games copied) in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count() << "ms";
+}
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef ES_APP_SERVICES_LIBRARY_SNAPSHOT_H
+#define ES_APP_SERVICES_LIBRARY_SNAPSHOT_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "MetaData.h"
+#include "SystemData.h"
+
+class FileData;
+
+// Immutable copy of a game, readable from any thread. Shared by the systems and the snapshots in which the game didn't change.
+struct GameSnapshot
+{
+	GameSnapshot() : file(nullptr), metadataVersion(0) { }
+	GameSnapshot(FileData* game);
+
+	const void* file; // Source FileData, only compared
+	unsigned int metadataVersion;
+
+	std::string id;
+	std::string path;
+	std::string name;
+	std::string systemName;
+	std::string sourceSystemName;
+
+	// Non empty metadata values
+	std::vector<std::pair<MetaDataId, std::string>> metadata;
+
+	std::string get(MetaDataId id) const;
+};
+
+// Immutable copy of a system and its games
+struct SystemSnapshot
+{
+	unsigned int version;
+	unsigned int sourcesVersion; // Collections and groups : latest version of the game systems when the games were copied, 0 otherwise
+	bool visible;
+	bool populated; // False while the games are loaded in background
+	const void* theme; // Only used to detect theme changes
+
+	std::string name;
+	std::string fullName;
+	std::string hardwareType;
+	std::string manufacturer;
+	int releaseYear;
+	std::string themeFolder;
+	std::vector<std::string> extensions;
+	std::string group;
+	bool collection;
+	bool gameSystem;
+	bool groupSystem;
+	GameCountInfo gameCountInfo;
+	std::string logo;
+
+	std::vector<std::shared_ptr<const GameSnapshot>> games;
+	std::unordered_map<std::string, size_t> gamesById;
+
+	const GameSnapshot* findGame(const std::string& id) const;
+};
+
+// Versioned copy of the game library used by the web api : readers take a reference to the current snapshot without locking.
+// After changes, the UI thread only copies the games whose metadata changed. A worker thread builds the new systems and swaps them in,
+// the previous ones are served meanwhile. Systems and games which didn't change are shared between snapshots.
+class LibrarySnapshot
+{
+public:
+	std::vector<std::shared_ptr<const SystemSnapshot>> systems;
+
+	std::shared_ptr<const SystemSnapshot> getSystem(const std::string& name) const;
+
+	static std::shared_ptr<const LibrarySnapshot> get();
+
+	// UI thread only
+	static void publish(bool force = false);
+	static void clear();
+	static void stop();
+
+	// Any thread but the UI thread : waits until the systems published so far are built, false on timeout
+	static bool waitForBuilds(int timeoutMs);
+
+private:
+	static std::shared_ptr<SystemSnapshot> createSystemSnapshot(SystemData* system);
+	static void buildSystems();
+
+	static std::shared_ptr<const LibrarySnapshot> sSnapshot;
+};
+
+#endif // ES_APP_SERVICES_LIBRARY_SNAPSHOT_H
@@ -354,6 +354,8 @@ void SystemView::showQuickSearch()
 	{
 		auto updateVal = [this, all](const std::string& newVal)
 		{
+			ViewController::get()->completePendingSystems();
+
 			auto index = all->getIndex(true);
 
 			index->resetFilters();
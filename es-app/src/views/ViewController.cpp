@@ -14,6 +14,7 @@
 #include "views/UIModeController.h"
 #include "FileFilterIndex.h"
 #include "Log.h"
+#include "Trace.h"
 #include "Scripting.h"
 #include "Settings.h"
 #include "SystemData.h"
@@ -28,6 +29,8 @@
 #include "guis/GuiMsgBox.h"
 #include "utils/ThreadPool.h"
 #include <SDL_timer.h>
+#include <atomic>
+#include <mutex>
 #include "TextToSpeech.h"
 #include "VolumeControl.h"
 #include "guis/GuiNetPlay.h"
@@ -83,6 +86,10 @@ ViewController::ViewController(Window* window)
 	mSystemListView = nullptr;
 	mState.viewing = NOTHING;	
 	mState.system = nullptr;
+	mGameListViewsUseCounter = 0;
+	mCheckGameListViewsBudget = false;
+	mRefreshCollections = false;
+	mCollectionsCompleted = false;
 }
 
 ViewController::~ViewController()
@@ -201,6 +208,7 @@ void ViewController::goToSystemView(SystemData* system, bool forceImmediate)
 	mCurrentView = systemList;
 
 	playViewTransition(forceImmediate);
+	mCheckGameListViewsBudget = true;
 }
 
 void ViewController::goToNextGameList()
@@ -236,6 +244,9 @@ void ViewController::goToGameList(SystemData* system, bool forceImmediate)
 	if (system == nullptr)
 		return;
 
+	if (system->isCollection() || system->isGroupSystem())
+		completePendingSystems();
+
 	SystemData* destinationSystem = system;
 	FolderData* collectionFolder = nullptr;
 
@@ -256,8 +267,11 @@ void ViewController::goToGameList(SystemData* system, bool forceImmediate)
 		}
 	}
 
-	std::shared_ptr<IGameListView> view = getGameListView(destinationSystem);
+	// Before getting the view : applying a change may replace it
+	applyPendingGameListChanges(destinationSystem);
 
+	std::shared_ptr<IGameListView> view = getGameListView(destinationSystem);
+	touchGameListView(destinationSystem);
 
 	if (mState.viewing == SYSTEM_SELECT)
 	{
@@ -344,6 +358,8 @@ void ViewController::goToGameList(SystemData* system, bool forceImmediate)
 		cancelAnimation(0);
 		mDeferPlayViewTransitionTo = view;
 	}
+
+	mCheckGameListViewsBudget = true;
 }
 
 void ViewController::playViewTransition(bool forceImmediate)
@@ -422,6 +438,66 @@ void ViewController::playViewTransition(bool forceImmediate)
 	}
 }
 
+static int getChangeStrength(FileChangeType change)
+{
+	switch (change)
+	{
+	case FILE_SORTED: return 0;
+	case FILE_ADDED: return 1;
+	case FILE_METADATA_CHANGED: return 2;
+	case FILE_REMOVED: return 3;
+	}
+
+	return 0;
+}
+
+void ViewController::completePendingSystems()
+{
+	if (!SystemData::populatePendingSystems())
+		return;
+
+	// Collections were built with the systems loaded at startup
+	mCollectionsCompleted = true;
+	mRefreshCollections = false;
+
+	CollectionSystemManager::get()->repopulateCollections();
+	reloadAll(nullptr, false);
+}
+
+void ViewController::onGameListChanged(SystemData* system, FileData* file, FileChangeType change)
+{
+	auto it = mGameListViews.find(system);
+	if (it == mGameListViews.cend())
+		return;
+
+	if (it->second == mCurrentView || it->second == mDeferPlayViewTransitionTo)
+	{
+		mPendingGameListChanges.erase(system);
+		it->second->onFileChanged(file, change);
+		return;
+	}
+
+	// The view is repopulated when it is shown again : only the strongest change is kept
+	auto pending = mPendingGameListChanges.find(system);
+	if (pending == mPendingGameListChanges.cend() || getChangeStrength(change) >= getChangeStrength(pending->second.second))
+		mPendingGameListChanges[system] = std::make_pair(file, change);
+}
+
+void ViewController::applyPendingGameListChanges(SystemData* system)
+{
+	auto it = mPendingGameListChanges.find(system);
+	if (it == mPendingGameListChanges.cend())
+		return;
+
+	auto change = it->second;
+	mPendingGameListChanges.erase(it);
+
+	// A view which doesn't exist anymore is built from the current data
+	auto view = mGameListViews.find(system);
+	if (view != mGameListViews.cend())
+		view->second->onFileChanged(change.first, change.second);
+}
+
 void ViewController::onFileChanged(FileData* file, FileChangeType change)
 {
 	std::string key = file->getFullPath();
@@ -664,27 +740,92 @@ void ViewController::removeGameListView(SystemData* system)
 		exists->second.reset();
 		mGameListViews.erase(system);
 	}
+
+	mGameListViewsLastUse.erase(system);
+	mPendingGameListChanges.erase(system);
 }
 
-std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* system, bool loadIfnull, const std::function<void()>& createAsPopupAndSetExitFunction)
+void ViewController::touchGameListView(SystemData* system)
 {
-	if (createAsPopupAndSetExitFunction == nullptr)
+	mGameListViewsLastUse[system] = ++mGameListViewsUseCounter;
+}
+
+size_t ViewController::getGameListViewsMemoryUsage(bool logDetails)
+{
+	size_t total = 0;
+
+	for (auto gameList : mGameListViews)
 	{
-		//if we already made one, return that one
-		auto exists = mGameListViews.find(system);
-		if (exists != mGameListViews.cend())
-			return exists->second;
+		size_t size = gameList.second->getMemoryUsage();
+		total += size;
 
-		if (!loadIfnull)
-			return nullptr;
+		if (logDetails)
+			LOG(LogDebug) << "  gamelist view " << gameList.first->getName() << " : " << size / 1024 << " KB";
+	}
 
-		system->setUIModeFilters();
-		system->updateDisplayedGameCount();
+	return total;
+}
+
+void ViewController::evictGameListViews()
+{
+	int maxCount = Settings::getInstance()->getInt("GameListViewsMaxCount");
+	size_t maxMemory = (size_t)Math::max(0, Settings::getInstance()->getInt("GameListViewsMaxMemory")) * 1024 * 1024;
+	if (maxCount <= 0 && maxMemory == 0)
+		return;
+
+	int count = (int)mGameListViews.size();
+	size_t total = 0;
+
+	std::map<SystemData*, size_t> sizes;
+	std::vector<std::pair<unsigned int, SystemData*>> candidates;
+
+	for (auto gameList : mGameListViews)
+	{
+		if (maxMemory != 0)
+		{
+			sizes[gameList.first] = gameList.second->getMemoryUsage();
+			total += sizes[gameList.first];
+		}
+
+		// Never release the views which are displayed or about to be
+		if (gameList.first == mState.system || gameList.second == mCurrentView || gameList.second == mDeferPlayViewTransitionTo)
+			continue;
+
+		auto lastUse = mGameListViewsLastUse.find(gameList.first);
+		candidates.push_back(std::pair<unsigned int, SystemData*>(lastUse == mGameListViewsLastUse.cend() ? 0 : lastUse->second, gameList.first));
 	}
 
-	//if we didn't, make it, remember it, and return it
-	std::shared_ptr<IGameListView> view;
+	std::sort(candidates.begin(), candidates.end(), [](const std::pair<unsigned int, SystemData*>& a, const std::pair<unsigned int, SystemData*>& b) { return a.first < b.first; });
+
+	for (auto candidate : candidates)
+	{
+		if ((maxCount <= 0 || count <= maxCount) && (maxMemory == 0 || total <= maxMemory))
+			break;
+
+		SystemData* system = candidate.second;
 
+		auto it = mGameListViews.find(system);
+		if (it == mGameListViews.cend())
+			continue;
+
+		// Remember the cursor to restore it when the view is created again
+		FileData* cursor = it->second->getCursor();
+		if (cursor != nullptr && !cursor->isPlaceHolder())
+			mEvictedCursors[system] = cursor->getPath();
+
+		LOG(LogDebug) << "ViewController : releasing gamelist view " << system->getName() << " (" << sizes[system] / 1024 << " KB)";
+
+		mGameListViews.erase(it);
+		mGameListViewsLastUse.erase(system);
+
+		total -= sizes[system];
+		count--;
+	}
+}
+
+// Settings, theme and media lookups only : doesn't create any component, so it can run on a worker thread
+ViewController::GameListViewInfo ViewController::resolveGameListViewType(SystemData* system)
+{
 	bool themeHasGamecarouselView = system->getTheme()->hasView("gamecarousel");
 	bool themeHasVideoView = system->getTheme()->hasView("video");
 	bool themeHasGridView = system->getTheme()->hasView("grid");
@@ -772,6 +913,54 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 		}
 	}
 
+	GameListViewInfo info;
+	info.type = selectedViewType;
+	info.customThemeName = customThemeName;
+	info.gridSizeOverride = gridSizeOverride;
+	return info;
+}
+
+std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* system, bool loadIfnull, const std::function<void()>& createAsPopupAndSetExitFunction)
+{
+	if (createAsPopupAndSetExitFunction == nullptr)
+	{
+		//if we already made one, return that one
+		auto exists = mGameListViews.find(system);
+		if (exists != mGameListViews.cend())
+			return exists->second;
+
+		if (!loadIfnull)
+			return nullptr;
+
+		system->setUIModeFilters();
+		system->updateDisplayedGameCount();
+	}
+
+	// Systems loaded in background : wait for this one only
+	system->ensurePopulated();
+
+	//if we didn't, make it, remember it, and return it
+	std::shared_ptr<IGameListView> view;
+
+	GameListViewInfo viewInfo;
+
+	auto preloaded = mPreloadedViewTypes.find(system);
+	if (preloaded != mPreloadedViewTypes.cend())
+	{
+		viewInfo = preloaded->second;
+		mPreloadedViewTypes.erase(preloaded);
+	}
+	else
+		viewInfo = resolveGameListViewType(system);
+
+	GameListViewType selectedViewType = viewInfo.type;
+	const std::string& customThemeName = viewInfo.customThemeName;
+	Vector2f gridSizeOverride = viewInfo.gridSizeOverride;
+
+	// Populated from the list built by preload() instead of filtering and sorting again
+	if (viewInfo.hasDisplayList)
+		system->getRootFolder()->setPreparedChildrenListToDisplay(&viewInfo.displayList);
+
 	// Create the view
 	switch (selectedViewType)
 	{
@@ -792,6 +981,9 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 			break;
 	}
 
+	if (viewInfo.hasDisplayList)
+		system->getRootFolder()->setPreparedChildrenListToDisplay(nullptr);
+
 	if (selectedViewType != GRID)
 	{
 		// GridGameListView theme needs to be loaded before populating.
@@ -825,6 +1017,17 @@ std::shared_ptr<IGameListView> ViewController::getGameListView(SystemData* syste
 
 		addChild(view.get());
 		mGameListViews[system] = view;
+		touchGameListView(system);
+
+		auto evictedCursor = mEvictedCursors.find(system);
+		if (evictedCursor != mEvictedCursors.cend())
+		{
+			FileData* cursor = system->getRootFolder()->FindByPath(evictedCursor->second);
+			if (cursor != nullptr)
+				view->setCursor(cursor);
+
+			mEvictedCursors.erase(evictedCursor);
+		}
 	}
 
 	return view;
@@ -945,6 +1148,22 @@ void ViewController::update(int deltaTime)
 
 		playViewTransition(false); 
 	}
+
+	// Release old gamelist views once the transition is over : they can be visible while it plays
+	if (mCheckGameListViewsBudget && mDeferPlayViewTransitionTo == nullptr && !isAnimationPlaying(0))
+	{
+		mCheckGameListViewsBudget = false;
+		evictGameListViews();
+	}
+
+	// Collection games are deleted when they are rebuilt : never do it while one is displayed or used by a popup
+	if (mRefreshCollections && mDeferPlayViewTransitionTo == nullptr && !isAnimationPlaying(0) && mWindow->peekGui() == this && !(mState.viewing == GAME_LIST && mState.getSystem()->isCollection()))
+	{
+		mRefreshCollections = false;
+
+		CollectionSystemManager::get()->repopulateCollections();
+		reloadAll(nullptr, false);
+	}
 }
 
 void ViewController::render(const Transform4x4f& parentTrans)
@@ -1002,21 +1221,78 @@ void ViewController::preload()
 	if (!preloadUI)
 		return;
 
+	TRACE_SCOPE("ViewController::preload");
+
 	mWindow->renderSplashScreen(_("Preloading UI"), 0);
 	getSystemListView();
 
-	int i = 1;
-	int max = SystemData::sSystemVector.size() + 1;
 	bool splash = preloadUI && Settings::getInstance()->getBool("SplashScreen") && Settings::getInstance()->getBool("SplashScreenProgress");
+	int maxViews = Settings::getInstance()->getInt("GameListViewsMaxCount");
 
-	for(auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
-	{		
-		if ((*it)->isGroupChildSystem() || !(*it)->isVisible())
+	// Don't create views which would be released right away
+	std::vector<SystemData*> systems;
+	for (auto system : SystemData::sSystemVector)
+	{
+		// Systems loaded in background are created when they are opened
+		if (system->isGroupChildSystem() || !system->isVisible() || !system->isPopulated() || mGameListViews.find(system) != mGameListViews.cend())
+			continue;
+
+		if (maxViews > 0 && (int)(mGameListViews.size() + systems.size()) >= maxViews)
+			break;
+
+		systems.push_back(system);
+	}
+
+	auto startTime = SDL_GetTicks();
+
+	// Build phase, on worker threads : filters, view type selection and the filtered and sorted game lists.
+	// Finalize phase, on the main thread : components, fonts and textures, which need the GL context.
+	std::atomic<int> processed(0);
+	std::mutex lock;
+
+	Utils::ThreadPool pool;
+
+	for (auto system : systems)
+	{
+		// Collections share their games with other systems : they are resolved on the main thread
+		if (system->isCollection())
 		{
-			i++;
+			processed++;
 			continue;
 		}
 
+		pool.queueWorkItem([this, system, &processed, &lock]
+		{
+			system->resetFilters();
+			auto info = resolveGameListViewType(system);
+
+			info.displayList = system->getRootFolder()->getChildrenListToDisplay();
+			info.hasDisplayList = true;
+
+			std::unique_lock<std::mutex> guard(lock);
+			mPreloadedViewTypes[system] = info;
+			processed++;
+		});
+	}
+
+	int max = systems.size() * 2 + 1;
+
+	if (splash)
+	{
+		pool.wait([this, &processed, max]
+		{
+			mWindow->renderSplashScreen(_("Preloading UI"), (float)(processed + 1) / (float)max);
+		}, 10);
+	}
+	else
+		pool.wait();
+
+	auto buildTime = SDL_GetTicks() - startTime;
+	auto finalizeTime = SDL_GetTicks();
+
+	int i = systems.size() + 1;
+	for (auto system : systems)
+	{
 		if (splash)
 		{
 			i++;
@@ -1025,9 +1301,17 @@ void ViewController::preload()
 				mWindow->renderSplashScreen(_("Preloading UI"), (float)i / (float)max);
 		}
 
-		(*it)->resetFilters();
-		getGameListView(*it);
+		if (system->isCollection())
+			system->resetFilters();
+
+		getGameListView(system);
 	}
+
+	mPreloadedViewTypes.clear();
+
+	finalizeTime = SDL_GetTicks() - finalizeTime;
+
+	LOG(LogInfo) << "Preloaded " << mGameListViews.size() << " gamelist views in " << SDL_GetTicks() - startTime << "ms (" << buildTime << "ms building in parallel, " << finalizeTime << "ms finalizing on the main thread) (" << getGameListViewsMemoryUsage(true) / 1024 << " KB)";
 }
 
 void ViewController::reloadSystemListViewTheme(SystemData* system)
@@ -1155,6 +1439,9 @@ void ViewController::reloadAll(Window* window, bool reloadTheme)
 	}
 
 	mGameListViews.clear();
+	mGameListViewsLastUse.clear();
+	mEvictedCursors.clear();
+	mPendingGameListChanges.clear();
 	
 	// If preloaded is disabled
 	for (auto it = SystemData::sSystemVector.cbegin(); it != SystemData::sSystemVector.cend(); it++)
@@ -1195,6 +1482,8 @@ void ViewController::reloadAll(Window* window, bool reloadTheme)
 		}
 		else
 			pool.wait();
+
+		ThemeData::clearThemeCache();
 	}
 
 	bool preloadUI = Settings::getInstance()->getBool("PreloadUI");
@@ -1334,6 +1623,9 @@ void ViewController::reloadAllGames(Window* window, bool deleteCurrentGui, bool
 	auto viewMode = ViewController::get()->getViewMode();
 	auto systemName = ViewController::get()->getSelectedSystem()->getName();
 
+	// Pending tasks may use the games which are about to be deleted
+	window->flushIdleTasks();
+
 	window->closeSplashScreen();
 	window->renderSplashScreen(_("Loading..."));
 
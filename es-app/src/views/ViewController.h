@@ -61,6 +61,15 @@ public:
 
 	void onFileChanged(FileData* file, FileChangeType change);
 
+	// Refreshes the gamelist view of the system now if it is displayed, otherwise the next time it is shown
+	void onGameListChanged(SystemData* system, FileData* file, FileChangeType change);
+
+	// Rebuilds the collections once the user isn't looking at one
+	void refreshCollections() { if (mCollectionsCompleted) mCollectionsCompleted = false; else mRefreshCollections = true; }
+
+	// Collections and groups show the games of other systems : the systems still loading in background are loaded, and the collections rebuilt
+	void completePendingSystems();
+
 	// Plays a nice launch effect and launches the game at the end of it.
 	// Once the game terminates, plays a return effect.
 	void launch(FileData* game, LaunchGameOptions options, Vector3f centerCameraOn = Vector3f(Renderer::getScreenWidth() / 2.0f, Renderer::getScreenHeight() / 2.0f, 0), bool allowCheckLaunchOptions = true);
@@ -100,6 +109,9 @@ public:
 	std::shared_ptr<SystemView> getSystemListView();
 	void removeGameListView(SystemData* system);
 
+	// Returns the approximate memory used by the gamelist views (in bytes)
+	size_t getGameListViewsMemoryUsage(bool logDetails = false);
+
 	void onThemeChanged(const std::shared_ptr<ThemeData>& theme);
 
 	virtual void onShow() override;
@@ -125,8 +137,38 @@ private:
 	int getSystemId(SystemData* system);
 	void changeVolume(int increment);
 
+	// Model of a system's gamelist, built without creating any component : preload() builds it on worker threads,
+	// then getGameListView() finalizes the view (components, fonts, textures) on the main thread.
+	struct GameListViewInfo
+	{
+		GameListViewInfo() : type(AUTOMATIC), hasDisplayList(false) { }
+
+		GameListViewType type;
+		std::string customThemeName;
+		Vector2f gridSizeOverride;
+
+		bool hasDisplayList;
+		std::vector<FileData*> displayList; // Filtered and sorted root items
+	};
+
+	static GameListViewInfo resolveGameListViewType(SystemData* system);
+
+	// Gamelist views are released, least recently used first, when "GameListViewsMaxCount" or "GameListViewsMaxMemory" is exceeded
+	void touchGameListView(SystemData* system);
+	void evictGameListViews();
+
 	std::shared_ptr<GuiComponent> mCurrentView;
 	std::map< SystemData*, std::shared_ptr<IGameListView> > mGameListViews;
+	std::map< SystemData*, unsigned int > mGameListViewsLastUse;
+	std::map< SystemData*, std::string > mEvictedCursors;
+	std::map< SystemData*, GameListViewInfo > mPreloadedViewTypes;
+	unsigned int mGameListViewsUseCounter;
+	bool mCheckGameListViewsBudget;
+	bool mRefreshCollections;
+	bool mCollectionsCompleted; // The refresh requested at the end of the background loading has already been done
+
+	std::map<SystemData*, std::pair<FileData*, FileChangeType>> mPendingGameListChanges;
+	void applyPendingGameListChanges(SystemData* system);
 	std::shared_ptr<SystemView> mSystemListView;
 	
 	Transform4x4f mCamera;
@@ -0,0 +1,244 @@
+#include "FrameTimings.h"
+#include "Trace.h"
+#include "Settings.h"
+#include "Log.h"
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <algorithm>
+
+// Buckets are exact below HISTOGRAM_SUB_COUNT, then each power of two is split in HISTOGRAM_SUB_COUNT / 2 buckets
+#define HISTOGRAM_SUB_BITS		5
+#define HISTOGRAM_SUB_COUNT		(1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_HALF_COUNT	(HISTOGRAM_SUB_COUNT / 2)
+#define HISTOGRAM_MAX_BITS		27 // Durations are clamped to ~134s
+#define HISTOGRAM_BUCKETS		(HISTOGRAM_SUB_COUNT + (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS) * HISTOGRAM_HALF_COUNT)
+
+// Stalls kept for the api
+#define MAX_STALLS				32
+// Scopes kept per stall, and the minimal duration of these scopes (us)
+#define MAX_STALL_SCOPES		8
+#define MIN_STALL_SCOPE_TIME	1000
+
+namespace FrameTimings
+{
+	static const char* sPhaseNames[PHASE_COUNT] = { "input", "update", "render", "swap", "frame" };
+
+	class Histogram
+	{
+	public:
+		Histogram() { clear(); }
+
+		void clear()
+		{
+			memset(mBuckets, 0, sizeof(mBuckets));
+			mCount = 0;
+			mSum = 0;
+			mMax = 0;
+		}
+
+		void record(int64_t value)
+		{
+			if (value < 0)
+				value = 0;
+			else if (value >= ((int64_t)1 << HISTOGRAM_MAX_BITS))
+				value = ((int64_t)1 << HISTOGRAM_MAX_BITS) - 1;
+
+			mBuckets[getBucket(value)]++;
+			mCount++;
+			mSum += value;
+
+			if (value > mMax)
+				mMax = value;
+		}
+
+		PhaseStats getStats() const
+		{
+			PhaseStats stats;
+			stats.count = mCount;
+			stats.mean = mCount == 0 ? 0 : mSum / (int64_t)mCount;
+			stats.p50 = getPercentile(0.50);
+			stats.p95 = getPercentile(0.95);
+			stats.p99 = getPercentile(0.99);
+			stats.max = mMax;
+			return stats;
+		}
+
+	private:
+		static int getBucket(int64_t value)
+		{
+			if (value < HISTOGRAM_SUB_COUNT)
+				return (int)value;
+
+			int msb = 0;
+			while ((value >> (msb + 1)) != 0)
+				msb++;
+
+			int shift = msb - (HISTOGRAM_SUB_BITS - 1);
+			int top = (int)(value >> shift); // In [HALF_COUNT, SUB_COUNT[
+			return HISTOGRAM_SUB_COUNT + (shift - 1) * HISTOGRAM_HALF_COUNT + (top - HISTOGRAM_HALF_COUNT);
+		}
+
+		// Highest value which falls in the bucket
+		static int64_t getBucketValue(int bucket)
+		{
+			if (bucket < HISTOGRAM_SUB_COUNT)
+				return bucket;
+
+			int shift = (bucket - HISTOGRAM_SUB_COUNT) / HISTOGRAM_HALF_COUNT + 1;
+			int64_t top = (bucket - HISTOGRAM_SUB_COUNT) % HISTOGRAM_HALF_COUNT + HISTOGRAM_HALF_COUNT;
+			return ((top + 1) << shift) - 1;
+		}
+
+		int64_t getPercentile(double percentile) const
+		{
+			if (mCount == 0)
+				return 0;
+
+			uint64_t target = (uint64_t)(percentile * mCount + 0.5);
+			if (target == 0)
+				target = 1;
+
+			uint64_t total = 0;
+			for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+			{
+				total += mBuckets[i];
+				if (total >= target)
+					return std::min(getBucketValue(i), mMax);
+			}
+
+			return mMax;
+		}
+
+		uint32_t	mBuckets[HISTOGRAM_BUCKETS];
+		uint64_t	mCount;
+		int64_t		mSum;
+		int64_t		mMax;
+	};
+
+	static std::mutex			sLock;
+	static Histogram			sHistograms[PHASE_COUNT];
+	static std::deque<Stall>	sStalls;
+	static uint64_t				sStallCount = 0;
+	static std::atomic<int64_t>	sThreshold(0);
+
+	// Main loop state
+	static int64_t				sFrameStart = 0;
+	static int64_t				sLastMark = 0;
+	static int64_t				sDurations[PHASE_COUNT];
+
+	const char* getPhaseName(Phase phase)
+	{
+		return sPhaseNames[phase];
+	}
+
+	void beginFrame()
+	{
+		sFrameStart = sLastMark = Trace::getTime();
+		memset(sDurations, 0, sizeof(sDurations));
+	}
+
+	void endPhase(Phase phase)
+	{
+		if (sFrameStart == 0)
+			return;
+
+		int64_t now = Trace::getTime();
+		sDurations[phase] += now - sLastMark;
+		sLastMark = now;
+	}
+
+	void discardFrame()
+	{
+		sFrameStart = 0;
+	}
+
+	void endFrame()
+	{
+		if (sFrameStart == 0)
+			return;
+
+		int64_t now = Trace::getTime();
+		sDurations[PHASE_FRAME] = now - sFrameStart;
+
+		int64_t threshold = (int64_t)Settings::FrameStallThreshold() * 1000;
+		sThreshold = threshold;
+
+		bool stalled = threshold > 0 && sDurations[PHASE_FRAME] > threshold;
+
+		Stall stall;
+		if (stalled)
+		{
+			stall.time = sFrameStart;
+			memcpy(stall.durations, sDurations, sizeof(sDurations));
+
+			for (auto& scope : Trace::getThreadScopes(sFrameStart, now, MIN_STALL_SCOPE_TIME, MAX_STALL_SCOPES))
+				stall.scopes.push_back(scope.name + " (" + std::to_string(scope.duration / 1000) + "ms)");
+
+			LOG(LogDebug) << "FrameTimings : " << sDurations[PHASE_FRAME] / 1000 << "ms frame (input " << sDurations[PHASE_INPUT] / 1000 << "ms, update " << sDurations[PHASE_UPDATE] / 1000
+				<< "ms, render " << sDurations[PHASE_RENDER] / 1000 << "ms, swap " << sDurations[PHASE_SWAP] / 1000 << "ms)";
+		}
+
+		std::unique_lock<std::mutex> lock(sLock);
+
+		for (int i = 0; i < PHASE_COUNT; i++)
+			sHistograms[i].record(sDurations[i]);
+
+		if (stalled)
+		{
+			sStallCount++;
+			sStalls.push_back(std::move(stall));
+			if (sStalls.size() > MAX_STALLS)
+				sStalls.pop_front();
+		}
+
+		sFrameStart = 0;
+	}
+
+	Stats getStats()
+	{
+		Stats stats;
+		stats.threshold = sThreshold;
+
+		std::unique_lock<std::mutex> lock(sLock);
+
+		stats.stallCount = sStallCount;
+		for (int i = 0; i < PHASE_COUNT; i++)
+			stats.phases[i] = sHistograms[i].getStats();
+
+		stats.stalls.assign(sStalls.cbegin(), sStalls.cend());
+		return stats;
+	}
+
+	void reset()
+	{
+		std::unique_lock<std::mutex> lock(sLock);
+
+		for (int i = 0; i < PHASE_COUNT; i++)
+			sHistograms[i].clear();
+
+		sStalls.clear();
+		sStallCount = 0;
+	}
+
+	std::string getOverlayText()
+	{
+		PhaseStats frame;
+		uint64_t stallCount;
+
+		{
+			std::unique_lock<std::mutex> lock(sLock);
+			frame = sHistograms[PHASE_FRAME].getStats();
+			stallCount = sStallCount;
+		}
+
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(1);
+		ss << "Frame p50: " << frame.p50 / 1000.0f << " p95: " << frame.p95 / 1000.0f << " p99: " << frame.p99 / 1000.0f << " max: " << frame.max / 1000.0f << "ms";
+		ss << ", Stalls: " << stallCount;
+		return ss.str();
+	}
+} // FrameTimings::
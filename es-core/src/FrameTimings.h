@@ -0,0 +1,67 @@
+#pragma once
+#ifndef ES_CORE_FRAME_TIMINGS_H
+#define ES_CORE_FRAME_TIMINGS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Per frame timings of the main loop, split in phases. Durations go to log-linear histograms (3 to 6% precision),
+// frames longer than the "FrameStallThreshold" setting (ms) are kept as stalls along with the trace scopes which ran during them.
+namespace FrameTimings
+{
+	enum Phase
+	{
+		PHASE_INPUT = 0,
+		PHASE_UPDATE = 1,
+		PHASE_RENDER = 2,
+		PHASE_SWAP = 3,
+		PHASE_FRAME = 4, // Whole frame
+
+		PHASE_COUNT = 5
+	};
+
+	const char* getPhaseName(Phase phase);
+
+	// Durations are in microseconds
+	struct PhaseStats
+	{
+		uint64_t count;
+		int64_t mean;
+		int64_t p50;
+		int64_t p95;
+		int64_t p99;
+		int64_t max;
+	};
+
+	struct Stall
+	{
+		int64_t time; // Trace::getTime() at the start of the frame
+		int64_t durations[PHASE_COUNT];
+		std::vector<std::string> scopes; // Only available while tracing is enabled
+	};
+
+	struct Stats
+	{
+		int64_t threshold;
+		uint64_t stallCount;
+
+		PhaseStats phases[PHASE_COUNT];
+		std::vector<Stall> stalls; // Latest ones, most recent last
+	};
+
+	// Main loop only
+	void beginFrame();
+	void endPhase(Phase phase); // The time since the previous mark is accounted to this phase
+	void endFrame();
+	void discardFrame(); // The current frame isn't recorded, e.g. it has been blocked by a game
+
+	// Any thread
+	Stats getStats();
+	void reset();
+
+	// Short summary for the framerate overlay
+	std::string getOverlayText();
+} // FrameTimings::
+
+#endif // ES_CORE_FRAME_TIMINGS_H
@@ -17,6 +17,32 @@
 
 bool GuiComponent::isLaunchTransitionRunning = false;
 
+// Properties read by every themed component, resolved once
+struct CommonThemeProperties
+{
+	typedef ThemeData::ThemeElement E;
+
+	E::PropertyId pos = E::getPropertyId("pos");
+	E::PropertyId x = E::getPropertyId("x");
+	E::PropertyId y = E::getPropertyId("y");
+	E::PropertyId size = E::getPropertyId("size");
+	E::PropertyId w = E::getPropertyId("w");
+	E::PropertyId h = E::getPropertyId("h");
+	E::PropertyId padding = E::getPropertyId("padding");
+	E::PropertyId origin = E::getPropertyId("origin");
+	E::PropertyId rotation = E::getPropertyId("rotation");
+	E::PropertyId rotationOrigin = E::getPropertyId("rotationOrigin");
+	E::PropertyId scale = E::getPropertyId("scale");
+	E::PropertyId scaleOrigin = E::getPropertyId("scaleOrigin");
+	E::PropertyId zIndex = E::getPropertyId("zIndex");
+	E::PropertyId visible = E::getPropertyId("visible");
+	E::PropertyId opacity = E::getPropertyId("opacity");
+	E::PropertyId offset = E::getPropertyId("offset");
+	E::PropertyId offsetX = E::getPropertyId("offsetX");
+	E::PropertyId offsetY = E::getPropertyId("offsetY");
+	E::PropertyId clipRect = E::getPropertyId("clipRect");
+};
+
 GuiComponent::GuiComponent(Window* window) : mWindow(window), mParent(NULL), mOpacity(255), mAmbientOpacity(255),
 	mPosition(Vector3f::Zero()), mOrigin(Vector2f::Zero()), mRotationOrigin(0.5, 0.5), mScaleOrigin(0.5f, 0.5f), mSourceBounds(Vector4f::Zero()),
 	mSize(Vector2f::Zero()), mTransform(Transform4x4f::Identity()), mVisible(true), mShowing(false), mPadding(Vector4f(0, 0, 0, 0)), mClipChildren(false),
@@ -371,6 +397,16 @@ GuiComponent* GuiComponent::getChild(unsigned int i) const
 	return mChildren.at(i);
 }
 
+size_t GuiComponent::getMemoryUsage()
+{
+	size_t total = 0;
+
+	for (auto child : mChildren)
+		total += child->getMemoryUsage();
+
+	return total;
+}
+
 void GuiComponent::setParent(GuiComponent* parent)
 {
 	mParent = parent;
@@ -774,6 +810,9 @@ void GuiComponent::loadThemedChildren(const ThemeData::ThemeElement* elem)
 
 void GuiComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties)
 {
+	// Not a global : the ids come from ThemeData's schema, which must be built first
+	static const CommonThemeProperties sThemeProps;
+
 	const ThemeData::ThemeElement* elem = theme->getElement(view, element, getThemeTypeName()); // getThemeTypeName()
 	if (!elem)
 		return;
@@ -785,47 +824,47 @@ void GuiComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std
 
 	using namespace ThemeFlags;
 
-	if (properties & POSITION && elem->has("pos"))
+	if (properties & POSITION && elem->has(sThemeProps.pos))
 	{		
-		auto pos = mSourceBounds.xy() = elem->get<Vector2f>("pos");
+		auto pos = mSourceBounds.xy() = elem->get<Vector2f>(sThemeProps.pos);
 
 		Vector2f denormalized = pos * scale + offset;
 		setPosition(Vector3f(denormalized.x(), denormalized.y(), 0));
 	}
 
-	if (properties & POSITION && elem->has("x"))
+	if (properties & POSITION && elem->has(sThemeProps.x))
 	{
-		auto x = mSourceBounds.x() = elem->get<float>("x");
+		auto x = mSourceBounds.x() = elem->get<float>(sThemeProps.x);
 		setPosition(Vector3f(x * scale.x() + offset.x(), mPosition.y(), 0));
 	}
 
-	if (properties & POSITION && elem->has("y"))
+	if (properties & POSITION && elem->has(sThemeProps.y))
 	{
-		auto y = mSourceBounds.y() = elem->get<float>("y");
+		auto y = mSourceBounds.y() = elem->get<float>(sThemeProps.y);
 		setPosition(Vector3f(mPosition.x(), y * scale.y() + offset.y(), 0));
 	}
 
-	if (properties & ThemeFlags::SIZE && elem->has("size"))
+	if (properties & ThemeFlags::SIZE && elem->has(sThemeProps.size))
 	{
-		auto sz = mSourceBounds.zw() = elem->get<Vector2f>("size");
+		auto sz = mSourceBounds.zw() = elem->get<Vector2f>(sThemeProps.size);
 		setSize(sz * scale);
 	}
 
-	if (properties & SIZE && elem->has("w"))
+	if (properties & SIZE && elem->has(sThemeProps.w))
 	{
-		auto w = mSourceBounds.z() = elem->get<float>("w");
+		auto w = mSourceBounds.z() = elem->get<float>(sThemeProps.w);
 		setSize(Vector2f(w * scale.x(), mSize.y()));
 	}
 
-	if (properties & SIZE && elem->has("h"))
+	if (properties & SIZE && elem->has(sThemeProps.h))
 	{
-		auto h = mSourceBounds.w() = elem->get<float>("h");
+		auto h = mSourceBounds.w() = elem->get<float>(sThemeProps.h);
 		setSize(Vector2f(mSize.x(), h * scale.y()));
 	}
 	
-	if (elem->has("padding"))
+	if (elem->has(sThemeProps.padding))
 	{
-		auto padding = elem->get<Vector4f>("padding");
+		auto padding = elem->get<Vector4f>(sThemeProps.padding);
 		if (abs(padding.x()) < 1 && abs(padding.y()) < 1 && abs(padding.z()) < 1 && abs(padding.w()) < 1)
 			setPadding(padding * Vector4f(scale.x(), scale.y(), scale.x(), scale.y()));
 		else
@@ -833,56 +872,56 @@ void GuiComponent::applyTheme(const std::shared_ptr<ThemeData>& theme, const std
 	}
 
 	// position + size also implies origin
-	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has("origin"))
-		setOrigin(elem->get<Vector2f>("origin"));
+	if((properties & ORIGIN || (properties & POSITION && properties & ThemeFlags::SIZE)) && elem->has(sThemeProps.origin))
+		setOrigin(elem->get<Vector2f>(sThemeProps.origin));
 
 	if(properties & ThemeFlags::ROTATION) 
 	{
-		if(elem->has("rotation"))
-			setRotationDegrees(elem->get<float>("rotation"));
+		if(elem->has(sThemeProps.rotation))
+			setRotationDegrees(elem->get<float>(sThemeProps.rotation));
 		
-		if(elem->has("rotationOrigin"))
-			setRotationOrigin(elem->get<Vector2f>("rotationOrigin"));
+		if(elem->has(sThemeProps.rotationOrigin))
+			setRotationOrigin(elem->get<Vector2f>(sThemeProps.rotationOrigin));
 
-		if (elem->has("scale"))
-			setScale(elem->get<float>("scale"));
+		if (elem->has(sThemeProps.scale))
+			setScale(elem->get<float>(sThemeProps.scale));
 
-		if (elem->has("scaleOrigin"))
-			setScaleOrigin(elem->get<Vector2f>("scaleOrigin"));
+		if (elem->has(sThemeProps.scaleOrigin))
+			setScaleOrigin(elem->get<Vector2f>(sThemeProps.scaleOrigin));
 	}
 
-	if(properties & ThemeFlags::Z_INDEX && elem->has("zIndex"))
-		setZIndex(elem->get<float>("zIndex"));
+	if(properties & ThemeFlags::Z_INDEX && elem->has(sThemeProps.zIndex))
+		setZIndex(elem->get<float>(sThemeProps.zIndex));
 	else
 		setZIndex(getDefaultZIndex());
 
 	if (properties & ThemeFlags::VISIBLE)
-		setVisible(!elem->has("visible") || elem->get<bool>("visible"));
+		setVisible(!elem->has(sThemeProps.visible) || elem->get<bool>(sThemeProps.visible));
 
-	if (elem->has("opacity"))
-		setOpacity((unsigned char)(elem->get<float>("opacity") * 255.0));
+	if (elem->has(sThemeProps.opacity))
+		setOpacity((unsigned char)(elem->get<float>(sThemeProps.opacity) * 255.0));
 
-	if (properties & POSITION && elem->has("offset"))
+	if (properties & POSITION && elem->has(sThemeProps.offset))
 	{
-		Vector2f denormalized = elem->get<Vector2f>("offset") * screenScale;
+		Vector2f denormalized = elem->get<Vector2f>(sThemeProps.offset) * screenScale;
 		setScreenOffset(denormalized);
 	}
 
-	if (properties & POSITION && elem->has("offsetX"))
+	if (properties & POSITION && elem->has(sThemeProps.offsetX))
 	{
-		float denormalized = elem->get<float>("offsetX") * screenScale.x();
+		float denormalized = elem->get<float>(sThemeProps.offsetX) * screenScale.x();
 		setScreenOffset(Vector2f(denormalized, mScreenOffset.y()));
 	}
 
-	if (properties & POSITION && elem->has("offsetY"))
+	if (properties & POSITION && elem->has(sThemeProps.offsetY))
 	{
-		float denormalized = elem->get<float>("offsetY") * scale.y();
+		float denormalized = elem->get<float>(sThemeProps.offsetY) * scale.y();
 		setScreenOffset(Vector2f(mScreenOffset.x(), denormalized));
 	}
 
-	if (properties & POSITION && elem->has("clipRect"))
+	if (properties & POSITION && elem->has(sThemeProps.clipRect))
 	{
-		Vector4f val = elem->get<Vector4f>("clipRect") * Vector4f(screenScale.x(), screenScale.y(), screenScale.x(), screenScale.y());
+		Vector4f val = elem->get<Vector4f>(sThemeProps.clipRect) * Vector4f(screenScale.x(), screenScale.y(), screenScale.x(), screenScale.y());
 		setClipRect(val);
 	}
 	else
@@ -136,6 +136,9 @@ public:
 	GuiComponent*	getChild(unsigned int i) const;
 	bool			isChild(GuiComponent* cmp);
 
+	// Approximation of the memory held by this component and its children (in bytes). Shared textures are counted by each user.
+	virtual size_t	getMemoryUsage();
+
 	// Theming
 	virtual void	applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties);
 
@@ -3,6 +3,7 @@
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 #include "Log.h"
+#include "MemoryAccounting.h"
 #include <assert.h>
 #include <thread>
 
@@ -109,7 +110,7 @@ void HttpReq::resetCookies()
 }
 
 HttpReq::HttpReq(const std::string& url, const std::string& outputFilename) 
-	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mFile(NULL)
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mFile(NULL), mContentSize(0)
 {
 	HttpReqOptions options;
 	options.outputFilename = outputFilename;	
@@ -117,7 +118,7 @@ HttpReq::HttpReq(const std::string& url, const std::string& outputFilename)
 }
 
 HttpReq::HttpReq(const std::string& url, HttpReqOptions* options)
-	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mFile(NULL)
+	: mStatus(REQ_IN_PROGRESS), mHandle(NULL), mFile(NULL), mContentSize(0)
 {
 	performRequest(url, options);
 }
@@ -351,6 +352,8 @@ HttpReq::~HttpReq()
 
 		curl_easy_cleanup(mHandle);
 	}
+
+	MemoryAccounting::remove(MemoryAccounting::HTTP_BUFFERS, mContentSize);
 }
 
 HttpReq::Status HttpReq::status()
@@ -566,6 +569,8 @@ size_t HttpReq::write_content(void* buff, size_t size, size_t nmemb, void* req_p
 	if (request->mFilePath.empty())
 	{
 		((HttpReq*)req_ptr)->mContent.write((char*)buff, size * nmemb);
+		request->mContentSize += size * nmemb;
+		MemoryAccounting::add(MemoryAccounting::HTTP_BUFFERS, size * nmemb);
 		return size * nmemb;
 	}
 
@@ -141,6 +141,7 @@ private:
 
 	// string steam mode
 	std::stringstream mContent;
+	size_t mContentSize; // Counted by MemoryAccounting
 
 	// file stream mode
 	std::string   mFilePath;
@@ -1,6 +1,7 @@
 #include "ImageIO.h"
 
 #include "Log.h"
+#include "Trace.h"
 #include <FreeImage.h>
 #include <string.h>
 #include "utils/FileSystemUtil.h"
@@ -20,6 +21,8 @@ unsigned char* ImageIO::loadFromMemoryRGBA32(const unsigned char * data, const s
 {
 	LOG(LogDebug) << "ImageIO::loadFromMemoryRGBA32";
 
+	TRACE_SCOPE("ImageIO::loadFromMemoryRGBA32");
+
 	if (baseSize != nullptr)
 		*baseSize = Vector2i(0, 0);
 
@@ -71,6 +71,8 @@ public:
 	void sendMouseClick(Window* window, int button);
 	InputConfig* getInputConfigByDevice(int deviceId);
 
+	void loadDefaultKBConfig();
+
 private:
 	InputManager();
 
@@ -80,7 +82,6 @@ private:
 	static const int DEADZONE = 23000;
 	static std::string getTemporaryConfigPath();
 
-	void loadDefaultKBConfig();
   	void loadDefaultGunConfig();
 
 	std::map<std::string, int> mJoysticksInitialValues;
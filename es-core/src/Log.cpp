@@ -4,8 +4,12 @@
 #include "utils/Platform.h"
 #include <iostream>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
 #include "Settings.h"
-#include <iomanip> 
+#include <ctime>
 #include <SDL_timer.h>
 #include "Paths.h"
 
@@ -13,18 +17,192 @@
 #include <Windows.h>
 #endif
 
-static std::mutex mLogLock;
+// Messages are queued in a bounded lock-free ring (many producers, one consumer) and written to the file by a dedicated thread
+#define LOG_QUEUE_SIZE		4096 // Must be a power of 2
+#define LOG_WRITER_DELAY	100  // ms between two writes when nothing requests one
+
+struct LogSlot
+{
+	std::atomic<size_t> sequence;
+	LogLevel level;
+	std::string message;
+};
+
+static LogSlot					sQueue[LOG_QUEUE_SIZE];
+static std::atomic<size_t>		sEnqueuePos(0);
+static std::atomic<size_t>		sDequeuePos(0);
+static std::atomic<unsigned int> sDroppedMessages(0); // Since the last write
+static std::atomic<unsigned int> sTotalDroppedMessages(0);
+static std::once_flag			sQueueInit;
+
+// Consumer side : the writer thread, flush() and close()
+static std::mutex				sWriterLock;
+static std::string				sWriterBuffer;
+static std::string				sConsoleBuffer;
+
+static std::thread*				sWriterThread = nullptr;
+static std::mutex				sWakeLock;
+static std::condition_variable	sWakeEvent;
+static bool						sWakeRequested = false;
+static bool						sWriterExit = false;
+static std::atomic<bool>		sWriterRunning(false); // Otherwise messages are written synchronously to the console only
 
 LogLevel Log::mReportingLevel = (LogLevel) -1;
-bool     Log::mDirty          = false;
 FILE*    Log::mFile           = NULL;
 
+// localtime is slow and not thread safe : the text is only formatted again when the second changes
+static const char* getTimestamp()
+{
+	static thread_local time_t cachedTime = 0;
+	static thread_local char cachedText[32] = { 0 };
+
+	time_t t = time(nullptr);
+	if (t != cachedTime)
+	{
+		cachedTime = t;
+
+		struct tm tm;
+#if WIN32
+		localtime_s(&tm, &t);
+#else
+		localtime_r(&t, &tm);
+#endif
+		strftime(cachedText, sizeof(cachedText), "%F %T\t", &tm);
+	}
+
+	return cachedText;
+}
+
+static bool enqueueMessage(LogLevel level, std::string&& message)
+{
+	size_t pos = sEnqueuePos.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		LogSlot& slot = sQueue[pos & (LOG_QUEUE_SIZE - 1)];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if (diff == 0)
+		{
+			if (sEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				slot.level = level;
+				slot.message = std::move(message);
+				slot.sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (diff < 0)
+			return false; // Full : the writer is late
+		else
+			pos = sEnqueuePos.load(std::memory_order_relaxed);
+	}
+}
+
+// Consumer side only
+static bool dequeueMessage(LogLevel& level, std::string& message)
+{
+	size_t pos = sDequeuePos.load(std::memory_order_relaxed);
+
+	LogSlot& slot = sQueue[pos & (LOG_QUEUE_SIZE - 1)];
+	if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+		return false;
+
+	level = slot.level;
+	message = std::move(slot.message);
+	slot.message.clear();
+	slot.sequence.store(pos + LOG_QUEUE_SIZE, std::memory_order_release);
+
+	sDequeuePos.store(pos + 1, std::memory_order_relaxed);
+	return true;
+}
+
+static void wakeWriter()
+{
+	{
+		std::unique_lock<std::mutex> lock(sWakeLock);
+		sWakeRequested = true;
+	}
+
+	sWakeEvent.notify_one();
+}
+
+// Errors always go to the console too, every message does when using --debug
+static bool isConsoleMessage(LogLevel level)
+{
+	return level == LogError || Log::getReportingLevel() >= LogDebug;
+}
+
+static void writeConsole(const std::string& text)
+{
+#if WIN32
+	OutputDebugStringA(text.c_str());
+#else
+	fwrite(text.data(), 1, text.size(), stderr);
+#endif
+}
+
+// Writes every queued message at once. sWriterLock must be held
+static void writeQueuedMessages(FILE* file)
+{
+	sWriterBuffer.clear();
+	sConsoleBuffer.clear();
+
+	unsigned int dropped = sDroppedMessages.exchange(0);
+	if (dropped > 0)
+		sWriterBuffer += std::string(getTimestamp()) + "WARNING\tLog : " + std::to_string(dropped) + " messages dropped\n";
+
+	LogLevel level;
+	std::string message;
+
+	while (dequeueMessage(level, message))
+	{
+		sWriterBuffer += message;
+
+		if (isConsoleMessage(level))
+			sConsoleBuffer += message;
+	}
+
+	if (file != nullptr && !sWriterBuffer.empty())
+	{
+		fwrite(sWriterBuffer.data(), 1, sWriterBuffer.size(), file);
+		fflush(file);
+	}
+
+	if (!sConsoleBuffer.empty())
+		writeConsole(sConsoleBuffer);
+}
+
+static void writerThread()
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(sWakeLock);
+			sWakeEvent.wait_for(lock, std::chrono::milliseconds(LOG_WRITER_DELAY), [] { return sWakeRequested || sWriterExit; });
+			sWakeRequested = false;
+
+			if (sWriterExit)
+				break;
+		}
+
+		Log::flush();
+	}
+}
+
 void Log::init()
 {		
 	mReportingLevel = (LogLevel)-1;
 
 	close();
 
+	std::call_once(sQueueInit, []
+	{
+		for (size_t i = 0; i < LOG_QUEUE_SIZE; i++)
+			sQueue[i].sequence.store(i, std::memory_order_relaxed);
+	});
+
 	LogLevel lvl = LogInfo;
 
 	if (Settings::getInstance()->getBool("Debug"))
@@ -56,20 +234,26 @@ void Log::init()
 	Utils::FileSystem::removeFile(bakPath);
 	Utils::FileSystem::renameFile(logPath, bakPath);
 
-	bool locked = mLogLock.try_lock();
+	{
+		std::unique_lock<std::mutex> lock(sWriterLock);
+		mFile = fopen(logPath.c_str(), "w");
+	}
 
-	mFile = fopen(logPath.c_str(), "w");
-	mDirty = false;
 	mReportingLevel = lvl;
 
-	if (locked)
-		mLogLock.unlock();
+	if (mFile != NULL)
+	{
+		sWriterExit = false;
+		sWriterRunning = true;
+		sWriterThread = new std::thread(&writerThread);
+	}
+	else
+		std::cerr << "Log : unable to open " << logPath << ", logging to the console only\n";
 }
 
 std::ostringstream& Log::get(LogLevel level)
 {
-	time_t t = time(nullptr);
-	mStream << std::put_time(localtime(&t), "%F %T\t");
+	mStream << getTimestamp();
 
 	switch (level)
 	{
@@ -94,60 +278,69 @@ std::ostringstream& Log::get(LogLevel level)
 
 void Log::flush()
 {
-	if (!mDirty)
-		return;
+	std::unique_lock<std::mutex> lock(sWriterLock);
+	writeQueuedMessages(mFile);
+}
 
-	if (mLogLock.try_lock())
+void Log::close()
+{
 	{
-		if (mFile != nullptr)
-			fflush(mFile);
+		std::unique_lock<std::mutex> lock(sWakeLock);
+		sWriterExit = true;
+	}
+
+	// Messages logged from now on are written synchronously
+	sWriterRunning = false;
+	sWakeEvent.notify_one();
 
-		mDirty = false;
-		mLogLock.unlock();
+	if (sWriterThread != nullptr)
+	{
+		sWriterThread->join();
+		delete sWriterThread;
+		sWriterThread = nullptr;
 	}
-}
 
-void Log::close()
-{
-	bool locked = mLogLock.try_lock();
+	std::unique_lock<std::mutex> lock(sWriterLock);
+
+	writeQueuedMessages(mFile);
 
 	if (mFile != NULL)
 	{
-		fflush(mFile);
 		fclose(mFile);
 		mFile = NULL;
 	}
+}
 
-	mDirty = false;
-	
-	if (locked)
-		mLogLock.unlock();
+unsigned int Log::getDroppedMessages()
+{
+	return sTotalDroppedMessages;
 }
 
 Log::~Log()
 {
-	bool locked = mLogLock.try_lock();
+	mStream << '\n';
 
-	if (mFile != NULL)
+	// No log file, or it's closed : nothing would write the queue
+	if (!sWriterRunning)
 	{
-		mStream << std::endl;
-		fprintf(mFile, "%s", mStream.str().c_str());
-		mDirty = true;
+		if (isConsoleMessage(mMessageLevel))
+			writeConsole(mStream.str());
+
+		return;
 	}
-	
-	// If it's an error, also print to console
-	// print all messages if using --debug
-	if (mMessageLevel == LogError || mReportingLevel >= LogDebug)
+
+	if (!enqueueMessage(mMessageLevel, mStream.str()))
 	{
-#if WIN32
-		OutputDebugStringA(mStream.str().c_str());
-#else
-		fprintf(stderr, "%s", mStream.str().c_str());
-#endif
+		sDroppedMessages++;
+		sTotalDroppedMessages++;
+		wakeWriter();
 	}
+	else if (mMessageLevel == LogError || sEnqueuePos - sDequeuePos > LOG_QUEUE_SIZE / 2)
+		wakeWriter(); // Don't wait for the next write
 
-	if (locked)
-		mLogLock.unlock();
+	// close() may have written the queue for the last time meanwhile
+	if (!sWriterRunning)
+		flush();
 }
 
 StopWatch::StopWatch(const std::string& elapsedMillisecondsMessage, LogLevel level)
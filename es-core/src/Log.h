@@ -20,15 +20,20 @@ public:
 	std::ostringstream& get(LogLevel level = LogInfo);
 
 	static inline LogLevel& getReportingLevel() { return mReportingLevel; }
-	static inline bool enabled() { return mFile != NULL; }
+	// Also true without a log file : errors still reach the console
+	static inline bool enabled() { return (int)mReportingLevel >= 0; }
 
+	// Messages are written to the file by a background thread : flush() writes the pending ones right away.
+	// Without a log file, or after close(), they are written synchronously to the console.
 	static void init();
 	static void flush();
 	static void close();
+
+	// Messages lost because the queue was full
+	static unsigned int getDroppedMessages();
 	
 private:
 	static LogLevel     mReportingLevel;
-	static bool         mDirty;
 	static FILE*        mFile;
 
 protected:
@@ -6,6 +6,14 @@
 #include <pugixml/src/pugixml.hpp>
 #include "utils/StringUtil.h"
 #include <string.h>
+#include <queue>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 MameNames* MameNames::sInstance = nullptr;
 
@@ -50,7 +58,287 @@ static bool hasFlag(ArcadeRomType& a, ArcadeRomType b)
 	return (ai & bi) == bi;
 }
 
+// mamenames.dat, see resources/compileGamesDb.py. Values are little endian.
+struct MameNamesDbHeader
+{
+	char			magic[4];
+	unsigned int	version;
+	unsigned int	arcadeRomsXmlSize;
+	unsigned int	gamesDbXmlSize;
+	unsigned int	romCount;
+	unsigned int	romOffset;
+	unsigned int	systemCount;
+	unsigned int	systemOffset;
+	unsigned int	gameCount;
+	unsigned int	gameOffset;
+	unsigned int	stringsOffset;
+	unsigned int	stringsSize;
+	unsigned long long arcadeRomsXmlTime;
+	unsigned long long gamesDbXmlTime;
+	unsigned long long arcadeRomsXmlHash;
+	unsigned long long gamesDbXmlHash;
+};
+
+struct MameNamesDbRom
+{
+	unsigned int	id;
+	unsigned int	displayName;
+	unsigned int	type;
+};
+
+struct MameNamesDbSystem
+{
+	unsigned int	name;
+	unsigned int	firstGame;
+	unsigned int	gameCount;
+};
+
+struct MameNamesDbGame
+{
+	unsigned int	name;
+	unsigned int	type;
+};
+
+#define MAMENAMES_DB_VERSION	2
+#define MAMENAMES_DB_NOSTRING	0xFFFFFFFF
+
 MameNames::MameNames()
+{
+	mDatabase = nullptr;
+	mDatabaseSize = 0;
+
+	if (!loadDatabase())
+		loadXml();
+
+	for (auto& matcher : mNonArcadeDeviceGames)
+		matcher.second.build();
+
+} // MameNames
+
+MameNames::~MameNames()
+{
+	unloadDatabase();
+
+} // ~MameNames
+
+// 64 bits FNV-1a of a file, as computed by compileGamesDb.py
+static bool getFileHash(const std::string& path, unsigned long long& hash)
+{
+#ifdef WIN32
+	FILE* file = _wfopen(WINSTRINGW(path).c_str(), L"rb");
+#else
+	FILE* file = fopen(path.c_str(), "rb");
+#endif
+	if (file == nullptr)
+		return false;
+
+	hash = 0xcbf29ce484222325ULL;
+
+	unsigned char buffer[65536];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		for (size_t i = 0; i < read; i++)
+		{
+			hash ^= buffer[i];
+			hash *= 0x100000001b3ULL;
+		}
+	}
+
+	fclose(file);
+	return true;
+}
+
+// A different size is outdated, the same size and time is up to date. The file is only hashed when the size matches but the time
+// doesn't, as installing the files may not keep their time.
+static bool isSameXmlFile(const std::string& path, unsigned int size, unsigned long long time, unsigned long long hash)
+{
+	if ((unsigned int)Utils::FileSystem::getFileSize(path) != size)
+		return false;
+
+	if ((unsigned long long)Utils::FileSystem::getFileModificationDate(path).getTime() == time)
+		return true;
+
+	unsigned long long fileHash;
+	return getFileHash(path, fileHash) && fileHash == hash;
+}
+
+static const char* getDbString(const unsigned char* db, const MameNamesDbHeader* header, unsigned int offset)
+{
+	if (offset >= header->stringsSize)
+		return "";
+
+	return (const char*)(db + header->stringsOffset + offset);
+}
+
+bool MameNames::loadDatabase()
+{
+	std::string path = ResourceManager::getInstance()->getResourcePath(":/mamenames.dat");
+	if (!Utils::FileSystem::exists(path))
+		return false;
+
+#ifdef WIN32
+	// No mapping on Windows : read the file at once, this still avoids the xml parsing
+	size_t size = (size_t)Utils::FileSystem::getFileSize(path);
+	FILE* file = _wfopen(WINSTRINGW(path).c_str(), L"rb");
+	if (file == nullptr)
+		return false;
+
+	unsigned char* data = new unsigned char[size];
+	if (fread(data, 1, size, file) != size)
+	{
+		delete[] data;
+		fclose(file);
+		return false;
+	}
+
+	fclose(file);
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	size_t size = (size_t)info.st_size;
+	void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED)
+		return false;
+
+	unsigned char* data = (unsigned char*)map;
+#endif
+
+	mDatabase = data;
+	mDatabaseSize = size;
+
+	// Check the tables are inside the file
+	auto header = (const MameNamesDbHeader*)mDatabase;
+
+	bool valid = 
+		mDatabaseSize >= sizeof(MameNamesDbHeader) &&
+		memcmp(header->magic, "ESMN", 4) == 0 &&
+		header->version == MAMENAMES_DB_VERSION &&
+		header->romOffset + (size_t)header->romCount * sizeof(MameNamesDbRom) <= mDatabaseSize &&
+		header->systemOffset + (size_t)header->systemCount * sizeof(MameNamesDbSystem) <= mDatabaseSize &&
+		header->gameOffset + (size_t)header->gameCount * sizeof(MameNamesDbGame) <= mDatabaseSize &&
+		header->stringsSize > 0 &&
+		header->stringsOffset + (size_t)header->stringsSize == mDatabaseSize &&
+		mDatabase[mDatabaseSize - 1] == 0;
+
+	if (!valid)
+	{
+		LOG(LogError) << "Invalid database file \"" << path << "\"";
+		unloadDatabase();
+		return false;
+	}
+
+	// The database must have been compiled from the xml files that would be loaded otherwise
+	std::string arcadeRomsPath = ResourceManager::getInstance()->getResourcePath(":/arcaderoms.xml");
+	std::string gamesDbPath = ResourceManager::getInstance()->getResourcePath(":/gamesdb.xml");
+
+	for (int i = 0; i < 2; i++)
+	{
+		const std::string& xmlPath = (i == 0 ? arcadeRomsPath : gamesDbPath);
+		if (!Utils::FileSystem::exists(xmlPath))
+			continue;
+
+		bool upToDate = (i == 0) ?
+			isSameXmlFile(xmlPath, header->arcadeRomsXmlSize, header->arcadeRomsXmlTime, header->arcadeRomsXmlHash) :
+			isSameXmlFile(xmlPath, header->gamesDbXmlSize, header->gamesDbXmlTime, header->gamesDbXmlHash);
+
+		if (!upToDate)
+		{
+			LOG(LogInfo) << "Database file \"" << path << "\" is outdated, using XML files";
+			unloadDatabase();
+			return false;
+		}
+	}
+
+	auto systems = (const MameNamesDbSystem*)(mDatabase + header->systemOffset);
+	auto games = (const MameNamesDbGame*)(mDatabase + header->gameOffset);
+
+	for (unsigned int i = 0; i < header->systemCount; i++)
+	{
+		if (systems[i].firstGame + (size_t)systems[i].gameCount > header->gameCount)
+			continue;
+
+		auto& matcher = mNonArcadeDeviceGames[getDbString(mDatabase, header, systems[i].name)];
+		for (unsigned int g = systems[i].firstGame; g < systems[i].firstGame + systems[i].gameCount; g++)
+			matcher.add(getDbString(mDatabase, header, games[g].name), games[g].type);
+	}
+
+	LOG(LogInfo) << "Loaded database file \"" << path << "\" (" << header->romCount << " roms)";
+	return true;
+}
+
+void MameNames::unloadDatabase()
+{
+	if (mDatabase == nullptr)
+		return;
+
+#ifdef WIN32
+	delete[] mDatabase;
+#else
+	munmap((void*)mDatabase, mDatabaseSize);
+#endif
+
+	mDatabase = nullptr;
+	mDatabaseSize = 0;
+}
+
+bool MameNames::findArcadeRom(const std::string& name, ArcadeRomType& type, std::string* displayName)
+{
+	if (mDatabase == nullptr)
+	{
+		auto it = mArcadeRoms.find(name);
+		if (it == mArcadeRoms.cend())
+			return false;
+
+		type = it->second.type;
+		if (displayName != nullptr)
+			*displayName = it->second.displayName;
+
+		return true;
+	}
+
+	// Roms are sorted by id
+	auto header = (const MameNamesDbHeader*)mDatabase;
+	auto roms = (const MameNamesDbRom*)(mDatabase + header->romOffset);
+
+	int low = 0;
+	int high = (int)header->romCount - 1;
+
+	while (low <= high)
+	{
+		int mid = low + (high - low) / 2;
+
+		int cmp = strcmp(getDbString(mDatabase, header, roms[mid].id), name.c_str());
+		if (cmp == 0)
+		{
+			type = (ArcadeRomType)roms[mid].type;
+			if (displayName != nullptr && roms[mid].displayName != MAMENAMES_DB_NOSTRING)
+				*displayName = getDbString(mDatabase, header, roms[mid].displayName);
+
+			return true;
+		}
+
+		if (cmp < 0)
+			low = mid + 1;
+		else
+			high = mid - 1;
+	}
+
+	return false;
+}
+
+void MameNames::loadXml()
 {
 	std::string xmlpath;
 
@@ -170,88 +458,40 @@ MameNames::MameNames()
 								spinnerGames.insert(gameName);
 						}
 
-						if (gunGames.size())
+						std::vector<std::pair<std::unordered_set<std::string>*, ArcadeRomType>> devices =
 						{
-							if (systemNames == "arcade")
-							{
-								for (auto game : gunGames)
-								{
-									auto it = mArcadeRoms.find(game);
-									if (it == mArcadeRoms.cend())
-									{
-										ArcadeRom rom;
-										rom.type |= ArcadeRomType::LIGHTGUN;
-										mArcadeRoms[game] = rom;
-									}
-									else 
-										it->second.type |= ArcadeRomType::LIGHTGUN;
-								}
-							}
-							else
-								mNonArcadeGunGames[Utils::String::trim(systemName)] = gunGames;
-						}
+							{ &gunGames, ArcadeRomType::LIGHTGUN },
+							{ &wheelGames, ArcadeRomType::WHEEL },
+							{ &trackballGames, ArcadeRomType::TRACKBALL },
+							{ &spinnerGames, ArcadeRomType::SPINNER }
+						};
 
-						if (wheelGames.size())
+						for (auto device : devices)
 						{
-							if (systemNames == "arcade")
-							{
-								for (auto game : wheelGames)
-								{
-									auto it = mArcadeRoms.find(game);
-									if (it == mArcadeRoms.cend())
-									{
-										ArcadeRom rom;
-										rom.type |= ArcadeRomType::WHEEL;
-										mArcadeRoms[game] = rom;
-									}
-									else
-										it->second.type |= ArcadeRomType::WHEEL;
-								}
-							}
-							else
-								mNonArcadeWheelGames[Utils::String::trim(systemName)] = wheelGames;
-						}
+							if (device.first->size() == 0)
+								continue;
 
-						if (trackballGames.size())
-						{
 							if (systemNames == "arcade")
 							{
-								for (auto game : trackballGames)
+								for (auto game : *device.first)
 								{
 									auto it = mArcadeRoms.find(game);
 									if (it == mArcadeRoms.cend())
 									{
 										ArcadeRom rom;
-										rom.type |= ArcadeRomType::TRACKBALL;
+										rom.type |= device.second;
 										mArcadeRoms[game] = rom;
 									}
 									else
-										it->second.type |= ArcadeRomType::TRACKBALL;
+										it->second.type |= device.second;
 								}
 							}
 							else
-								mNonArcadeTrackballGames[Utils::String::trim(systemName)] = trackballGames;
-						}
-
-						if (spinnerGames.size())
-						{
-							if (systemNames == "arcade")
 							{
-								for (auto game : spinnerGames)
-								{
-									auto it = mArcadeRoms.find(game);
-									if (it == mArcadeRoms.cend())
-									{
-										ArcadeRom rom;
-										rom.type |= ArcadeRomType::SPINNER;
-										mArcadeRoms[game] = rom;
-									}
-									else
-										it->second.type |= ArcadeRomType::SPINNER;
-								}
+								auto& matcher = mNonArcadeDeviceGames[Utils::String::trim(systemName)];
+								for (auto game : *device.first)
+									matcher.add(game, (unsigned int)device.second);
 							}
-							else
-								mNonArcadeSpinnerGames[Utils::String::trim(systemName)] = spinnerGames;
 						}
 					}	
 				}
@@ -263,18 +503,15 @@ MameNames::MameNames()
 			LOG(LogError) << "Error parsing XML file \"" << xmlpath << "\"!\n	" << result.description();
 	}
 	
-} // MameNames
-
-MameNames::~MameNames()
-{
-
-} // ~MameNames
+} // loadXml
 
 std::string MameNames::getRealName(const std::string& _mameName)
 {
-	auto it = mArcadeRoms.find(_mameName);
-	if (it != mArcadeRoms.cend() && !it->second.displayName.empty())
-		return it->second.displayName;
+	ArcadeRomType type;
+	std::string displayName;
+
+	if (findArcadeRom(_mameName, type, &displayName) && !displayName.empty())
+		return displayName;
 
 	return _mameName;
 
@@ -282,18 +519,18 @@ std::string MameNames::getRealName(const std::string& _mameName)
 
 const bool MameNames::isBiosOrDevice(const std::string& _biosName)
 {
-	auto it = mArcadeRoms.find(_biosName);
-	if (it != mArcadeRoms.cend())
-		return hasFlag(it->second.type, ArcadeRomType::BIOS) || hasFlag(it->second.type, ArcadeRomType::DEVICE);
+	ArcadeRomType type;
+	if (findArcadeRom(_biosName, type))
+		return hasFlag(type, ArcadeRomType::BIOS) || hasFlag(type, ArcadeRomType::DEVICE);
 
 	return false;	
 }
 
 const bool MameNames::isVertical(const std::string& _nameName)
 {
-	auto it = mArcadeRoms.find(_nameName);
-	if (it != mArcadeRoms.cend())
-		return hasFlag(it->second.type, ArcadeRomType::VERTICAL);
+	ArcadeRomType type;
+	if (findArcadeRom(_nameName, type))
+		return hasFlag(type, ArcadeRomType::VERTICAL);
 
 	return false;
 }
@@ -318,118 +555,127 @@ static std::string getIndexedName(const std::string& name)
 	return result;
 }
 
-const bool MameNames::isLightgun(const std::string& _nameName, const std::string& systemName, bool isArcade)
+static const unsigned int DEVICE_FLAGS = (unsigned int)ArcadeRomType::LIGHTGUN | (unsigned int)ArcadeRomType::WHEEL | (unsigned int)ArcadeRomType::TRACKBALL | (unsigned int)ArcadeRomType::SPINNER;
+
+unsigned int MameNames::getDeviceFlags(const std::string& _nameName, const std::string& systemName, bool isArcade)
 {
 	if (isArcade)
 	{
-		auto it = mArcadeRoms.find(_nameName);
-		if (it != mArcadeRoms.cend())
-			return hasFlag(it->second.type, ArcadeRomType::LIGHTGUN);
+		ArcadeRomType type;
+		if (findArcadeRom(_nameName, type))
+			return (unsigned int)type & DEVICE_FLAGS;
 
-		return false;
+		return 0;
 	}
 
-	auto it = mNonArcadeGunGames.find(systemName);
-	if (it == mNonArcadeGunGames.cend())
-		return false;
+	auto it = mNonArcadeDeviceGames.find(systemName);
+	if (it == mNonArcadeDeviceGames.cend())
+		return 0;
 
-	std::string indexedName = getIndexedName(_nameName);
+	// Exact matches are also found by the automaton
+	return it->second.match(getIndexedName(_nameName)) & DEVICE_FLAGS;
+}
 
-	// Exact match ?
-	if (it->second.find(indexedName) != it->second.cend())
-		return true;
+const bool MameNames::isLightgun(const std::string& _nameName, const std::string& systemName, bool isArcade)
+{
+	return (getDeviceFlags(_nameName, systemName, isArcade) & (unsigned int)ArcadeRomType::LIGHTGUN) != 0;
+}
 
-	// name contains ?
-	for (auto gameName : it->second)
-		if (indexedName.find(gameName) != std::string::npos)
-			return true;
+const bool MameNames::isWheel(const std::string& _nameName, const std::string& systemName, bool isArcade)
+{
+	return (getDeviceFlags(_nameName, systemName, isArcade) & (unsigned int)ArcadeRomType::WHEEL) != 0;
+}
 
-	return false;
+const bool MameNames::isTrackball(const std::string& _nameName, const std::string& systemName, bool isArcade)
+{
+	return (getDeviceFlags(_nameName, systemName, isArcade) & (unsigned int)ArcadeRomType::TRACKBALL) != 0;
 }
 
-const bool MameNames::isWheel(const std::string& _nameName, const std::string& systemName, bool isArcade)
+const bool MameNames::isSpinner(const std::string& _nameName, const std::string& systemName, bool isArcade)
 {
-	if (isArcade)
-	{
-		auto it = mArcadeRoms.find(_nameName);
-		if (it != mArcadeRoms.cend())
-			return hasFlag(it->second.type, ArcadeRomType::WHEEL);
+	return (getDeviceFlags(_nameName, systemName, isArcade) & (unsigned int)ArcadeRomType::SPINNER) != 0;
+}
 
-		return false;
-	}
+DeviceNameMatcher::DeviceNameMatcher()
+{
+	mNodes.push_back(Node());
+	mAllFlags = 0;
+}
 
-	auto it = mNonArcadeWheelGames.find(systemName);
-	if (it == mNonArcadeWheelGames.cend())
-		return false;
+void DeviceNameMatcher::add(const std::string& name, unsigned int flags)
+{
+	if (name.empty())
+		return;
 
-	std::string indexedName = getIndexedName(_nameName);
+	int node = 0;
 
-	// Exact match ?
-	if (it->second.find(indexedName) != it->second.cend())
-		return true;
+	for (auto c : name)
+	{
+		auto it = mNodes[node].next.find(c);
+		if (it != mNodes[node].next.cend())
+		{
+			node = it->second;
+			continue;
+		}
 
-	// name contains ?
-	for (auto gameName : it->second)
-		if (indexedName.find(gameName) != std::string::npos)
-			return true;
+		int child = (int)mNodes.size();
+		mNodes.push_back(Node());
+		mNodes[node].next[c] = child;
+		node = child;
+	}
 
-	return false;
+	mNodes[node].flags |= flags;
+	mAllFlags |= flags;
 }
 
-const bool MameNames::isTrackball(const std::string& _nameName, const std::string& systemName, bool isArcade)
+// Compute failure links, breadth first, and merge the flags of the names which are suffixes of others
+void DeviceNameMatcher::build()
 {
-	if (isArcade)
-	{
-		auto it = mArcadeRoms.find(_nameName);
-		if (it != mArcadeRoms.cend())
-			return hasFlag(it->second.type, ArcadeRomType::TRACKBALL);
+	std::queue<int> queue;
 
-		return false;
+	for (auto child : mNodes[0].next)
+	{
+		mNodes[child.second].fail = 0;
+		queue.push(child.second);
 	}
 
-	auto it = mNonArcadeTrackballGames.find(systemName);
-	if (it == mNonArcadeTrackballGames.cend())
-		return false;
-
-	std::string indexedName = getIndexedName(_nameName);
+	while (!queue.empty())
+	{
+		int node = queue.front();
+		queue.pop();
 
-	// Exact match ?
-	if (it->second.find(indexedName) != it->second.cend())
-		return true;
+		for (auto child : mNodes[node].next)
+		{
+			int fail = mNodes[node].fail;
+			while (fail != 0 && mNodes[fail].next.find(child.first) == mNodes[fail].next.cend())
+				fail = mNodes[fail].fail;
 
-	// name contains ?
-	for (auto gameName : it->second)
-		if (indexedName.find(gameName) != std::string::npos)
-			return true;
+			auto it = mNodes[fail].next.find(child.first);
+			mNodes[child.second].fail = (it != mNodes[fail].next.cend() && it->second != child.second) ? it->second : 0;
+			mNodes[child.second].flags |= mNodes[mNodes[child.second].fail].flags;
 
-	return false;
+			queue.push(child.second);
+		}
+	}
 }
 
-const bool MameNames::isSpinner(const std::string& _nameName, const std::string& systemName, bool isArcade)
+unsigned int DeviceNameMatcher::match(const std::string& indexedName) const
 {
-	if (isArcade)
-	{
-		auto it = mArcadeRoms.find(_nameName);
-		if (it != mArcadeRoms.cend())
-			return hasFlag(it->second.type, ArcadeRomType::SPINNER);
+	unsigned int flags = 0;
+	int node = 0;
 
-		return false;
-	}
-
-	auto it = mNonArcadeSpinnerGames.find(systemName);
-	if (it == mNonArcadeSpinnerGames.cend())
-		return false;
-
-	std::string indexedName = getIndexedName(_nameName);
+	for (auto c : indexedName)
+	{
+		while (node != 0 && mNodes[node].next.find(c) == mNodes[node].next.cend())
+			node = mNodes[node].fail;
 
-	// Exact match ?
-	if (it->second.find(indexedName) != it->second.cend())
-		return true;
+		auto it = mNodes[node].next.find(c);
+		node = (it != mNodes[node].next.cend()) ? it->second : 0;
 
-	// name contains ?
-	for (auto gameName : it->second)
-		if (indexedName.find(gameName) != std::string::npos)
-			return true;
+		flags |= mNodes[node].flags;
+		if (flags == mAllFlags)
+			break;
+	}
 
-	return false;
+	return flags;
 }
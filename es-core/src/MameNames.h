@@ -30,6 +30,30 @@ struct ArcadeRom
 	ArcadeRomType type;
 };
 
+// Aho-Corasick automaton : finds every known game name contained in a rom name in a single pass
+class DeviceNameMatcher
+{
+public:
+	DeviceNameMatcher();
+
+	void			add(const std::string& name, unsigned int flags);
+	void			build();
+	unsigned int	match(const std::string& indexedName) const;
+
+private:
+	struct Node
+	{
+		Node() { fail = 0; flags = 0; }
+
+		std::map<char, int> next;
+		int fail;
+		unsigned int flags;
+	};
+
+	std::vector<Node> mNodes;
+	unsigned int mAllFlags;
+};
+
 class MameNames
 {
 public:
@@ -44,18 +68,27 @@ public:
     	const bool		  isTrackball(const std::string& _nameName, const std::string& systemName, bool isArcade);
       	const bool		  isSpinner(const std::string& _nameName, const std::string& systemName, bool isArcade);
 
+	// Combination of ArcadeRomType::LIGHTGUN, WHEEL, TRACKBALL & SPINNER
+	unsigned int	  getDeviceFlags(const std::string& _nameName, const std::string& systemName, bool isArcade);
+
 private:
 	 MameNames();
 	~MameNames();
 
 	static MameNames* sInstance;
 
+	void			loadXml();
+	bool			loadDatabase();
+	void			unloadDatabase();
+	bool			findArcadeRom(const std::string& name, ArcadeRomType& type, std::string* displayName = nullptr);
+
+	// Read-only precompiled database (mamenames.dat), mArcadeRoms is only used when loading the xml files
+	const unsigned char* mDatabase;
+	size_t				 mDatabaseSize;
+
 	std::unordered_map<std::string, ArcadeRom> mArcadeRoms;
 
-	std::unordered_map<std::string, std::unordered_set<std::string>> mNonArcadeGunGames;
-  	std::unordered_map<std::string, std::unordered_set<std::string>> mNonArcadeWheelGames;
-    	std::unordered_map<std::string, std::unordered_set<std::string>> mNonArcadeTrackballGames;
-      	std::unordered_map<std::string, std::unordered_set<std::string>> mNonArcadeSpinnerGames;
+	std::unordered_map<std::string, DeviceNameMatcher> mNonArcadeDeviceGames;
 
 }; // MameNames
 
@@ -0,0 +1,182 @@
+#include "MemoryAccounting.h"
+#include "resources/TextureResource.h"
+#include "resources/Font.h"
+#include "Settings.h"
+#include "Trace.h"
+#include <atomic>
+#include <sstream>
+#include <iomanip>
+
+#if WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Minimal delay between two measures of the providers (us)
+#define MEASURE_INTERVAL 1000000
+// Delay between two measures when nothing asks for them (us)
+#define SAMPLE_INTERVAL 10000000
+
+namespace MemoryAccounting
+{
+	static const char* sCategoryNames[CATEGORY_COUNT] = { "texturesRam", "texturesVram", "glyphAtlases", "textCaches", "library", "themes", "gamelistViews", "httpBuffers" };
+
+	static std::atomic<int64_t>			sCurrent[CATEGORY_COUNT];
+	static std::atomic<int64_t>			sPeak[CATEGORY_COUNT];
+	static std::atomic<int64_t>			sTotal(0);
+	static std::atomic<int64_t>			sTotalPeak(0);
+	static std::atomic<int64_t>			sHeapInUse(-1);
+
+	// UI thread
+	static std::function<int64_t()>		sProviders[CATEGORY_COUNT];
+	static int64_t						sLastMeasure = 0;
+
+	static void updatePeak(std::atomic<int64_t>& peak, int64_t value)
+	{
+		int64_t current = peak;
+		while (value > current && !peak.compare_exchange_weak(current, value));
+	}
+
+	const char* getCategoryName(Category category)
+	{
+		return sCategoryNames[category];
+	}
+
+	void add(Category category, int64_t bytes)
+	{
+		updatePeak(sPeak[category], sCurrent[category] += bytes);
+	}
+
+	void remove(Category category, int64_t bytes)
+	{
+		sCurrent[category] -= bytes;
+	}
+
+	void setProvider(Category category, const std::function<int64_t()>& provider)
+	{
+		sProviders[category] = provider;
+	}
+
+	static void measure(Category category, int64_t value)
+	{
+		sCurrent[category] = value;
+		updatePeak(sPeak[category], value);
+	}
+
+	void update(bool force)
+	{
+		int64_t now = Trace::getTime();
+		if (!force && sLastMeasure != 0 && now - sLastMeasure < MEASURE_INTERVAL)
+			return;
+
+		sLastMeasure = now;
+
+		TRACE_SCOPE("MemoryAccounting::update");
+
+		measure(TEXTURES_RAM, (int64_t)TextureResource::getTotalRAMUsage());
+		measure(TEXTURES_VRAM, (int64_t)TextureResource::getTotalMemUsage(false));
+		measure(GLYPH_ATLASES, (int64_t)Font::getTotalMemUsage());
+
+		for (int i = 0; i < CATEGORY_COUNT; i++)
+			if (sProviders[i])
+				measure((Category)i, sProviders[i]());
+
+		int64_t total = 0;
+		for (int i = 0; i < CATEGORY_COUNT; i++)
+			total += sCurrent[i];
+
+		sTotal = total;
+		updatePeak(sTotalPeak, total);
+
+		sHeapInUse = getHeapInUse();
+	}
+
+	bool isSampleDue()
+	{
+		return sLastMeasure == 0 || Trace::getTime() - sLastMeasure >= SAMPLE_INTERVAL;
+	}
+
+	Stats getStats()
+	{
+		Stats stats;
+
+		for (int i = 0; i < CATEGORY_COUNT; i++)
+		{
+			stats.categories[i].current = sCurrent[i];
+			stats.categories[i].peak = sPeak[i];
+		}
+
+		stats.total.current = sTotal;
+		stats.total.peak = sTotalPeak;
+		stats.heapInUse = sHeapInUse;
+		stats.peakRss = getPeakRss();
+		stats.maxVRAM = (int64_t)Settings::getInstance()->getInt("MaxVRAM") * 1024 * 1024;
+		return stats;
+	}
+
+	void resetPeaks()
+	{
+		for (int i = 0; i < CATEGORY_COUNT; i++)
+			sPeak[i] = (int64_t)sCurrent[i];
+
+		sTotalPeak = (int64_t)sTotal;
+	}
+
+	std::string getOverlayText()
+	{
+		auto stats = getStats();
+		auto mb = [](int64_t bytes) { return bytes / 1024.0f / 1024.0f; };
+
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(1);
+		ss << "Mem (MB) Tex VRAM: " << mb(stats.categories[TEXTURES_VRAM].current) << "/" << mb(stats.maxVRAM) << " RAM: " << mb(stats.categories[TEXTURES_RAM].current);
+		ss << " Fonts: " << mb(stats.categories[GLYPH_ATLASES].current) << " Texts: " << mb(stats.categories[TEXT_CACHES].current);
+		ss << "\nLibrary: " << mb(stats.categories[LIBRARY].current) << " Themes: " << mb(stats.categories[THEMES].current) << " Views: " << mb(stats.categories[GAMELIST_VIEWS].current);
+		ss << " Http: " << mb(stats.categories[HTTP_BUFFERS].current) << " Total: " << mb(stats.total.current) << " (peak " << mb(stats.total.peak) << ")";
+
+		if (stats.heapInUse >= 0)
+			ss << " Heap: " << mb(stats.heapInUse);
+
+		return ss.str();
+	}
+
+	int64_t getHeapInUse() // Bytes
+	{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+		struct mallinfo2 info = mallinfo2();
+		return (int64_t)(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+		struct mallinfo info = mallinfo();
+		return (int64_t)(unsigned int)info.uordblks + (int64_t)(unsigned int)info.hblkhd;
+#else
+		return -1;
+#endif
+	}
+
+	int64_t getPeakRss() // KB
+	{
+#if WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return (int64_t)(counters.PeakWorkingSetSize / 1024);
+
+		return -1;
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0)
+			return -1;
+
+#if defined(__APPLE__)
+		return (int64_t)usage.ru_maxrss / 1024;
+#else
+		return (int64_t)usage.ru_maxrss;
+#endif
+#endif
+	}
+} // MemoryAccounting::
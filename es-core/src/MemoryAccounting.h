@@ -0,0 +1,73 @@
+#pragma once
+#ifndef ES_CORE_MEMORY_ACCOUNTING_H
+#define ES_CORE_MEMORY_ACCOUNTING_H
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+// Bytes used by category, with their high-water marks. Categories are either counted by their owners (any thread),
+// or measured by a provider which is called on the UI thread by update(). Measures happen about once per second while the framerate
+// overlay is shown, otherwise every 10 seconds on an idle frame, and when the api asks for them. Peaks of measured categories only cover these measures.
+namespace MemoryAccounting
+{
+	enum Category
+	{
+		TEXTURES_RAM = 0,	// Decoded pixels not uploaded yet
+		TEXTURES_VRAM = 1,
+		GLYPH_ATLASES = 2,	// Font textures, their copy in RAM and the font files
+		TEXT_CACHES = 3,	// Vertices of the prepared texts (counted)
+		LIBRARY = 4,		// Games, folders and metadata (estimated)
+		THEMES = 5,			// Theme elements and properties (estimated)
+		GAMELIST_VIEWS = 6,
+		HTTP_BUFFERS = 7,	// Downloaded contents kept in memory, e.g. by the scrapers (counted)
+
+		CATEGORY_COUNT = 8
+	};
+
+	const char* getCategoryName(Category category);
+
+	// Counted categories
+	void add(Category category, int64_t bytes);
+	void remove(Category category, int64_t bytes);
+
+	// Measured categories. The texture and font categories are measured by es-core itself
+	void setProvider(Category category, const std::function<int64_t()>& provider);
+
+	// UI thread : measures again if the last measure is older than a second, or if forced
+	void update(bool force = false);
+
+	// True when the last measure is older than the sampling interval used without the overlay
+	bool isSampleDue();
+
+	struct CategoryStats
+	{
+		int64_t current;
+		int64_t peak;
+	};
+
+	struct Stats
+	{
+		CategoryStats categories[CATEGORY_COUNT];
+		CategoryStats total;
+
+		int64_t heapInUse; // Bytes, -1 if unknown
+		int64_t peakRss; // KB, -1 if unknown
+		int64_t maxVRAM; // "MaxVRAM" setting, bytes
+	};
+
+	// Any thread : values of the last update, and peaks since the last reset
+	Stats getStats();
+	void resetPeaks();
+
+	// Short summary for the framerate overlay
+	std::string getOverlayText();
+
+	int64_t getHeapInUse();
+	int64_t getPeakRss();
+
+	// Heap bytes of a string, for estimations : short strings are stored inline
+	inline size_t getStringSize(const std::string& value) { return value.capacity() > 15 ? value.capacity() + 1 : 0; }
+} // MemoryAccounting::
+
+#endif // ES_CORE_MEMORY_ACCOUNTING_H
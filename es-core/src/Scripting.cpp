@@ -1,5 +1,6 @@
 #include "Scripting.h"
 #include "Log.h"
+#include "Trace.h"
 #include "utils/Platform.h"
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
@@ -8,87 +9,159 @@
 #include <thread>
 #include <set>
 #include <map>
+#include <list>
 #include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Directories which can't be watched are listed again after this delay (ms)
+#define SCRIPT_CACHE_TTL 5000
 
 using namespace Utils::Platform;
 
 namespace Scripting
 {
-#if WIN32
+    struct ScriptEvent
+    {
+        std::string name;
+        std::vector<std::string> args;
+    };
+
+    // High frequency events : only the latest pending one is delivered
+    static std::set<std::string> _coalescedEvents = { "game-selected", "system-selected" };
+
+    static std::set<std::string> _supportedExtensions = { ".exe", ".cmd", ".bat", ".ps1", ".sh", ".py" };
+
     static std::thread*                 mScriptQueueThread = nullptr;
-    static std::list<std::string>       mScriptQueue;
+    static std::list<ScriptEvent>       mScriptQueue;
     static std::mutex			        mScriptQueueLock;
     static std::condition_variable		mScriptQueueEvent;
+    static std::condition_variable		mScriptQueueIdleEvent;
+    static bool                         mScriptQueueBusy = false;
     static bool                         mExitScriptQueue = false;
+    static ScriptEvent                  mLastEvent;
 
-    static void executeCommandsThread()
-    {
-        while (true)
-        {
-            // Wait for an event to say there is something in the queue
-            std::unique_lock<std::mutex> lock(mScriptQueueLock);
-            mScriptQueueEvent.wait(lock, []() { return mExitScriptQueue || !mScriptQueue.empty(); });
+    static std::map<int, EventHandler>  mSubscribers;
+    static std::mutex                   mSubscribersLock;
+    static int                          mNextSubscriberId = 1;
 
-            if (mExitScriptQueue)
-                break;
+    // Script directory listing cache
+    struct ScriptDirectory
+    {
+        std::vector<std::string> scripts;
+        std::chrono::steady_clock::time_point time;
+        bool watched;
+    };
 
-            if (!mScriptQueue.empty())
-            {
-                auto command = mScriptQueue.front();
-                mScriptQueue.pop_front();
+    static std::map<std::string, ScriptDirectory> mScriptCache;
+    static std::mutex                   mScriptCacheLock;
 
-                lock.unlock();
-                std::this_thread::yield();
+#if defined(__linux__)
+    static int                          mInotifyFd = -1;
 
-                ProcessStartInfo psi;
-                psi.command = command;
-                psi.waitForExit = false;
-                psi.showWindow = false;
-                psi.run();
+    static bool watchDirectory(const std::string& path)
+    {
+        if (mInotifyFd < 0)
+            mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
 
-                LOG(LogDebug) << "  executing: " << command;
+        if (mInotifyFd < 0)
+            return false;
 
-                std::this_thread::yield();
-            }
-        }
+        // Adding an existing watch again returns the same descriptor
+        return inotify_add_watch(mInotifyFd, path.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF) >= 0;
     }
 
-    static std::string _lastCommand;
-
-    static void pushCommand(const std::string& command)
+    // Drop the cache if anything changed in a watched directory
+    static void checkWatchedDirectories()
     {
-        std::unique_lock<std::mutex> lock(mScriptQueueLock);
-
-        if (command == _lastCommand)
+        if (mInotifyFd < 0)
             return;
 
-        _lastCommand = command;
+        bool changed = false;
 
-        if (mScriptQueueThread == nullptr)
-            mScriptQueueThread = new std::thread(&executeCommandsThread);
+        char buffer[4096];
+        while (read(mInotifyFd, buffer, sizeof(buffer)) > 0)
+            changed = true;
 
-        mScriptQueue.push_back(command);
-        mScriptQueueEvent.notify_one();
+        if (changed)
+        {
+            LOG(LogDebug) << "Scripting : script directories changed";
+            mScriptCache.clear();
+        }
     }
+#else
+    static bool watchDirectory(const std::string& path) { return false; }
+    static void checkWatchedDirectories() { }
 #endif
 
-    void exitScriptingEngine()
+    // eventDirectory : every file is a script for this event, otherwise only files with a supported extension are kept
+    static std::vector<std::string> getScripts(const std::string& dir, bool eventDirectory)
     {
+        std::unique_lock<std::mutex> lock(mScriptCacheLock);
+
+        checkWatchedDirectories();
+
+        auto it = mScriptCache.find(dir);
+        if (it != mScriptCache.cend())
+        {
+            if (it->second.watched || std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - it->second.time).count() < SCRIPT_CACHE_TTL)
+                return it->second.scripts;
+        }
+
+        ScriptDirectory entry;
+        entry.time = std::chrono::steady_clock::now();
+
+        if (Utils::FileSystem::exists(dir))
+        {
+            entry.watched = watchDirectory(dir);
+
+            if (eventDirectory)
+            {
+                for (auto script : Utils::FileSystem::getDirContent(dir))
+                {
 #if WIN32
-        std::unique_lock<std::mutex> lock(mScriptQueueLock);
-        mExitScriptQueue = true;
-        mScriptQueueEvent.notify_one();
+                    auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script));
+                    if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
+                        continue;
 #endif
+                    entry.scripts.push_back(script);
+                }
+            }
+            else
+            {
+                for (auto script : Utils::FileSystem::getDirectoryFiles(dir))
+                {
+                    if (script.directory)
+                        continue;
+
+                    auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script.path));
+                    if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
+                        continue;
+
+                    entry.scripts.push_back(script.path);
+                }
+            }
+        }
+        else // The directory can be created later : watch its parent
+            entry.watched = watchDirectory(Utils::FileSystem::getParent(dir));
+
+        mScriptCache[dir] = entry;
+        return entry.scripts;
     }
 
-    static void executeScript(const std::string& script, const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    static void executeScript(const std::string& script, const std::string& eventName, const std::vector<std::string>& args)
     {
         std::string command = script;
 
         if (!eventName.empty())
             command += " " + eventName;
 
-        for (auto arg : { arg1, arg2, arg3 })
+        for (auto arg : args)
         {
             if (arg.empty())
                 break;
@@ -99,67 +172,48 @@ namespace Scripting
 #if WIN32
         if (Utils::FileSystem::getExtension(script) == ".ps1")
             command = "powershell " + command;
+#endif
 
-        if (eventName == "quit")
-        {
-            LOG(LogDebug) << "  executing: " << command;
-
-            ProcessStartInfo psi;
-            psi.command = command;
-            psi.waitForExit = true;
-            psi.showWindow = false;
-            psi.run();
-        }
-        else
-        {
-            LOG(LogDebug) << "  queuing: " << command;
-
-            // Start using a thread to avoid lags
-            pushCommand(command);
-        }
-#else            
-        LOG(LogDebug) << "  executing: " << script;
+        LOG(LogDebug) << "  executing: " << command;
 
         ProcessStartInfo psi;
         psi.command = command;
         psi.waitForExit = (eventName == "quit");
         psi.showWindow = false;
+#ifndef WIN32
         // Don't clobber game logs when running scripts
         psi.stderrFilename = "es_script_stderr.log";
         psi.stdoutFilename = "es_script_stdout.log";
-        psi.run();
 #endif
+        psi.run();
     }
 
-    static std::set<std::string> _supportedExtensions = { ".exe", ".cmd", ".bat", ".ps1", ".sh", ".py" };
-
-    void fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    static void dispatchEvent(const ScriptEvent& evt)
     {
-        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2 << " " << arg3;
+        // In-process listeners
+        std::map<int, EventHandler> subscribers;
+
+        {
+            std::unique_lock<std::mutex> lock(mSubscribersLock);
+            subscribers = mSubscribers;
+        }
+
+        for (auto subscriber : subscribers)
+            subscriber.second(evt.name, evt.args);
 
         // Process splitted paths scripts
         std::vector<std::string> scriptDirList =
         {
-            Paths::getUserEmulationStationPath() + "/scripts/" + eventName,
-            Paths::getEmulationStationPath() + "/scripts/" + eventName,
+            Paths::getUserEmulationStationPath() + "/scripts/" + evt.name,
+            Paths::getEmulationStationPath() + "/scripts/" + evt.name,
 #ifndef WIN32
-            "/var/run/emulationstation/scripts/" + eventName
+            "/var/run/emulationstation/scripts/" + evt.name
 #endif
         };
 
         for (auto dir : VectorHelper::distinct(scriptDirList, [](auto x) { return x; }))
-        {
-            auto scripts = Utils::FileSystem::getDirContent(dir);
-            for (auto script : scripts)
-            {
-#if WIN32
-                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script));
-                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
-                    continue;
-#endif
-                executeScript(script, "", arg1, arg2, arg3);
-            }
-        }
+            for (auto script : getScripts(dir, true))
+                executeScript(script, "", evt.args);
 
         // Process single scripts. This type of scripts are called with the event name as 1st arg
         std::vector<std::string> paths =
@@ -172,21 +226,154 @@ namespace Scripting
         };
 
         for (auto dir : VectorHelper::distinct(paths, [](auto x) { return x; }))
+            for (auto script : getScripts(dir, false))
+                executeScript(script, evt.name, evt.args);
+    }
+
+    static void executeEventsThread()
+    {
+        while (true)
         {
-            if (!Utils::FileSystem::exists(dir))
-                continue;
+            // Wait for an event to say there is something in the queue
+            std::unique_lock<std::mutex> lock(mScriptQueueLock);
+            mScriptQueueEvent.wait(lock, []() { return mExitScriptQueue || !mScriptQueue.empty(); });
 
-            for (auto script : Utils::FileSystem::getDirectoryFiles(dir))
-            {
-                if (script.directory)
-                    continue;
+            if (mExitScriptQueue)
+                break;
+
+            auto evt = mScriptQueue.front();
+            mScriptQueue.pop_front();
+            mScriptQueueBusy = true;
+
+            lock.unlock();
+
+            dispatchEvent(evt);
 
-                auto ext = Utils::String::toLower(Utils::FileSystem::getExtension(script.path));
-                if (_supportedExtensions.find(ext) == _supportedExtensions.cend())
-                    continue;
+            lock.lock();
+            mScriptQueueBusy = false;
 
-                executeScript(script.path, eventName, arg1, arg2, arg3);
+            if (mScriptQueue.empty())
+                mScriptQueueIdleEvent.notify_all();
+        }
+
+        std::unique_lock<std::mutex> lock(mScriptQueueLock);
+        mScriptQueueBusy = false;
+        mScriptQueueIdleEvent.notify_all();
+    }
+
+    static void pushEvent(const ScriptEvent& evt)
+    {
+        std::unique_lock<std::mutex> lock(mScriptQueueLock);
+
+        // The queue is stopped : run it now rather than losing it
+        if (mExitScriptQueue)
+        {
+            lock.unlock();
+            dispatchEvent(evt);
+            return;
+        }
+
+        if (_coalescedEvents.find(evt.name) != _coalescedEvents.cend())
+        {
+            if (mLastEvent.name == evt.name && mLastEvent.args == evt.args)
+                return;
+
+            // Replace the pending one : keep it at the end of the queue to preserve ordering with other events
+            for (auto it = mScriptQueue.begin(); it != mScriptQueue.end(); )
+            {
+                if (it->name == evt.name)
+                    it = mScriptQueue.erase(it);
+                else
+                    ++it;
             }
         }
+
+        mLastEvent = evt;
+
+        if (mScriptQueueThread == nullptr)
+            mScriptQueueThread = new std::thread(&executeEventsThread);
+
+        mScriptQueue.push_back(evt);
+        mScriptQueueEvent.notify_one();
+    }
+
+    // Wait until every queued event has been delivered
+    static void flushEvents()
+    {
+        std::unique_lock<std::mutex> lock(mScriptQueueLock);
+        if (mScriptQueueThread == nullptr)
+            return;
+
+        mScriptQueueIdleEvent.wait(lock, []() { return mExitScriptQueue || (mScriptQueue.empty() && !mScriptQueueBusy); });
+    }
+
+    void exitScriptingEngine()
+    {
+        std::thread* thread = nullptr;
+
+        // Queued events still run before the thread stops
+        flushEvents();
+
+        {
+            std::unique_lock<std::mutex> lock(mScriptQueueLock);
+            mExitScriptQueue = true;
+            mScriptQueueEvent.notify_one();
+
+            thread = mScriptQueueThread;
+            mScriptQueueThread = nullptr;
+        }
+
+        if (thread != nullptr)
+        {
+            thread->join();
+            delete thread;
+        }
+
+#if defined(__linux__)
+        std::unique_lock<std::mutex> lock(mScriptCacheLock);
+        if (mInotifyFd >= 0)
+        {
+            close(mInotifyFd);
+            mInotifyFd = -1;
+        }
+
+        mScriptCache.clear();
+#endif
+    }
+
+    int subscribe(const EventHandler& handler)
+    {
+        std::unique_lock<std::mutex> lock(mSubscribersLock);
+
+        int id = mNextSubscriberId++;
+        mSubscribers[id] = handler;
+        return id;
+    }
+
+    void unsubscribe(int subscriptionId)
+    {
+        std::unique_lock<std::mutex> lock(mSubscribersLock);
+        mSubscribers.erase(subscriptionId);
+    }
+
+    void fireEvent(const std::string& eventName, const std::string& arg1, const std::string& arg2, const std::string& arg3)
+    {
+        TRACE_SCOPE_DETAIL("Scripting::fireEvent", eventName);
+
+        LOG(LogDebug) << "fireEvent: " << eventName << " " << arg1 << " " << arg2 << " " << arg3;
+
+        ScriptEvent evt;
+        evt.name = eventName;
+        evt.args = { arg1, arg2, arg3 };
+
+        if (eventName == "quit" || eventName == "reboot" || eventName == "shutdown")
+        {
+            // These scripts must have run before ES exits : deliver pending events, then wait for the scripts
+            flushEvents();
+            dispatchEvent(evt);
+            return;
+        }
+
+        pushEvent(evt);
     }
 } // Scripting::
@@ -3,11 +3,19 @@
 #define ES_CORE_SCRIPTING_H
 
 #include <string>
+#include <vector>
+#include <functional>
 
 namespace Scripting
 {
+	// In-process event listener. Called from the scripting thread, except for the "quit", "reboot" and "shutdown" events which are delivered synchronously.
+	typedef std::function<void(const std::string& eventName, const std::vector<std::string>& args)> EventHandler;
+
 	void fireEvent(const std::string& eventName, const std::string& arg1="", const std::string& arg2="", const std::string& arg3="");
 	void exitScriptingEngine();
+
+	int  subscribe(const EventHandler& handler);
+	void unsubscribe(int subscriptionId);
 } // Scripting::
 
 #endif //ES_CORE_SCRIPTING_H
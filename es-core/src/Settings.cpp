@@ -164,6 +164,7 @@ void Settings::setDefaults()
 	mStringMap["HiddenSystems"] = "";
 
 	mBoolMap["PublicWebAccess"] = false;	
+	mIntMap["HttpServerPort"] = 1234;
 	mBoolMap["FirstJoystickOnly"] = false;
     mBoolMap["EnableSounds"] = false;
 	mBoolMap["ShowHelpPrompts"] = true;
@@ -316,11 +317,18 @@ void Settings::setDefaults()
 	mStringMap["DefaultGridSize"] = "";
 
 	mBoolMap["ThreadedLoading"] = true;
+	mBoolMap["LazySystemLoading"] = false;
+	mBoolMap["Trace"] = false; // Record hot path timings from startup, see Trace.h
+	mIntMap["FrameStallThreshold"] = 50; // ms, frames longer than this are reported as stalls, see FrameTimings.h
 	mBoolMap["AsyncImages"] = true;
 	mBoolMap["PreloadUI"] = false;
+	mIntMap["GameListViewsMaxCount"] = 0; // 0 = unlimited
+	mIntMap["GameListViewsMaxMemory"] = 0; // Mb, 0 = unlimited
 	mBoolMap["PreloadMedias"] = Settings::_PreloadMedias;
 	mBoolMap["OptimizeVRAM"] = true;
+	mBoolMap["FontTextureCopy"] = true; // Keep font textures in RAM too, to restore them without FreeType after a game, see Font.h
 	mBoolMap["OptimizeVideo"] = true;
+	mStringMap["VideoPixelFormat"] = "";
 
 	mBoolMap["ShowFilenames"] = false;
 
@@ -497,7 +505,8 @@ void Settings::loadFile()
 		if (it->second == false)
 			mStringMap["UseCustomCollectionsSystemEx"] = "false";
 
-		mBoolMap.erase(it);
+		// Not erased : handles may point at it. false is never saved.
+		it->second = false;
 	}
 
 	mWasChanged = false;
@@ -530,6 +539,8 @@ SETTINGS_GETSET(float, mFloatMap, getFloat, setFloat, 0.0f);
 
 std::string Settings::getString(const std::string& name)
 {
+	std::unique_lock<std::mutex> lock(mStringLock);
+
 	auto it = mStringMap.find(name);
 	if (it == mStringMap.cend())
 		return mEmptyString;
@@ -544,7 +555,10 @@ bool Settings::setString(const std::string& name, const std::string& value)
 		if (value == "" && mStringMap.count(name) == 0)
 			return false;
 
-		mStringMap[name] = value;
+		{
+			std::unique_lock<std::mutex> lock(mStringLock);
+			mStringMap[name] = value;
+		}
 
 		if (std::find(settings_dont_save.cbegin(), settings_dont_save.cend(), name) == settings_dont_save.cend())
 			mWasChanged = true;
@@ -556,6 +570,30 @@ bool Settings::setString(const std::string& name, const std::string& value)
 	return false;
 }
 
+#define SETTINGS_HANDLE(type, mapName, handleMethodName, defaultValue) SettingHandle<type> Settings::handleMethodName(const std::string& name) \
+{ \
+	auto it = mapName.find(name); \
+	if (it == mapName.end()) \
+		it = mapName.insert(std::pair<std::string, type>(name, defaultValue)).first; \
+\
+	return SettingHandle<type>(&it->second); \
+}
+
+SETTINGS_HANDLE(bool, mBoolMap, getBoolHandle, false);
+SETTINGS_HANDLE(int, mIntMap, getIntHandle, 0);
+SETTINGS_HANDLE(float, mFloatMap, getFloatHandle, 0.0f);
+
+SettingHandle<std::string> Settings::getStringHandle(const std::string& name)
+{
+	std::unique_lock<std::mutex> lock(mStringLock);
+
+	auto it = mStringMap.find(name);
+	if (it == mStringMap.end())
+		it = mStringMap.insert(std::pair<std::string, std::string>(name, mEmptyString)).first;
+
+	return SettingHandle<std::string>(&it->second, &mStringLock);
+}
+
 SettingType Settings::getSettingType(const std::string& name)
 {
 	if (mStringMap.find(name) != mStringMap.cend())
@@ -5,13 +5,46 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <mutex>
 #include "utils/Delegate.h"
 
-// Non-cached settings macros
-#define DEFINE_BOOL_SETTING(XX) static bool XX() { return Settings::getInstance()->getBool(#XX); }; static bool set##XX(bool val) { return Settings::getInstance()->setBool(#XX, val); };
-#define DEFINE_INT_SETTING(XX) static int XX() { return Settings::getInstance()->getInt(#XX); }; static bool set##XX(int val) { return Settings::getInstance()->setInt(#XX, val); };
-#define DEFINE_FLOAT_SETTING(XX) static float XX() { return Settings::getInstance()->getFloat(#XX); }; static bool set##XX(float val) { return Settings::getInstance()->setFloat(#XX, val); };
-#define DEFINE_STRING_SETTING(XX) static std::string XX() { return Settings::getInstance()->getString(#XX); }; static bool set##XX(const std::string& val) { return Settings::getInstance()->setString(#XX, val); };
+// Typed handle on a setting, resolved once : reading it is a pointer dereference, without any lookup.
+// Values are never removed from the settings maps, so a handle stays valid and always reads the current value.
+template<typename T>
+class SettingHandle
+{
+public:
+	SettingHandle() : mValue(nullptr) { }
+	explicit SettingHandle(const T* value) : mValue(value) { }
+
+	inline const T& get() const { return *mValue; }
+	inline operator const T&() const { return *mValue; }
+
+private:
+	const T* mValue;
+};
+
+// setString can assign the value while it's read from another thread : strings are copied under the lock of the string settings
+template<>
+class SettingHandle<std::string>
+{
+public:
+	SettingHandle() : mValue(nullptr), mLock(nullptr) { }
+	SettingHandle(const std::string* value, std::mutex* lock) : mValue(value), mLock(lock) { }
+
+	inline std::string get() const { std::unique_lock<std::mutex> lock(*mLock); return *mValue; }
+	inline operator std::string() const { return get(); }
+
+private:
+	const std::string* mValue;
+	std::mutex* mLock;
+};
+
+// Shortcut settings macros, reading through a handle resolved at the first call
+#define DEFINE_BOOL_SETTING(XX) static bool XX() { static SettingHandle<bool> handle = Settings::getInstance()->getBoolHandle(#XX); return handle; }; static bool set##XX(bool val) { return Settings::getInstance()->setBool(#XX, val); };
+#define DEFINE_INT_SETTING(XX) static int XX() { static SettingHandle<int> handle = Settings::getInstance()->getIntHandle(#XX); return handle; }; static bool set##XX(int val) { return Settings::getInstance()->setInt(#XX, val); };
+#define DEFINE_FLOAT_SETTING(XX) static float XX() { static SettingHandle<float> handle = Settings::getInstance()->getFloatHandle(#XX); return handle; }; static bool set##XX(float val) { return Settings::getInstance()->setFloat(#XX, val); };
+#define DEFINE_STRING_SETTING(XX) static std::string XX() { static SettingHandle<std::string> handle = Settings::getInstance()->getStringHandle(#XX); return handle; }; static bool set##XX(const std::string& val) { return Settings::getInstance()->setString(#XX, val); };
 
 // Cached static settings macros
 #define DECLARE_STATIC_BOOL_SETTING(XX) \
@@ -74,6 +107,12 @@ public:
 	bool setFloat(const std::string& name, float value);
 	bool setString(const std::string& name, const std::string& value);
 
+	// Unknown settings are created with an empty value
+	SettingHandle<bool> getBoolHandle(const std::string& name);
+	SettingHandle<int> getIntHandle(const std::string& name);
+	SettingHandle<float> getFloatHandle(const std::string& name);
+	SettingHandle<std::string> getStringHandle(const std::string& name);
+
 	std::map<std::string, std::string>& getStringMap() { return mStringMap; }
 
 	// Cached settings using static fields. They must be implemented using IMPLEMENT_STATIC_xx_SETTING & updated with UPDATE_STATIC_xxx_SETTING
@@ -105,6 +144,7 @@ public:
 	DEFINE_BOOL_SETTING(RemoveMultiDiskContent)	
 	DEFINE_BOOL_SETTING(ParseGamelistOnly)
 	DEFINE_BOOL_SETTING(ThreadedLoading)
+	DEFINE_BOOL_SETTING(LazySystemLoading)
 	DEFINE_BOOL_SETTING(CheevosCheckIndexesAtStart)
 	DEFINE_BOOL_SETTING(NetPlayCheckIndexesAtStart)
 	DEFINE_BOOL_SETTING(NetPlayAutomaticallyCreateLobby)
@@ -118,6 +158,7 @@ public:
 	DEFINE_STRING_SETTING(GameTransitionStyle)		
 	DEFINE_STRING_SETTING(PowerSaverMode)		
 	DEFINE_INT_SETTING(RecentlyScrappedFilter)
+	DEFINE_INT_SETTING(FrameStallThreshold)
 
 	static Delegate<ISettingsChangedEvent> settingChanged;
 
@@ -133,6 +174,7 @@ private:
 	std::map<std::string, int> mIntMap;
 	std::map<std::string, float> mFloatMap;
 	std::map<std::string, std::string> mStringMap;
+	std::mutex mStringLock; // String values read by handles, getString and setString
 
 	bool mWasChanged;
 
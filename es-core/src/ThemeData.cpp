@@ -24,8 +24,13 @@
 #include "LocaleES.h"
 #include "anim/ThemeStoryboard.h"
 #include "Paths.h"
+#include "MemoryAccounting.h"
 #include "utils/HtmlColor.h"
 #include "utils/VectorEx.h"
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
 
 std::set<std::string> ThemeData::sSupportedItemTemplate { "imagegrid", "carousel", "gamecarousel", "textlist" };
 std::set<std::string> ThemeData::sSupportedViews        { "system", "basic", "detailed", "grid", "video", "gamecarousel", "menu", "screen", "splash" };
@@ -661,6 +666,133 @@ std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>> The
 std::shared_ptr<ThemeData::ThemeMenu> ThemeData::mMenuTheme;
 ThemeData* ThemeData::mDefaultTheme = nullptr;
 
+// Parsed theme files, shared by every system using them. A document is parsed again if the file's size or date changed.
+// Cached documents are read by several loading threads at once : they are never modified once published.
+struct ThemeDocument
+{
+	std::shared_ptr<const pugi::xml_document> document;
+	pugi::xml_parse_result result;
+	unsigned long long size;
+	time_t modified;
+};
+
+static std::map<std::string, ThemeDocument> sThemeDocuments;
+static std::mutex sThemeDocumentsLock;
+
+// Per game overrides are only kept for the latest games, oldest first
+#define MAX_PER_GAME_DOCUMENTS 16
+static std::deque<std::string> sPerGameDocuments;
+
+static std::atomic<int> sThemeDocumentsParsed(0);
+static std::atomic<int> sThemeDocumentsReused(0);
+static std::atomic<int> sThemesLoaded(0);
+static std::atomic<long long> sThemesLoadTime(0); // microseconds, cumulated over loading threads
+
+// Documents are shared and must not be modified while themes are parsed : the includes of a <subset> element get their subset attributes once, here,
+// and the "animate" alias of imagegrid is renamed.
+static void prepareThemeDocument(pugi::xml_node& parent)
+{
+	for (pugi::xml_node node = parent.first_child(); node; node = node.next_sibling())
+	{
+		if (node.type() != pugi::node_element)
+			continue;
+
+		if (strcmp(node.name(), "animate") == 0 && strcmp(parent.name(), "imagegrid") == 0)
+			node.set_name("animateSelection");
+
+		if (strcmp(node.name(), "subset") == 0)
+		{
+			const std::string name = node.attribute("name").as_string();
+			const std::string displayName = node.attribute("displayName").as_string();
+			const std::string appliesTo = node.attribute("appliesTo").as_string();
+
+			for (pugi::xml_node include = node.child("include"); include; include = include.next_sibling("include"))
+			{
+				include.remove_attribute("subset");
+				include.append_attribute("subset") = name.c_str();
+
+				if (!appliesTo.empty())
+				{
+					include.remove_attribute("appliesTo");
+					include.append_attribute("appliesTo") = appliesTo.c_str();
+				}
+
+				// Placeholders are resolved by parseSubset
+				if (!displayName.empty())
+				{
+					include.remove_attribute("subSetDisplayName");
+					include.append_attribute("subSetDisplayName") = displayName.c_str();
+				}
+			}
+		}
+
+		prepareThemeDocument(node);
+	}
+}
+
+std::shared_ptr<const pugi::xml_document> ThemeData::loadThemeDocument(const std::string& path, pugi::xml_parse_result& result, bool perGame)
+{
+	unsigned long long size = Utils::FileSystem::getFileSize(path);
+	time_t modified = Utils::FileSystem::getFileModificationDate(path).getTime();
+
+	{
+		std::unique_lock<std::mutex> lock(sThemeDocumentsLock);
+
+		auto it = sThemeDocuments.find(path);
+		if (it != sThemeDocuments.cend() && it->second.size == size && it->second.modified == modified)
+		{
+			sThemeDocumentsReused++;
+			result = it->second.result;
+			return it->second.document;
+		}
+	}
+
+	auto document = std::make_shared<pugi::xml_document>();
+	result = document->load_file(WINSTRINGW(path).c_str());
+	if (result)
+		prepareThemeDocument(*document);
+
+	sThemeDocumentsParsed++;
+
+	ThemeDocument entry;
+	entry.document = document;
+	entry.result = result;
+	entry.size = size;
+	entry.modified = modified;
+
+	std::unique_lock<std::mutex> lock(sThemeDocumentsLock);
+	sThemeDocuments[path] = entry;
+
+	if (perGame && std::find(sPerGameDocuments.cbegin(), sPerGameDocuments.cend(), path) == sPerGameDocuments.cend())
+	{
+		sPerGameDocuments.push_back(path);
+		if (sPerGameDocuments.size() > MAX_PER_GAME_DOCUMENTS)
+		{
+			sThemeDocuments.erase(sPerGameDocuments.front());
+			sPerGameDocuments.pop_front();
+		}
+	}
+
+	return document;
+}
+
+void ThemeData::clearThemeCache()
+{
+	if (sThemesLoaded > 0)
+	{
+		LOG(LogInfo) << "Loaded " << sThemesLoaded << " themes in " << (sThemesLoadTime / 1000) << "ms (" << sThemeDocumentsParsed << " files parsed, " << sThemeDocumentsReused << " reused)";
+
+		sThemesLoaded = 0;
+		sThemesLoadTime = 0;
+		sThemeDocumentsParsed = 0;
+		sThemeDocumentsReused = 0;
+	}
+
+	std::unique_lock<std::mutex> lock(sThemeDocumentsLock);
+	sThemeDocuments.clear();
+	sPerGameDocuments.clear();
+}
+
 #define MINIMUM_THEME_FORMAT_VERSION 3
 #define CURRENT_THEME_FORMAT_VERSION 6
 
@@ -716,6 +848,8 @@ void ThemeData::loadFile(const std::string& system, const std::map<std::string,
 	if (fromFile && !Utils::FileSystem::exists(path))
 		throw error << "File does not exist!";
 	
+	auto startTime = std::chrono::steady_clock::now();
+
 	mVersion = 0;
 	mViews.clear();
 
@@ -765,12 +899,25 @@ void ThemeData::loadFile(const std::string& system, const std::map<std::string,
 			mEvaluatorVariables[var.first] = var.second;		
 	}
 
-	pugi::xml_document doc;
-	pugi::xml_parse_result res = fromFile ? doc.load_file(WINSTRINGW(path).c_str()) : doc.load_string(path.c_str());
+	pugi::xml_parse_result res;
+	std::shared_ptr<const pugi::xml_document> doc;
+
+	if (fromFile)
+		doc = loadThemeDocument(path, res);
+	else
+	{
+		auto document = std::make_shared<pugi::xml_document>();
+		res = document->load_string(path.c_str());
+		if (res)
+			prepareThemeDocument(*document);
+
+		doc = document;
+	}
+
 	if(!res)
 		throw error << "XML parsing error: \n    " << res.description();
 
-	pugi::xml_node root = doc.child("theme");
+	pugi::xml_node root = doc->child("theme");
 	if(!root)
 		throw error << "Missing <theme> tag!";
 
@@ -791,12 +938,12 @@ void ThemeData::loadFile(const std::string& system, const std::map<std::string,
 		auto systemView = mViews.find("system");
 		if (systemView != mViews.cend())
 		{
-			auto systemcarousel = systemView->second.elements.find("systemcarousel");
-			if (systemcarousel != systemView->second.elements.cend())
+			auto systemcarousel = systemView->second.findElement("systemcarousel");
+			if (systemcarousel != nullptr)
 			{
-				auto defaultTransition = systemcarousel->second.properties.find("defaultTransition");
-				if (defaultTransition == systemcarousel->second.properties.cend() || defaultTransition->second.s == "instant")
-					systemcarousel->second.properties["defaultTransition"] = std::string("fade & slide");
+				auto defaultTransition = systemcarousel->properties.find("defaultTransition");
+				if (defaultTransition == systemcarousel->properties.cend() || defaultTransition->second.s == "instant")
+					systemcarousel->properties["defaultTransition"] = std::string("fade & slide");
 			}
 		}
 	}
@@ -806,6 +953,9 @@ void ThemeData::loadFile(const std::string& system, const std::map<std::string,
 		mMenuTheme = nullptr;
 		mDefaultTheme = this;
 	}
+
+	sThemesLoaded++;
+	sThemesLoadTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
 }
 
 const std::shared_ptr<ThemeData::ThemeMenu>& ThemeData::getMenuTheme()
@@ -1398,29 +1548,9 @@ void ThemeData::parseSubsetElement(const pugi::xml_node& root)
 	if (!parseFilterAttributes(root))
 		return;
 
-	const std::string name = root.attribute("name").as_string();
-	const std::string displayName = resolvePlaceholders(root.attribute("displayName").as_string());
-	const std::string appliesTo = root.attribute("appliesTo").as_string();
-
+	// The subset attributes have been copied to the includes by prepareThemeDocument
 	for (pugi::xml_node node = root.child("include"); node; node = node.next_sibling("include"))
-	{
-		node.remove_attribute("subset");
-		node.append_attribute("subset") = name.c_str();
-
-		if (!appliesTo.empty())
-		{
-			node.remove_attribute("appliesTo");
-			node.append_attribute("appliesTo") = appliesTo.c_str();
-		}
-
-		if (!displayName.empty())
-		{
-			node.remove_attribute("subSetDisplayName");
-			node.append_attribute("subSetDisplayName") = displayName.c_str();
-		}
-
 		parseInclude(node);
-	}
 }
 
 void ThemeData::parseViews(const pugi::xml_node& root)
@@ -1451,13 +1581,7 @@ void ThemeData::parseCustomViewBaseClass(const pugi::xml_node& root, ThemeView&
 		parseCustomViewBaseClass(root, view, baseView.baseType);
 
 	for (auto& element : baseView.elements)
-	{
-		view.elements.erase(element.first);			
-		view.elements.insert(std::pair<std::string, ThemeElement>(element.first, element.second));
-
-		if (std::find(view.orderedKeys.cbegin(), view.orderedKeys.cend(), element.first) == view.orderedKeys.cend())
-			view.orderedKeys.push_back(element.first);
-	}	
+		view.getOrAddElement(element.first) = element.second;
 }
 
 void ThemeData::parseCustomView(const pugi::xml_node& node, const pugi::xml_node& root)
@@ -1562,11 +1686,7 @@ void ThemeData::parseView(const pugi::xml_node& root, ThemeView& view, bool over
 			prevOff = nameAttr.find_first_not_of(delim, off);
 			off = nameAttr.find_first_of(delim, prevOff);
 
-			parseElement(node, elemTypeIt->second,
-				view.elements.insert(std::pair<std::string, ThemeElement>(elemKey, ThemeElement())).first->second, view, overwriteElements);
-
-			if (std::find(view.orderedKeys.cbegin(), view.orderedKeys.cend(), elemKey) == view.orderedKeys.cend())
-				view.orderedKeys.push_back(elemKey);
+			parseElement(node, elemTypeIt->second, view.getOrAddElement(elemKey), view, overwriteElements);
 		}		
 	}
 }
@@ -1846,17 +1966,18 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 	{
 		std::string imports = Utils::String::toLower(root.attribute("importProperties").as_string());
 
-		auto importIt = view.elements.find(imports);
-		if (importIt != view.elements.cend())
+		// Both live in the view's elements : importing the element into itself would insert while iterating
+		const ThemeElement* importElement = view.findElement(imports);
+		if (importElement != nullptr && importElement != &element)
 		{
-			for (auto prop : importIt->second.properties)
+			for (auto prop : importElement->properties)
 			{
 				auto typeIt = typeMap.find(prop.first);
 				if (typeIt != typeMap.cend())
 					element.properties[prop.first] = prop.second;
 			}
 
-			for (auto sb : importIt->second.mStoryBoards)
+			for (auto sb : importElement->mStoryBoards)
 				element.mStoryBoards[sb.first] = new ThemeStoryboard(*sb.second);
 		}
 	}
@@ -1959,8 +2080,6 @@ void ThemeData::parseElement(const pugi::xml_node& root, const std::map<std::str
 			// Exception for menuIcons that can be extended
 			if (element.type == "menuIcons")
 				type = PATH;
-			else if (name == "animate" && std::string(root.name()) == "imagegrid")
-				node.set_name("animateSelection");
 			else if (element.type == "shader" || element.type == "screenshader" || element.type == "menuShader" || element.type == "fadeShader")
 			{
 				// Child properties of shaders are to be added dynamically. They can't be described here as they are used for uniforms arguments
@@ -2089,17 +2208,17 @@ const ThemeData::ThemeElement* ThemeData::getElement(const std::string& view, co
 	if(viewIt == mViews.cend())
 		return NULL; // not found
 
-	auto elemIt = viewIt->second.elements.find(element);
-	if(elemIt == viewIt->second.elements.cend()) return NULL;
+	const ThemeElement* elem = viewIt->second.findElement(element);
+	if(elem == nullptr) return NULL;
 
-	if(elemIt->second.type != expectedType && !expectedType.empty())
+	if(elem->type != expectedType && !expectedType.empty())
 	{
 		LOG(LogWarning) << " requested mismatched theme type for [" << view << "." << element << "] - expected \"" 
-			<< expectedType << "\", got \"" << elemIt->second.type << "\"";
+			<< expectedType << "\", got \"" << elem->type << "\"";
 		return NULL;
 	}
 
-	return &elemIt->second;
+	return elem;
 }
 
 const std::vector<std::string> ThemeData::getElementNames(const std::string& view, const std::string& expectedType) const
@@ -2192,9 +2311,9 @@ std::vector<GuiComponent*> ThemeData::makeExtras(const std::shared_ptr<ThemeData
 	if(viewIt == theme->mViews.cend())
 		return comps;
 	
-	for(auto it = viewIt->second.orderedKeys.cbegin(); it != viewIt->second.orderedKeys.cend(); it++)
+	for(auto it = viewIt->second.elements.begin(); it != viewIt->second.elements.end(); it++)
 	{
-		ThemeElement& elem = viewIt->second.elements.at(*it);
+		ThemeElement& elem = it->second;
 		if(elem.extra)
 		{			
 			if (type != ExtraImportType::ALL_EXTRAS)
@@ -2222,9 +2341,9 @@ std::vector<GuiComponent*> ThemeData::makeExtras(const std::shared_ptr<ThemeData
 			GuiComponent* comp = createExtraComponent(window, elem, forceLoad);
 			if (comp != nullptr)
 			{
-				comp->setTag((*it).c_str());
+				comp->setTag(it->first.c_str());
 				comp->setDefaultZIndex(10);
-				comp->applyTheme(theme, view, *it, ThemeFlags::ALL);
+				comp->applyTheme(theme, view, it->first, ThemeFlags::ALL);
 				comps.push_back(comp);
 			}
 		}
@@ -2513,6 +2632,22 @@ std::vector<std::pair<std::string, std::string>> ThemeData::getViewsOfTheme()
 	return ret;
 }
 
+size_t ThemeData::getMemoryUsage() const
+{
+	size_t size = sizeof(ThemeData) + mViews.capacity() * sizeof(std::pair<std::string, ThemeView>);
+
+	for (auto& view : mViews)
+	{
+		size += MemoryAccounting::getStringSize(view.first);
+
+		size += view.second.elements.capacity() * sizeof(std::pair<std::string, ThemeElement>) + view.second.getIndexMemoryUsage();
+		for (auto& element : view.second.elements)
+			size += MemoryAccounting::getStringSize(element.first) + element.second.getMemoryUsage();
+	}
+
+	return size;
+}
+
 std::vector<Subset> ThemeData::getSubSet(const std::vector<Subset>& subsets, const std::string& subset)
 {
 	std::vector<Subset> ret;
@@ -2585,6 +2720,23 @@ ThemeData::ThemeElement::ThemeElement(const ThemeElement& src)
 		mStoryBoards[sb.first] = new ThemeStoryboard(*sb.second);
 }
 
+ThemeData::ThemeElement::ThemeElement(ThemeElement&& src) noexcept : extra(src.extra), type(std::move(src.type)),
+	mStoryBoards(std::move(src.mStoryBoards)), children(std::move(src.children)), properties(std::move(src.properties))
+{
+	src.mStoryBoards.clear();
+}
+
+ThemeData::ThemeElement& ThemeData::ThemeElement::operator=(ThemeElement src)
+{
+	// src owns the previous storyboards now, and deletes them
+	std::swap(extra, src.extra);
+	std::swap(type, src.type);
+	std::swap(mStoryBoards, src.mStoryBoards);
+	std::swap(children, src.children);
+	std::swap(properties, src.properties);
+	return *this;
+}
+
 ThemeData::ThemeElement::~ThemeElement()
 {
 	for (auto sb : mStoryBoards)
@@ -2593,6 +2745,271 @@ ThemeData::ThemeElement::~ThemeElement()
 	mStoryBoards.clear();
 }
 
+size_t ThemeData::ThemeElement::getMemoryUsage() const
+{
+	size_t size = MemoryAccounting::getStringSize(type) + properties.getMemoryUsage();
+
+	size += children.capacity() * sizeof(std::pair<std::string, ThemeElement>);
+	for (auto& child : children)
+		size += MemoryAccounting::getStringSize(child.first) + child.second.getMemoryUsage();
+
+	return size;
+}
+
+// Name registry : an append-only open addressing table so lookups never lock.
+// Property names are seeded from sElementMap, then grow with "_binding" variants and shader uniforms; element names come from the themes.
+struct ThemeRegisteredName
+{
+	std::string name;
+	size_t hash;
+	ThemeData::ThemeElement::PropertyId id;
+};
+
+class ThemeNameRegistry
+{
+public:
+	// maxNames must be a power of two, the table keeps half of its slots free
+	ThemeNameRegistry(const char* kind, int maxNames) : mKind(kind), mMaxNames(maxNames), mSlotCount(maxNames * 2), mCount(0)
+	{
+		mSlots = new std::atomic<const ThemeRegisteredName*>[mSlotCount]();
+		mNames = new std::atomic<const ThemeRegisteredName*>[mMaxNames]();
+	}
+
+	bool find(const std::string& name, ThemeData::ThemeElement::PropertyId& id) const
+	{
+		size_t slot;
+		const ThemeRegisteredName* entry = find(name, std::hash<std::string>()(name), slot);
+		if (entry == nullptr)
+			return false;
+
+		id = entry->id;
+		return true;
+	}
+
+	ThemeData::ThemeElement::PropertyId get(const std::string& name)
+	{
+		size_t hash = std::hash<std::string>()(name);
+
+		size_t slot;
+		const ThemeRegisteredName* entry = find(name, hash, slot);
+		if (entry != nullptr)
+			return entry->id;
+
+		std::unique_lock<std::mutex> lock(mLock);
+
+		// Another thread may have registered it meanwhile
+		entry = find(name, hash, slot);
+		if (entry != nullptr)
+			return entry->id;
+
+		int count = mCount;
+		if (count >= mMaxNames)
+		{
+			LOG(LogError) << "ThemeData : too many " << mKind << " names, ignoring " << name;
+			return ThemeData::ThemeElement::INVALID_PROPERTY_ID;
+		}
+
+		ThemeRegisteredName* newEntry = new ThemeRegisteredName();
+		newEntry->name = name;
+		newEntry->hash = hash;
+		newEntry->id = (ThemeData::ThemeElement::PropertyId)count;
+
+		// Publish the name before the slot, so that readers finding the id can always resolve it
+		mNames[count].store(newEntry, std::memory_order_release);
+		mCount++;
+		mSlots[slot].store(newEntry, std::memory_order_release);
+
+		return newEntry->id;
+	}
+
+	const std::string& getName(ThemeData::ThemeElement::PropertyId id) const
+	{
+		static const std::string empty;
+
+		const ThemeRegisteredName* entry = id < mMaxNames ? mNames[id].load(std::memory_order_acquire) : nullptr;
+		return entry == nullptr ? empty : entry->name;
+	}
+
+private:
+	const ThemeRegisteredName* find(const std::string& name, size_t hash, size_t& slot) const
+	{
+		for (slot = hash & (mSlotCount - 1); ; slot = (slot + 1) & (mSlotCount - 1))
+		{
+			const ThemeRegisteredName* entry = mSlots[slot].load(std::memory_order_acquire);
+			if (entry == nullptr || (entry->hash == hash && entry->name == name))
+				return entry;
+		}
+	}
+
+	const char* mKind;
+	int mMaxNames;
+	size_t mSlotCount;
+
+	std::atomic<const ThemeRegisteredName*>* mSlots;
+	std::atomic<const ThemeRegisteredName*>* mNames;
+	int mCount;
+	std::mutex mLock;
+};
+
+// Created on first use, once the static schema is built : its properties get the ids 0..n-1, in the names' order
+static ThemeNameRegistry& getPropertyNameRegistry(const std::map<std::string, std::map<std::string, ThemeData::ElementPropertyType>>& schema)
+{
+	static ThemeNameRegistry* registry = [&schema]()
+	{
+		std::set<std::string> names;
+		for (auto& type : schema)
+			for (auto& prop : type.second)
+				names.insert(prop.first);
+
+		auto ret = new ThemeNameRegistry("property", 8192);
+		for (auto& name : names)
+			ret->get(name);
+
+		return ret;
+	}();
+
+	return *registry;
+}
+
+static ThemeNameRegistry& getElementNameRegistry()
+{
+	static ThemeNameRegistry* registry = new ThemeNameRegistry("element", 16384);
+	return *registry;
+}
+
+bool ThemeData::ThemeElement::findPropertyId(const std::string& name, PropertyId& id)
+{
+	return getPropertyNameRegistry(sElementMap).find(name, id);
+}
+
+ThemeData::ThemeElement::PropertyId ThemeData::ThemeElement::getPropertyId(const std::string& name)
+{
+	return getPropertyNameRegistry(sElementMap).get(name);
+}
+
+const std::string& ThemeData::ThemeElement::getPropertyName(PropertyId id)
+{
+	return getPropertyNameRegistry(sElementMap).getName(id);
+}
+
+const ThemeData::ThemeElement* ThemeData::ThemeView::findElement(const std::string& name) const
+{
+	ThemeElement::PropertyId id;
+	if (mIndex.empty() || !getElementNameRegistry().find(name, id))
+		return nullptr;
+
+	auto it = std::lower_bound(mIndex.cbegin(), mIndex.cend(), id, [](const ElementIndex& entry, ThemeElement::PropertyId value) { return entry.id < value; });
+	if (it == mIndex.cend() || it->id != id)
+		return nullptr;
+
+	return &elements[it->position].second;
+}
+
+ThemeData::ThemeElement* ThemeData::ThemeView::findElement(const std::string& name)
+{
+	return const_cast<ThemeElement*>(static_cast<const ThemeView*>(this)->findElement(name));
+}
+
+ThemeData::ThemeElement& ThemeData::ThemeView::getOrAddElement(const std::string& name)
+{
+	ThemeElement::PropertyId id = getElementNameRegistry().get(name);
+
+	auto it = std::lower_bound(mIndex.begin(), mIndex.end(), id, [](const ElementIndex& entry, ThemeElement::PropertyId value) { return entry.id < value; });
+	if (it != mIndex.end() && it->id == id)
+		return elements[it->position].second;
+
+	// A name which couldn't be registered is still kept, it's only reachable by iterating the elements
+	if (id != ThemeElement::INVALID_PROPERTY_ID)
+	{
+		ElementIndex entry;
+		entry.id = id;
+		entry.position = (unsigned int)elements.size();
+		mIndex.insert(it, entry);
+	}
+
+	elements.push_back(std::pair<std::string, ThemeElement>(name, ThemeElement()));
+	return elements.back().second;
+}
+
+ThemeData::ThemeElement::PropertyMap::const_iterator ThemeData::ThemeElement::PropertyMap::find(PropertyId id) const
+{
+	auto it = std::lower_bound(mEntries.cbegin(), mEntries.cend(), id, [](const Entry& entry, PropertyId value) { return entry.id < value; });
+	if (it == mEntries.cend() || it->id != id)
+		return end();
+
+	return const_iterator(&(*it));
+}
+
+ThemeData::ThemeElement::PropertyMap::const_iterator ThemeData::ThemeElement::PropertyMap::find(const std::string& name) const
+{
+	PropertyId id;
+	if (mEntries.empty() || !findPropertyId(name, id))
+		return end();
+
+	return find(id);
+}
+
+const ThemeData::ThemeElement::Property& ThemeData::ThemeElement::PropertyMap::at(PropertyId id) const
+{
+	auto it = find(id);
+	if (it == end())
+		throw std::out_of_range("ThemeElement property " + getPropertyName(id));
+
+	return it->second;
+}
+
+const ThemeData::ThemeElement::Property& ThemeData::ThemeElement::PropertyMap::at(const std::string& name) const
+{
+	auto it = find(name);
+	if (it == end())
+		throw std::out_of_range("ThemeElement property " + name);
+
+	return it->second;
+}
+
+ThemeData::ThemeElement::Property& ThemeData::ThemeElement::PropertyMap::operator[](PropertyId id)
+{
+	// A name which couldn't be registered : the value is written nowhere
+	if (id == INVALID_PROPERTY_ID)
+	{
+		static thread_local Property discarded;
+		discarded = Property();
+		return discarded;
+	}
+
+	auto it = std::lower_bound(mEntries.begin(), mEntries.end(), id, [](const Entry& entry, PropertyId value) { return entry.id < value; });
+	if (it == mEntries.end() || it->id != id)
+	{
+		Entry entry;
+		entry.id = id;
+		it = mEntries.insert(it, entry);
+	}
+
+	return it->value;
+}
+
+void ThemeData::ThemeElement::PropertyMap::erase(const std::string& name)
+{
+	PropertyId id;
+	if (!findPropertyId(name, id))
+		return;
+
+	auto it = std::lower_bound(mEntries.begin(), mEntries.end(), id, [](const Entry& entry, PropertyId value) { return entry.id < value; });
+	if (it != mEntries.end() && it->id == id)
+		mEntries.erase(it);
+}
+
+size_t ThemeData::ThemeElement::PropertyMap::getMemoryUsage() const
+{
+	size_t size = mEntries.capacity() * sizeof(Entry);
+
+	for (auto& entry : mEntries)
+		if (entry.value.type == Property::PropertyType::String)
+			size += MemoryAccounting::getStringSize(entry.value.s);
+
+	return size;
+}
+
 std::shared_ptr<ThemeData> ThemeData::clone(const std::string& viewName)
 {
 	auto theme = std::make_shared<ThemeData>();
@@ -2628,8 +3045,8 @@ bool ThemeData::appendFile(const std::string& path, bool perGameOverride)
 	mPaths.push_back(path);
 	mVariables["currentPath"] = Utils::FileSystem::getParent(mPaths.back());
 
-	pugi::xml_document includeDoc;
-	pugi::xml_parse_result result = includeDoc.load_file(WINSTRINGW(path).c_str());
+	pugi::xml_parse_result result;
+	auto includeDoc = loadThemeDocument(path, result, perGameOverride);
 	if (!result)
 	{
 		mPaths.pop_back();
@@ -2641,7 +3058,7 @@ bool ThemeData::appendFile(const std::string& path, bool perGameOverride)
 		return false;
 	}
 
-	pugi::xml_node theme = includeDoc.child("theme");
+	pugi::xml_node theme = includeDoc->child("theme");
 	if (!theme)
 	{
 		mPaths.pop_back();
@@ -2707,10 +3124,11 @@ void ThemeData::applySelfTheme(GuiComponent* comp, const ThemeElement& elem)
 	auto theme = std::make_shared<ThemeData>(true);	
 	
 	ThemeView& view = theme->mViews.insert(std::pair<std::string, ThemeView>("default", ThemeView())).first->second;
-	auto element = view.elements.insert(std::pair<std::string, ThemeElement>("default", elem));
+	ThemeElement& element = view.getOrAddElement("default");
+	element = elem;
 
 	comp->applyTheme(theme, "default", "default", ThemeFlags::ALL);
 
 	// Clear storyboard or they'll be deleted as we use a temporary fake theme...
-	element.first->second.mStoryBoards.clear();
+	element.mStoryBoards.clear();
 }
@@ -209,8 +209,11 @@ public:
 	public:
 		ThemeElement() { extra = 0; }
 		ThemeElement(const ThemeElement& src);
+		ThemeElement(ThemeElement&& src) noexcept;
 		~ThemeElement();
 
+		ThemeElement& operator=(ThemeElement src);
+
 		int extra;
 		std::string type;
 		std::map<std::string, ThemeStoryboard*> mStoryBoards;
@@ -261,21 +264,105 @@ public:
 
 		};
 
-		std::map< std::string, Property > properties;
+		// Property names are interned : elements only store a small id per property
+		typedef unsigned short PropertyId;
+
+		// Never given to a name : returned when the registry is full. Elements never store it.
+		static const PropertyId INVALID_PROPERTY_ID = 0xFFFF;
+
+		// Registers the name if it's unknown, INVALID_PROPERTY_ID if it can't be registered
+		static PropertyId getPropertyId(const std::string& name);
+		// Lock free lookup, returns false if the name was never registered
+		static bool findPropertyId(const std::string& name, PropertyId& id);
+		static const std::string& getPropertyName(PropertyId id);
+
+		// Flat storage sorted by property id, with the subset of std::map's interface the themes use.
+		// Unlike std::map, iteration follows the ids : the schema's names in alphabetical order, then the names registered later.
+		// Callers only copy the properties into maps or test them one by one, so none depends on it.
+		class PropertyMap
+		{
+			struct Entry
+			{
+				PropertyId id;
+				Property value;
+			};
+
+		public:
+			typedef std::pair<const std::string&, const Property&> value_type;
+
+			class const_iterator
+			{
+			public:
+				struct Arrow
+				{
+					value_type value;
+					const value_type* operator->() const { return &value; }
+				};
+
+				const_iterator(const Entry* entry) : mEntry(entry) { }
+
+				value_type operator*() const { return value_type(getPropertyName(mEntry->id), mEntry->value); }
+				Arrow operator->() const { return Arrow{ **this }; }
+				const_iterator& operator++() { mEntry++; return *this; }
+
+				bool operator==(const const_iterator& other) const { return mEntry == other.mEntry; }
+				bool operator!=(const const_iterator& other) const { return mEntry != other.mEntry; }
+
+			private:
+				const Entry* mEntry;
+			};
+
+			const_iterator begin() const { return const_iterator(mEntries.data()); }
+			const_iterator end() const { return const_iterator(mEntries.data() + mEntries.size()); }
+			const_iterator cbegin() const { return begin(); }
+			const_iterator cend() const { return end(); }
+
+			size_t size() const { return mEntries.size(); }
+			bool empty() const { return mEntries.empty(); }
+
+			const_iterator find(PropertyId id) const;
+			const_iterator find(const std::string& name) const;
+
+			const Property& at(PropertyId id) const;
+			const Property& at(const std::string& name) const;
+
+			Property& operator[](PropertyId id);
+			Property& operator[](const std::string& name) { return (*this)[getPropertyId(name)]; }
+
+			void erase(const std::string& name);
+
+			size_t getMemoryUsage() const;
+
+		private:
+			std::vector<Entry> mEntries;
+		};
+
+		PropertyMap properties;
+
+		template<typename T>
+		const T get(const std::string& prop) const { return getValue<T>(properties.at(prop)); }
+
+		template<typename T>
+		const T get(PropertyId prop) const { return getValue<T>(properties.at(prop)); }
+
+		inline bool has(const std::string& prop) const { return (properties.find(prop) != properties.cend()); }
+		inline bool has(PropertyId prop) const { return (properties.find(prop) != properties.cend()); }
+
+		// Estimated heap bytes of the properties and children, storyboards excluded
+		size_t getMemoryUsage() const;
 
+	private:
 		template<typename T>
-		const T get(const std::string& prop) const
+		static const T getValue(const Property& value)
 		{
-			if(     std::is_same<T, Vector2f>::value)     return *(const T*)&properties.at(prop).v;
-			else if(std::is_same<T, std::string>::value)  return *(const T*)&properties.at(prop).s;
-			else if(std::is_same<T, unsigned int>::value) return *(const T*)&properties.at(prop).i;
-			else if(std::is_same<T, float>::value)        return *(const T*)&properties.at(prop).f;
-			else if(std::is_same<T, bool>::value)         return *(const T*)&properties.at(prop).b;
-			else if (std::is_same<T, Vector4f>::value)         return *(const T*)&properties.at(prop).r;
+			if(     std::is_same<T, Vector2f>::value)     return *(const T*)&value.v;
+			else if(std::is_same<T, std::string>::value)  return *(const T*)&value.s;
+			else if(std::is_same<T, unsigned int>::value) return *(const T*)&value.i;
+			else if(std::is_same<T, float>::value)        return *(const T*)&value.f;
+			else if(std::is_same<T, bool>::value)         return *(const T*)&value.b;
+			else if (std::is_same<T, Vector4f>::value)         return *(const T*)&value.r;
 			return T();
 		}
-
-		inline bool has(const std::string& prop) const { return (properties.find(prop) != properties.cend()); }
 	};
 
 private:
@@ -284,8 +371,17 @@ private:
 	public:
 		ThemeView() { isCustomView = false; extraTransitionSpeed = -1.0f; }
 
-		std::map<std::string, ThemeElement> elements;
-		std::vector<std::string> orderedKeys;
+		// Elements in declaration order. Their names are interned like the properties, and mIndex maps the ids to positions.
+		std::vector<std::pair<std::string, ThemeElement>> elements;
+
+		ThemeElement* findElement(const std::string& name);
+		const ThemeElement* findElement(const std::string& name) const;
+
+		// Appends an empty element if the name is unknown
+		ThemeElement& getOrAddElement(const std::string& name);
+
+		size_t getIndexMemoryUsage() const { return mIndex.capacity() * sizeof(ElementIndex); }
+
 		std::string baseType;
 
 		std::string extraTransition;
@@ -299,6 +395,16 @@ private:
 		std::string displayName;
 
 		bool isCustomView;
+
+	private:
+		struct ElementIndex
+		{
+			ThemeElement::PropertyId id;
+			unsigned int position;
+		};
+
+		// Sorted by id
+		std::vector<ElementIndex> mIndex;
 	};
 
 public:
@@ -360,6 +466,9 @@ public:
 	std::string getSystemThemeFolder() { return mSystemThemeFolder; }
 	
 	std::vector<std::pair<std::string, std::string>> getViewsOfTheme();
+
+	// Estimated bytes of the views and their elements, for the memory accounting
+	size_t getMemoryUsage() const;
 	std::string getDefaultView() { return mDefaultView; };
 	std::string getDefaultTransition() { return mDefaultTransition; };
 	
@@ -379,7 +488,12 @@ public:
 
 	static bool parseCustomShader(const ThemeData::ThemeElement* elem, Renderer::ShaderInfo* pShader, const std::string& type = "shader");
 
+	// Releases the theme files parsed since the last call, and logs loading statistics
+	static void clearThemeCache();
+
 private:
+	static std::shared_ptr<const pugi::xml_document> loadThemeDocument(const std::string& path, pugi::xml_parse_result& result, bool perGame = false);
+
 	static std::map< std::string, std::map<std::string, ElementPropertyType> > sElementMap;
 	static std::set<std::string> sSupportedItemTemplate;
 	static std::set<std::string> sSupportedFeatures;
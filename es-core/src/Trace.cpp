@@ -0,0 +1,280 @@
+#include "Trace.h"
+#include "Log.h"
+#include "Paths.h"
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+#include <csignal>
+
+// Events kept per thread : the oldest ones are overwritten
+#define TRACE_BUFFER_SIZE 16384
+
+namespace Trace
+{
+	std::atomic<bool> sEnabled(false);
+
+	struct TraceEvent
+	{
+		const char* name;
+		std::string detail;
+		int64_t start;
+		int64_t duration;
+	};
+
+	struct ThreadBuffer
+	{
+		int id;
+		std::string name;
+		unsigned int generation;
+
+		std::mutex lock; // Only contended while exporting
+		std::vector<TraceEvent> events;
+		size_t next;
+	};
+
+	static std::mutex										sBuffersLock;
+	static std::vector<std::shared_ptr<ThreadBuffer>>		sBuffers;
+	static int												sNextThreadId = 1;
+	static std::atomic<unsigned int>						sGeneration(0);
+	static std::atomic<bool>								sSignalReceived(false);
+	static const std::chrono::steady_clock::time_point		sStartTime = std::chrono::steady_clock::now();
+
+	static ThreadBuffer* getThreadBuffer()
+	{
+		static thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+		if (buffer == nullptr)
+		{
+			buffer = std::make_shared<ThreadBuffer>();
+			buffer->generation = sGeneration;
+			buffer->next = 0;
+
+			std::unique_lock<std::mutex> lock(sBuffersLock);
+			buffer->id = sNextThreadId++;
+			buffer->name = "thread " + std::to_string(buffer->id);
+			sBuffers.push_back(buffer);
+		}
+
+		return buffer.get();
+	}
+
+	void setEnabled(bool enabled)
+	{
+		if (enabled == isEnabled())
+			return;
+
+		if (enabled)
+		{
+			sGeneration++;
+
+			// Buffers of the threads which have exited are only kept for the capture they were part of
+			std::unique_lock<std::mutex> lock(sBuffersLock);
+			for (auto it = sBuffers.begin(); it != sBuffers.end(); )
+			{
+				if (it->use_count() == 1)
+					it = sBuffers.erase(it);
+				else
+					++it;
+			}
+		}
+
+		sEnabled = enabled;
+		LOG(LogInfo) << "Trace : " << (enabled ? "enabled" : "disabled");
+	}
+
+	void setThreadName(const std::string& name)
+	{
+		auto buffer = getThreadBuffer();
+
+		std::unique_lock<std::mutex> lock(buffer->lock);
+		buffer->name = name;
+	}
+
+	int64_t getTime()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sStartTime).count();
+	}
+
+	void addEvent(const char* name, const std::string& detail, int64_t start, int64_t end)
+	{
+		auto buffer = getThreadBuffer();
+
+		std::unique_lock<std::mutex> lock(buffer->lock);
+
+		unsigned int generation = sGeneration;
+		if (buffer->generation != generation)
+		{
+			buffer->generation = generation;
+			buffer->events.clear();
+			buffer->next = 0;
+		}
+
+		TraceEvent evt = { name, detail, start, end - start };
+
+		if (buffer->events.size() < TRACE_BUFFER_SIZE)
+			buffer->events.push_back(std::move(evt));
+		else
+			buffer->events[buffer->next] = std::move(evt);
+
+		buffer->next = (buffer->next + 1) % TRACE_BUFFER_SIZE;
+	}
+
+	std::vector<ScopeTiming> getThreadScopes(int64_t start, int64_t end, int64_t minDuration, size_t maxCount)
+	{
+		std::vector<ScopeTiming> ret;
+		if (!isEnabled())
+			return ret;
+
+		auto buffer = getThreadBuffer();
+
+		std::unique_lock<std::mutex> lock(buffer->lock);
+		if (buffer->generation != sGeneration)
+			return ret;
+
+		for (auto& evt : buffer->events)
+		{
+			if (evt.duration < minDuration || evt.start > end || evt.start + evt.duration < start)
+				continue;
+
+			ScopeTiming scope;
+			scope.name = evt.detail.empty() ? evt.name : std::string(evt.name) + " " + evt.detail;
+			scope.start = evt.start;
+			scope.duration = evt.duration;
+			ret.push_back(scope);
+		}
+
+		lock.unlock();
+
+		std::sort(ret.begin(), ret.end(), [](const ScopeTiming& a, const ScopeTiming& b) { return a.duration > b.duration; });
+		if (ret.size() > maxCount)
+			ret.resize(maxCount);
+
+		return ret;
+	}
+
+	static void appendJsonString(std::string& json, const std::string& value)
+	{
+		json += '"';
+
+		for (auto c : value)
+		{
+			switch (c)
+			{
+			case '"': json += "\\\""; break;
+			case '\\': json += "\\\\"; break;
+			case '\n': json += "\\n"; break;
+			case '\r': json += "\\r"; break;
+			case '\t': json += "\\t"; break;
+			default:
+				if ((unsigned char)c < 0x20)
+				{
+					char buf[8];
+					snprintf(buf, sizeof(buf), "\\u%04x", c);
+					json += buf;
+				}
+				else
+					json += c;
+			}
+		}
+
+		json += '"';
+	}
+
+	std::string exportChromeTrace()
+	{
+		std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+		{
+			std::unique_lock<std::mutex> lock(sBuffersLock);
+			buffers = sBuffers;
+		}
+
+		unsigned int generation = sGeneration;
+
+		std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool first = true;
+
+		for (auto buffer : buffers)
+		{
+			std::unique_lock<std::mutex> lock(buffer->lock);
+			if (buffer->generation != generation || buffer->events.empty())
+				continue;
+
+			std::string tid = std::to_string(buffer->id);
+
+			if (!first)
+				json += ",";
+
+			first = false;
+
+			json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":";
+			appendJsonString(json, buffer->name);
+			json += "}}";
+
+			for (auto& evt : buffer->events)
+			{
+				json += ",{\"name\":";
+				appendJsonString(json, evt.name);
+				json += ",\"cat\":\"es\",\"ph\":\"X\",\"pid\":1,\"tid\":" + tid + ",\"ts\":" + std::to_string(evt.start) + ",\"dur\":" + std::to_string(evt.duration);
+
+				if (!evt.detail.empty())
+				{
+					json += ",\"args\":{\"detail\":";
+					appendJsonString(json, evt.detail);
+					json += "}";
+				}
+
+				json += "}";
+			}
+		}
+
+		json += "]}";
+		return json;
+	}
+
+	bool dump(const std::string& path)
+	{
+		std::string json = exportChromeTrace();
+
+		FILE* file = fopen(path.c_str(), "wb");
+		if (file == nullptr)
+		{
+			LOG(LogError) << "Trace : unable to write " << path;
+			return false;
+		}
+
+		fwrite(json.data(), 1, json.size(), file);
+		fclose(file);
+
+		LOG(LogInfo) << "Trace : saved to " << path << " (" << json.size() / 1024 << " KB)";
+		return true;
+	}
+
+#if !WIN32
+	static void onSignal(int /*signal*/)
+	{
+		sSignalReceived = true;
+	}
+#endif
+
+	void installSignalHandler()
+	{
+#if !WIN32
+		std::signal(SIGUSR2, onSignal);
+#endif
+	}
+
+	void processSignal()
+	{
+		if (!sSignalReceived.exchange(false))
+			return;
+
+		if (!isEnabled())
+			setEnabled(true);
+		else
+			dump(Paths::getUserEmulationStationPath() + "/es_trace.json");
+	}
+} // Trace::
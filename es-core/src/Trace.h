@@ -0,0 +1,83 @@
+#pragma once
+#ifndef ES_CORE_TRACE_H
+#define ES_CORE_TRACE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+// Scoped timings of hot paths, exported as Chrome trace events (chrome://tracing, ui.perfetto.dev).
+// Compiled out with -DES_DISABLE_TRACING, otherwise only recorded while tracing is enabled at runtime.
+#ifdef ES_DISABLE_TRACING
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_DETAIL(name, detail)
+#else
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+// detail is only evaluated when tracing is enabled
+#define TRACE_SCOPE_DETAIL(name, detail) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name, [&]() { return std::string(detail); })
+#endif
+
+namespace Trace
+{
+	extern std::atomic<bool> sEnabled;
+
+	inline bool isEnabled() { return sEnabled.load(std::memory_order_relaxed); }
+
+	// Enabling tracing drops the events of the previous capture
+	void setEnabled(bool enabled);
+	void setThreadName(const std::string& name);
+
+	int64_t getTime(); // Microseconds
+	void addEvent(const char* name, const std::string& detail, int64_t start, int64_t end);
+
+	struct ScopeTiming
+	{
+		std::string name; // Followed by the detail, if any
+		int64_t start;
+		int64_t duration;
+	};
+
+	// Scopes recorded by the calling thread which overlap [start, end] and lasted at least minDuration, longest first.
+	// Empty while tracing is disabled.
+	std::vector<ScopeTiming> getThreadScopes(int64_t start, int64_t end, int64_t minDuration, size_t maxCount);
+
+	std::string exportChromeTrace();
+	bool dump(const std::string& path);
+
+	// SIGUSR2 starts tracing, or dumps the events to es_trace.json if it's already running. The dump is done by processSignal(), from the main loop
+	void installSignalHandler();
+	void processSignal();
+
+	class Scope
+	{
+	public:
+		Scope(const char* name) : mName(isEnabled() ? name : nullptr), mStart(0)
+		{
+			if (mName != nullptr)
+				mStart = getTime();
+		}
+
+		template<typename T>
+		Scope(const char* name, const T& detail) : Scope(name)
+		{
+			if (mName != nullptr)
+				mDetail = detail();
+		}
+
+		~Scope()
+		{
+			if (mName != nullptr)
+				addEvent(mName, mDetail, mStart, getTime());
+		}
+
+	private:
+		const char*	mName;
+		int64_t		mStart;
+		std::string mDetail;
+	};
+} // Trace::
+
+#endif // ES_CORE_TRACE_H
@@ -7,6 +7,9 @@
 #include "resources/TextureResource.h"
 #include "InputManager.h"
 #include "Log.h"
+#include "Trace.h"
+#include "MemoryAccounting.h"
+#include "FrameTimings.h"
 #include "Scripting.h"
 #include <algorithm>
 #include <iomanip>
@@ -25,13 +28,14 @@
 #include "Splash.h"
 #include "PowerSaver.h"
 #include "renderers/Renderer.h"
+#include "components/VideoVlcComponent.h"
 
 #if WIN32
 #include <SDL_syswm.h>
 #endif
 
 Window::Window() : mNormalizeNextUpdate(false), mFrameTimeElapsed(0), mFrameCountElapsed(0), mAverageDeltaTime(10),
-  mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mClockElapsed(0), mMouseCapture(nullptr), mMenuBackgroundShaderTextureCache(-1)
+  mAllowSleep(true), mSleeping(false), mTimeSinceLastInput(0), mScreenSaver(NULL), mRenderScreenSaver(false), mClockElapsed(0), mMouseCapture(nullptr), mMenuBackgroundShaderTextureCache(-1), mUpdateCount(0), mMemorySamplePosted(false)
 {			
 	mTransitionOffset = 0;
 
@@ -428,6 +432,8 @@ void Window::processSongTitleNotifications()
 
 void Window::update(int deltaTime)
 {
+	TRACE_SCOPE("Window::update");
+
 	if (mLastShowCursor >= 0)
 	{
 		mLastShowCursor += deltaTime;
@@ -438,7 +444,18 @@ void Window::update(int deltaTime)
 		}
 	}
 
+	mUpdateCount++;
+
+	// Measuring walks the library and the themes : every second while the overlay shows it, otherwise sampled on an idle frame
+	if (Settings::DrawFramerate())
+		MemoryAccounting::update();
+	else if (!mMemorySamplePosted && MemoryAccounting::isSampleDue())
+	{
+		mMemorySamplePosted = true;
+		postIdleTask([this]() { MemoryAccounting::update(true); mMemorySamplePosted = false; });
+	}
 	processPostedFunctions();
+	processIdleTask();
 	processSongTitleNotifications();
 	processNotificationMessages();
 
@@ -469,13 +486,21 @@ void Window::update(int deltaTime)
 			ss << std::fixed << std::setprecision(1) << (1000.0f * (float)mFrameCountElapsed / (float)mFrameTimeElapsed) << "fps, ";
 			ss << std::fixed << std::setprecision(2) << ((float)mFrameTimeElapsed / (float)mFrameCountElapsed) << "ms";
 
-			// vram
-			float textureVramUsageMb = TextureResource::getTotalMemUsage(false) / 1024.0f / 1024.0f;
-			float textureTotalUsageMb = TextureResource::getTotalTextureSize() / 1024.0f / 1024.0f;
-			float fontVramUsageMb = Font::getTotalMemUsage() / 1024.0f / 1024.0f;
-			size_t max_texture = Settings::getInstance()->getInt("MaxVRAM");
+			// frame time distribution
+			ss << "\n" << FrameTimings::getOverlayText();
 
-			ss << "\nFont VRAM: " << fontVramUsageMb << " Tex VRAM: " << textureVramUsageMb << " Known Tex: " << textureTotalUsageMb << " Max VRAM: " << max_texture;
+			// memory
+			ss << "\n" << MemoryAccounting::getOverlayText();
+
+			// video frames
+			auto videoStats = VideoVlcComponent::getFrameStats();
+			if (videoStats.frames > 0)
+			{
+				ss << "\nVideo: " << videoStats.frames << " frames, ";
+				ss << std::fixed << std::setprecision(2) << (videoStats.convertTime / videoStats.frames) << "ms convert, ";
+				ss << std::fixed << std::setprecision(2) << (videoStats.uploadTime / videoStats.frames) << "ms upload, ";
+				ss << (videoStats.bytes / videoStats.frames / 1024) << "KB/frame";
+			}
 
 			mFrameDataText = std::unique_ptr<TextCache>(mDefaultFonts.at(0)->buildTextCache(ss.str(), Vector2f(50.f, 50.f), 0xFFFF40FF, 0.0f, ALIGN_LEFT, 1.2f));			
 		}
@@ -662,6 +687,8 @@ void Window::resetMenuBackgroundShader()
 
 void Window::render()
 {
+	TRACE_SCOPE("Window::render");
+
 	Transform4x4f transform = Transform4x4f::Identity();
 
 	mRenderedHelpPrompts = false;
@@ -913,6 +940,7 @@ void Window::render()
 void Window::normalizeNextUpdate()
 {
 	mNormalizeNextUpdate = true;
+	FrameTimings::discardFrame();
 }
 
 bool Window::getAllowSleep()
@@ -1232,6 +1260,42 @@ void Window::postToUiThread(const std::function<void()>& func, void* data)
 	}
 }
 
+void Window::postIdleTask(const std::function<void()>& func)
+{
+	IdleTask task;
+	task.func = func;
+	task.frame = mUpdateCount;
+	mIdleTasks.push_back(task);
+
+	if (mSleeping || !PowerSaver::getState())
+		PowerSaver::pushRefreshEvent();
+}
+
+void Window::processIdleTask()
+{
+	// The frame which posted the task and the next one are rendered first
+	if (mIdleTasks.empty() || mIdleTasks.front().frame + 1 >= mUpdateCount)
+		return;
+
+	TRACE_SCOPE("Window::processIdleTask");
+
+	auto func = mIdleTasks.front().func;
+	mIdleTasks.pop_front();
+
+	TRYCATCH("processIdleTask", func())
+}
+
+void Window::flushIdleTasks()
+{
+	while (!mIdleTasks.empty())
+	{
+		auto func = mIdleTasks.front().func;
+		mIdleTasks.pop_front();
+
+		TRYCATCH("flushIdleTasks", func())
+	}
+}
+
 void Window::processPostedFunctions()
 {
 	std::vector<PostedFunction> functions;
@@ -9,6 +9,7 @@
 #include "math/Vector2i.h"
 #include <memory>
 #include <functional>
+#include <deque>
 
 class FileData;
 class Font;
@@ -90,6 +91,10 @@ public:
 
 	void postToUiThread(const std::function<void()>& func, void* data = nullptr);
 	void unregisterPostedFunctions(void* data);
+
+	// Low priority work for the UI thread : runs once the next frames have been rendered, one task per frame
+	void postIdleTask(const std::function<void()>& func);
+	void flushIdleTasks(); // Runs the pending tasks now, e.g. before the data they use is deleted
 	void reactivateGui();
 
 	void onThemeChanged(const std::shared_ptr<ThemeData>& theme);
@@ -127,6 +132,18 @@ private:
 
 	std::vector<PostedFunction> mFunctions;
 
+	struct IdleTask
+	{
+		std::function<void()> func;
+		unsigned int frame;
+	};
+
+	std::deque<IdleTask> mIdleTasks;
+	unsigned int mUpdateCount;
+	void processIdleTask();
+
+	bool mMemorySamplePosted;
+
 	std::vector<GuiInfoPopup*> mNotificationPopups;
 	void updateNotificationPopups(int deltaTime);
 	void layoutNotificationPopups();
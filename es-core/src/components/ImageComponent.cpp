@@ -951,6 +951,16 @@ std::vector<HelpPrompt> ImageComponent::getHelpPrompts()
 	return ret;
 }
 
+size_t ImageComponent::getMemoryUsage()
+{
+	size_t total = GuiComponent::getMemoryUsage();
+
+	if (mTexture != nullptr)
+		total += mTexture->getVRAMUsage();
+
+	return total;
+}
+
 void ImageComponent::setPlaylist(std::shared_ptr<IPlaylist> playList)
 {
 	mPlaylistCache.clear();
@@ -95,6 +95,8 @@ public:
 
 	virtual std::vector<HelpPrompt> getHelpPrompts() override;
 
+	size_t getMemoryUsage() override;
+
 	void setAllowFading(bool fade) { mAllowFading = fade; };
 	void setMirroring(Vector2f mirror) { mReflection = mirror; };
 
@@ -148,6 +148,18 @@ private:
 	Vector2i	getVisibleRange();
 	void		loadTile(std::shared_ptr<GridTileComponent> tile, typename IList<ImageGridData, T>::Entry& entry);
 	std::shared_ptr<GridTileComponent> createTile(int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition);
+	void		placeTile(const std::shared_ptr<GridTileComponent>& tile, int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition);
+	std::shared_ptr<GridTileComponent> acquireTile(int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition);
+	void		releaseTile(const std::shared_ptr<GridTileComponent>& tile);
+	void		clearTiles();
+
+	template<typename F>
+	void forEachBoundTile(F func)
+	{
+		for (int i : mBoundEntries)
+			if (i < mEntries.size() && mEntries[i].data.tile != nullptr)
+				func(mEntries[i].data.tile);
+	}
 
 	inline bool isVertical() { return mScrollDirection == SCROLL_VERTICALLY; };
 
@@ -162,6 +174,11 @@ private:
 
 	std::vector<std::shared_ptr<GridTileComponent>> mVisibleTiles;
 
+	// Only the entries in the visible range own a tile : tiles scrolled out are recycled through the pool
+	std::vector<int> mBoundEntries;
+	std::vector<std::shared_ptr<GridTileComponent>> mTilePool;
+	size_t mTilePoolSize;
+
 	// TILES
 	bool mLastRowPartial;
 	bool mAnimateSelection;
@@ -249,6 +266,22 @@ std::shared_ptr<GridTileComponent> ImageGridComponent<T>::createTile(int i, int
 	// Create tiles
 	auto tile = std::make_shared<GridTileComponent>(mWindow);
 
+	tile->setOrigin(0.5f, 0.5f);
+	placeTile(tile, i, dimOpposite, tileDistance, startPosition);
+	tile->setSize(mTileSize);
+
+	if (mTheme)
+		tile->applyTheme(mTheme, mName, "gridtile", ThemeFlags::ALL);
+
+	if (mAutoLayout.x() != 0 && mAutoLayout.y() != 0)
+		tile->forceSize(mTileSize, mAutoLayoutZoom);
+
+	return tile;
+}
+
+template<typename T>
+void ImageGridComponent<T>::placeTile(const std::shared_ptr<GridTileComponent>& tile, int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition)
+{
 	int X = i % (int)dimOpposite;
 	int Y = i / (int)dimOpposite;
 
@@ -261,19 +294,61 @@ std::shared_ptr<GridTileComponent> ImageGridComponent<T>::createTile(int i, int
 	if (!isVertical())
 		std::swap(X, Y);
 
-	tile->setOrigin(0.5f, 0.5f);
 	tile->setPosition(X * tileDistance.x() + startPosition.x(), Y * tileDistance.y() + startPosition.y());
-	tile->setSize(mTileSize);
+}
 
-	if (mTheme)
-		tile->applyTheme(mTheme, mName, "gridtile", ThemeFlags::ALL);
+template<typename T>
+std::shared_ptr<GridTileComponent> ImageGridComponent<T>::acquireTile(int i, int dimOpposite, Vector2f tileDistance, Vector2f startPosition)
+{
+	if (mTilePool.empty())
+		return createTile(i, dimOpposite, tileDistance, startPosition);
 
-	if (mAutoLayout.x() != 0 && mAutoLayout.y() != 0)
-		tile->forceSize(mTileSize, mAutoLayoutZoom);
+	auto tile = mTilePool.back();
+	mTilePool.pop_back();
 
+	placeTile(tile, i, dimOpposite, tileDistance, startPosition);
+	tile->setVisible(true);
 	return tile;
 }
 
+template<typename T>
+void ImageGridComponent<T>::releaseTile(const std::shared_ptr<GridTileComponent>& tile)
+{
+	if (tile->isSelected())
+		tile->setSelected(false, false, nullptr, true);
+
+	if (tile->isShowing())
+		tile->onHide();
+
+	tile->setVisible(false);
+
+	auto it = std::find(mVisibleTiles.cbegin(), mVisibleTiles.cend(), tile);
+	if (it != mVisibleTiles.cend())
+		mVisibleTiles.erase(it);
+
+	if (!mShowing)
+		tile->resetImages();
+
+	if (mTilePool.size() < mTilePoolSize)
+		mTilePool.push_back(tile);
+}
+
+// Tiles depend on the theme and the tile size : drop them all
+template<typename T>
+void ImageGridComponent<T>::clearTiles()
+{
+	forEachBoundTile([](const std::shared_ptr<GridTileComponent>& tile) { tile->resetImages(); });
+
+	for (int i : mBoundEntries)
+		if (i < mEntries.size())
+			mEntries[i].data.tile = nullptr;
+
+	mBoundEntries.clear();
+	mTilePool.clear();
+	mScrollLoopTiles.clear();
+	mVisibleTiles.clear();
+}
+
 template<typename T>
 void ImageGridComponent<T>::preloadTiles()
 {
@@ -284,19 +359,19 @@ void ImageGridComponent<T>::preloadTiles()
 
 	Vector2f tileDistance = mTileSize + mMargin;
 
-	for (int i = 0; i < mEntries.size(); i++)
-	{
-		typename IList<ImageGridData, T>::Entry& entry = mEntries[i];
-		if (entry.data.tile != nullptr)
-			continue;
+	// Fill the pool up to the size of the visible range, then bind the entries in range
+	auto range = getVisibleRange();
+	mTilePoolSize = std::max(mTilePoolSize, (size_t)Math::max(0, range.y() - range.x() + 1));
 
-		auto tile = createTile(i, dimOpposite, tileDistance, startPosition);
+	while (mTilePool.size() + mBoundEntries.size() < mTilePoolSize)
+	{
+		auto tile = createTile(0, dimOpposite, tileDistance, startPosition);
 		tile->setVisible(false);
-
-		loadTile(tile, entry);
-		
-		entry.data.tile = tile;
+		mTilePool.push_back(tile);
 	}
+
+	ensureVisibleTileExist();
+	mEntriesDirty = false;
 }
 
 template<typename T>
@@ -325,13 +400,16 @@ void ImageGridComponent<T>::ensureVisibleTileExist()
 	Vector2f startPosition = mTileSize / 2;
 	startPosition += Vector2f(mPadding.x(), mPadding.y());
 
-	auto oldScrollLoopTiles = mScrollLoopTiles;	
-	mScrollLoopTiles.clear();
+	// Per call cost only depends on the visible range, not on the number of entries
+	int from = mScrollLoop ? range.x() : startIndex;
+	int to = mScrollLoop ? range.y() : endIndex;
 
-	int from = mScrollLoop ? Math::min(range.x(), 0) : 0;
-	int to = mScrollLoop ? Math::max(range.y(), mEntries.size()) : mEntries.size();
+	mTilePoolSize = std::max(mTilePoolSize, (size_t)Math::max(0, range.y() - range.x() + 1));
 
-	for (int idx = from; idx < to; idx++)
+	std::vector<int> boundEntries;
+	std::map<int, int> scrollLoopEntries; // position -> entry
+
+	for (int idx = from; idx <= to; idx++)
 	{
 		int i = idx;
 
@@ -353,74 +431,102 @@ void ImageGridComponent<T>::ensureVisibleTileExist()
 
 			if (i < 0 || i >= mEntries.size())
 				continue;
+
+			if (i < startIndex || i > endIndex)
+				scrollLoopEntries[idx] = i;
+		}
+
+		boundEntries.push_back(i);
+	}
+
+	std::sort(boundEntries.begin(), boundEntries.end());
+	boundEntries.erase(std::unique(boundEntries.begin(), boundEntries.end()), boundEntries.end());
+
+	// Recycle the tiles which went out of range first, so that they can be rebound right away
+	for (int i : mBoundEntries)
+	{
+		if (i >= mEntries.size() || std::binary_search(boundEntries.cbegin(), boundEntries.cend(), i))
+			continue;
+
+		typename IList<ImageGridData, T>::Entry& entry = mEntries[i];
+		if (entry.data.tile == nullptr)
+			continue;
+
+		releaseTile(entry.data.tile);
+		entry.data.tile = nullptr;
+	}
+
+	auto oldScrollLoopTiles = mScrollLoopTiles;
+	mScrollLoopTiles.clear();
+
+	for (auto it = oldScrollLoopTiles.begin(); it != oldScrollLoopTiles.end(); )
+	{
+		if (scrollLoopEntries.find(it->first) == scrollLoopEntries.cend())
+		{
+			releaseTile(it->second);
+			it = oldScrollLoopTiles.erase(it);
 		}
+		else
+			it++;
+	}
 
+	for (int i : boundEntries)
+	{
 		typename IList<ImageGridData, T>::Entry& entry = mEntries[i];
 
-		if ((mScrollLoop && idx >= range.x() && idx <= range.y()) || (!mScrollLoop && i >= startIndex && i <= endIndex))
+		if (entry.data.tile == nullptr)
 		{
-			if (entry.data.tile == nullptr)
-			{
-				// Create tiles
-				auto tile = createTile(i, dimOpposite, tileDistance, startPosition);
-				loadTile(tile, entry);
+			auto tile = acquireTile(i, dimOpposite, tileDistance, startPosition);
+			loadTile(tile, entry);
 
-				entry.data.tile = tile;
+			entry.data.tile = tile;
 
-				if (tile->isVisible())
-					mVisibleTiles.push_back(tile);
+			if (tile->isVisible())
+				mVisibleTiles.push_back(tile);
 
-				if (mCursor == i)
+			if (mCursor == i)
+			{
+				auto curTile = getSelectedTile();
+				while (curTile != nullptr)
 				{
-					auto curTile = getSelectedTile();
-					while (curTile != nullptr)
-					{
-						curTile->setSelected(false, false, nullptr, true);
-						curTile = getSelectedTile();
-					}
-
-					mLastCursor = mCursor;
-					tile->setSelected(true, true, nullptr, true);
+					curTile->setSelected(false, false, nullptr, true);
+					curTile = getSelectedTile();
 				}
 
-				if (mShowing)
-					tile->onShow();
+				mLastCursor = mCursor;
+				tile->setSelected(true, true, nullptr, true);
 			}
-			else if (!entry.data.tile->isVisible())
-			{
-				loadTile(entry.data.tile, entry);
-				entry.data.tile->setVisible(true);
 
-				mVisibleTiles.push_back(entry.data.tile);
+			if (mShowing)
+				tile->onShow();
+		}
+		else if (!entry.data.tile->isVisible())
+		{
+			loadTile(entry.data.tile, entry);
+			entry.data.tile->setVisible(true);
 
-				if (mShowing)
-					entry.data.tile->onShow();
-			}
+			mVisibleTiles.push_back(entry.data.tile);
 
-			if (mScrollLoop && i < startIndex || i > endIndex)
-			{
-				auto tile = createTile(idx, dimOpposite, tileDistance, startPosition);
-				loadTile(tile, entry);
-				mScrollLoopTiles[idx] = tile;
-			}
+			if (mShowing)
+				entry.data.tile->onShow();
 		}
-		else if (entry.data.tile != nullptr)
-		{
-			if (entry.data.tile->isVisible())
-				entry.data.tile->setVisible(false);
+	}
 
-			auto it = std::find(mVisibleTiles.cbegin(), mVisibleTiles.cend(), entry.data.tile);
-			if (it != mVisibleTiles.cend())
-				mVisibleTiles.erase(it);
+	mBoundEntries = boundEntries;
 
-			if (!mShowing)
-			{				
-				entry.data.tile->resetImages();
-				entry.data.tile = nullptr;
-			}
-			else if (entry.data.tile->isShowing())
-				entry.data.tile->onHide();
+	// Duplicates of the first/last entries shown when the grid loops
+	for (auto loopEntry : scrollLoopEntries)
+	{
+		auto it = oldScrollLoopTiles.find(loopEntry.first);
+		if (it != oldScrollLoopTiles.cend())
+		{
+			mScrollLoopTiles[loopEntry.first] = it->second;
+			continue;
 		}
+
+		auto tile = acquireTile(loopEntry.first, dimOpposite, tileDistance, startPosition);
+		loadTile(tile, mEntries[loopEntry.second]);
+		mScrollLoopTiles[loopEntry.first] = tile;
 	}
 }
 
@@ -445,6 +551,7 @@ ImageGridComponent<T>::ImageGridComponent(Window* window) : IList<ImageGridData,
 	mAllowVideo = false;
 	mName = "grid";
 	mStartPosition = 0;
+	mTilePoolSize = 0;
 	mEntriesDirty = true;
 
 	mLastCursor = -1;
@@ -508,7 +615,12 @@ void ImageGridComponent<T>::setImage(const std::string& imagePath, const T& obj)
 	if (entry != list->end() && (*entry).data.texturePath != imagePath)
 	{
 		(*entry).data.texturePath = imagePath;
-		(*entry).data.tile = nullptr;
+
+		if ((*entry).data.tile != nullptr)
+		{
+			releaseTile((*entry).data.tile);
+			(*entry).data.tile = nullptr;
+		}
 
 		mEntriesDirty = true;
 	}
@@ -613,9 +725,7 @@ void ImageGridComponent<T>::topWindow(bool isTop)
 {
 	GuiComponent::topWindow(isTop);
 
-	for (auto entry : mEntries)
-		if (entry.data.tile != nullptr)
-			entry.data.tile->topWindow(isTop);
+	forEachBoundTile([&](const std::shared_ptr<GridTileComponent>& tile) { tile->topWindow(isTop); });
 }
 
 template<typename T>
@@ -623,9 +733,7 @@ void ImageGridComponent<T>::setOpacity(unsigned char opacity)
 {
 	GuiComponent::setOpacity(opacity);
 
-	for (auto entry : mEntries)
-		if (entry.data.tile != nullptr)
-			entry.data.tile->setOpacity(opacity);
+	forEachBoundTile([&](const std::shared_ptr<GridTileComponent>& tile) { tile->setOpacity(opacity); });
 }
 
 template<typename T>
@@ -633,9 +741,7 @@ void ImageGridComponent<T>::onShow()
 {
 	GuiComponent::onShow();
 
-	for (auto entry : mEntries)
-		if (entry.data.tile != nullptr)
-			entry.data.tile->onShow();
+	forEachBoundTile([](const std::shared_ptr<GridTileComponent>& tile) { tile->onShow(); });
 }
 
 template<typename T>
@@ -643,12 +749,14 @@ void ImageGridComponent<T>::onHide()
 {
 	GuiComponent::onHide();
 
-	for (auto entry : mEntries)
-		if (entry.data.tile != nullptr)
-			entry.data.tile->onHide();
+	forEachBoundTile([](const std::shared_ptr<GridTileComponent>& tile) { tile->onHide(); });
 
 	ensureVisibleTileExist();
 	mEntriesDirty = false;
+
+	// Pooled tiles don't need to keep their textures while hidden
+	for (auto tile : mTilePool)
+		tile->resetImages();
 }
 
 template<typename T>
@@ -656,9 +764,7 @@ void ImageGridComponent<T>::onScreenSaverActivate()
 {
 	GuiComponent::onScreenSaverActivate();
 
-	for (auto entry : mEntries)
-		if (entry.data.tile != nullptr)
-			entry.data.tile->onScreenSaverActivate();
+	forEachBoundTile([&](const std::shared_ptr<GridTileComponent>& tile) { tile->onScreenSaverActivate(); });
 }
 
 template<typename T>
@@ -666,9 +772,7 @@ void ImageGridComponent<T>::onScreenSaverDeactivate()
 {
 	GuiComponent::onScreenSaverDeactivate();
 
-	for (auto entry : mEntries)
-		if (entry.data.tile != nullptr)
-			entry.data.tile->onScreenSaverDeactivate();
+	forEachBoundTile([&](const std::shared_ptr<GridTileComponent>& tile) { tile->onScreenSaverDeactivate(); });
 }
 
 
@@ -685,10 +789,9 @@ std::shared_ptr<GridTileComponent> ImageGridComponent<T>::getSelectedTile()
 		if (tile->isSelected())
 			return tile;
 
-	for (auto entry : mEntries)
-		if (entry.data.tile != nullptr)
-			if (entry.data.tile->isSelected())
-				return entry.data.tile;
+	for (int i : mBoundEntries)
+		if (i < mEntries.size() && mEntries[i].data.tile != nullptr && mEntries[i].data.tile->isSelected())
+			return mEntries[i].data.tile;
 
 	return nullptr;
 }
@@ -1019,15 +1122,6 @@ void ImageGridComponent<T>::applyTheme(const std::shared_ptr<ThemeData>& theme,
 
 	// Trigger the call manually if the theme have no "imagegrid" element
 	resetGrid();
-
-	if (mEntries.size())
-	{
-		for (auto& entry : mEntries)
-		{
-			if (entry.data.tile != nullptr && entry.data.tile->isVisible())
-				mVisibleTiles.push_back(entry.data.tile);
-		}
-	}
 }
 
 template<typename T>
@@ -1361,7 +1455,7 @@ void ImageGridComponent<T>::loadTile(std::shared_ptr<GridTileComponent> tile, ty
 template<typename T>
 void ImageGridComponent<T>::resetGrid()
 {
-	mVisibleTiles.clear();
+	clearTiles();
 
 	if (mGridSizeOverride.x() != 0 && mGridSizeOverride.y() != 0)
 		mAutoLayout = mGridSizeOverride;
@@ -1515,15 +1609,18 @@ bool ImageGridComponent<T>::onMouseClick(int button, bool pressed, int x, int y)
 
 			int tileIndex = 0;
 
-			for (auto entry : mEntries)
+			for (int i : mBoundEntries)
 			{
-				if (entry.data.tile != nullptr && entry.data.tile->isVisible() && entry.data.tile->isMouseOver())
+				if (i >= mEntries.size())
+					continue;
+
+				auto tile = mEntries[i].data.tile;
+				if (tile != nullptr && tile->isVisible() && tile->isMouseOver())
 				{
-					hotTile = entry.data.tile;
+					hotTile = tile;
+					tileIndex = i;
 					break;
 				}
-
-				tileIndex++;
 			}
 
 			if (hotTile)
@@ -513,6 +513,16 @@ void TextComponent::update(int deltaTime)
 	}
 }
 
+size_t TextComponent::getMemoryUsage()
+{
+	size_t total = GuiComponent::getMemoryUsage();
+
+	if (mTextCache != nullptr)
+		total += mTextCache->getMemUsage();
+
+	return total;
+}
+
 void TextComponent::onShow()
 {
 	GuiComponent::onShow();
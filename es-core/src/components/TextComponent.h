@@ -46,6 +46,8 @@ public:
 
 	inline std::shared_ptr<Font> getFont() const { return mFont; }
 
+	size_t getMemoryUsage() override;
+
 	virtual void applyTheme(const std::shared_ptr<ThemeData>& theme, const std::string& view, const std::string& element, unsigned int properties) override;
 
 	void setGlowColor(unsigned int color) { mGlowColor = color; };
@@ -12,17 +12,56 @@
 #include "ThemeData.h"
 #include <SDL_timer.h>
 #include "AudioManager.h"
+#include <atomic>
 
 #ifdef WIN32
 #include <codecvt>
 #endif
 
 #include "ImageIO.h"
+#include "Trace.h"
 
 #define MATHPI          3.141592653589793238462643383279502884L
 
 libvlc_instance_t* VideoVlcComponent::mVLC = NULL;
 
+// Frame time counters, in microseconds
+static std::atomic<unsigned int>	sStatsFrames(0);
+static std::atomic<long long>		sStatsConvertTime(0);
+static std::atomic<long long>		sStatsUploadTime(0);
+static std::atomic<long long>		sStatsBytes(0);
+
+static inline long long elapsedMicroseconds(const std::chrono::steady_clock::time_point& since)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+// VLC asks for the output format : only used for YUV formats. Chroma planes are given the pitch of the Y plane
+// so that the whole frame fits in a single luminance texture (see Renderer::Texture::Type)
+static unsigned setup(void **data, char *chroma, unsigned *width, unsigned *height, unsigned *pitches, unsigned *lines)
+{
+	struct VideoContext *c = (struct VideoContext *)*data;
+
+	memcpy(chroma, c->format == Renderer::Texture::NV12 ? "NV12" : "I420", 4);
+
+	*width = c->width;
+	*height = c->height;
+
+	pitches[0] = c->width;
+	lines[0] = c->height;
+
+	pitches[1] = c->width;
+	lines[1] = c->height / 2;
+
+	if (c->format == Renderer::Texture::YUV420P)
+	{
+		pitches[2] = c->width;
+		lines[2] = c->height / 2;
+	}
+
+	return 1;
+}
+
 // VLC prepares to render a video frame.
 static void *lock(void *data, void **p_pixels) 
 {
@@ -32,7 +71,19 @@ static void *lock(void *data, void **p_pixels)
 	
 	c->mutexes[frame].lock();
 	c->hasFrame[frame] = false;
-	*p_pixels = c->surfaces[frame];
+	c->lockTime = std::chrono::steady_clock::now();
+
+	unsigned char* surface = c->surfaces[frame];
+	p_pixels[0] = surface;
+
+	if (c->format == Renderer::Texture::NV12)
+		p_pixels[1] = surface + c->width * c->height;
+	else if (c->format == Renderer::Texture::YUV420P)
+	{
+		p_pixels[1] = surface + c->width * c->height;
+		p_pixels[2] = surface + c->width * c->height + c->width / 2;
+	}
+
 	return NULL; // Picture identifier, not needed here.
 }
 
@@ -43,6 +94,8 @@ static void unlock(void *data, void* /*id*/, void *const* /*p_pixels*/)
 
 	int frame = (c->surfaceId ^ 1);	
 
+	sStatsConvertTime += elapsedMicroseconds(c->lockTime);
+
 	c->surfaceId = frame;
 	c->hasFrame[frame] = true;
 	c->mutexes[frame].unlock();
@@ -472,11 +525,17 @@ void VideoVlcComponent::render(const Transform4x4f& parentTrans)
 			if (!Settings::getInstance()->getBool("OptimizeVideo") || mElapsed >= 40) // 40ms = 25fps, 33.33 = 30 fps
 #endif
 			{
+				auto uploadStart = std::chrono::steady_clock::now();
+
 				mContext.mutexes[frame].lock();
-				mTexture->updateFromExternalPixels(mContext.surfaces[frame], mVideoWidth, mVideoHeight);
+				mTexture->updateFromExternalPixels(mContext.surfaces[frame], mVideoWidth, mVideoHeight, mContext.format);
 				mContext.hasFrame[frame] = false;
 				mContext.mutexes[frame].unlock();
 
+				sStatsUploadTime += elapsedMicroseconds(uploadStart);
+				sStatsBytes += Renderer::Texture::getDataSize(mContext.format, mVideoWidth, mVideoHeight);
+				sStatsFrames++;
+
 				mElapsed = 0;
 			}
 		}
@@ -563,9 +622,12 @@ void VideoVlcComponent::setupContext()
 	if (mContext.valid)
 		return;
 	
-	// Create an RGBA surface to render the video into
-	mContext.surfaces[0] = new unsigned char[mVideoWidth * mVideoHeight * 4];
-	mContext.surfaces[1] = new unsigned char[mVideoWidth * mVideoHeight * 4];
+	// Create an RGBA or YUV surface to render the video into
+	size_t surfaceSize = Renderer::Texture::getDataSize(mContext.format, mVideoWidth, mVideoHeight);
+	mContext.surfaces[0] = new unsigned char[surfaceSize];
+	mContext.surfaces[1] = new unsigned char[surfaceSize];
+	mContext.width = mVideoWidth;
+	mContext.height = mVideoHeight;
 	mContext.hasFrame[0] = false;	
 	mContext.hasFrame[1] = false;
 	mContext.component = this;
@@ -679,6 +741,36 @@ void VideoVlcComponent::init()
 	delete[] theArgs;
 }
 
+Renderer::Texture::Type VideoVlcComponent::getVideoPixelFormat()
+{
+	// Audio files are played with a fake 1x1 frame
+	if (mVideoWidth < 2 || mVideoHeight < 2)
+		return Renderer::Texture::RGBA;
+
+	// Custom shaders expect RGBA textures
+	if (!mCustomShader.path.empty() || !Renderer::supportYUVTextures())
+		return Renderer::Texture::RGBA;
+
+	auto format = Settings::getInstance()->getString("VideoPixelFormat");
+	if (format == "i420")
+		return Renderer::Texture::YUV420P;
+
+	if (format == "nv12")
+		return Renderer::Texture::NV12;
+
+	return Renderer::Texture::RGBA;
+}
+
+VideoFrameStats VideoVlcComponent::getFrameStats(bool reset)
+{
+	VideoFrameStats stats;
+	stats.frames = reset ? sStatsFrames.exchange(0) : sStatsFrames.load();
+	stats.convertTime = (reset ? sStatsConvertTime.exchange(0) : sStatsConvertTime.load()) / 1000.0;
+	stats.uploadTime = (reset ? sStatsUploadTime.exchange(0) : sStatsUploadTime.load()) / 1000.0;
+	stats.bytes = (size_t)(reset ? sStatsBytes.exchange(0) : sStatsBytes.load());
+	return stats;
+}
+
 void VideoVlcComponent::handleLooping()
 {
 	if (mIsPlaying && mMediaPlayer)
@@ -740,6 +832,8 @@ void VideoVlcComponent::startVideo()
 	if (mIsPlaying)
 		return;
 
+	TRACE_SCOPE_DETAIL("VideoVlcComponent::startVideo", mVideoPath);
+
 	if (hasStoryBoard("", true) && mConfig.startDelay > 0)
 		startStoryboard();
 
@@ -846,6 +940,14 @@ void VideoVlcComponent::startVideo()
 					}
 				}
 
+				mContext.format = getVideoPixelFormat();
+				if (Renderer::Texture::isYUV(mContext.format))
+				{
+					// Chroma planes are subsampled : dimensions must be even
+					mVideoWidth &= ~1;
+					mVideoHeight &= ~1;
+				}
+
 				PowerSaver::pause();
 				setupContext();
 
@@ -865,7 +967,11 @@ void VideoVlcComponent::startVideo()
 				if (mVideoWidth > 1)
 				{
 					libvlc_video_set_callbacks(mMediaPlayer, lock, unlock, display, (void*)&mContext);
-					libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
+
+					if (Renderer::Texture::isYUV(mContext.format))
+						libvlc_video_set_format_callbacks(mMediaPlayer, setup, nullptr);
+					else
+						libvlc_video_set_format(mMediaPlayer, "RGBA", (int)mVideoWidth, (int)mVideoHeight, (int)mVideoWidth * 4);
 				}
 			}
 		}
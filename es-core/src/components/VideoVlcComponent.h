@@ -6,6 +6,7 @@
 #include "ThemeData.h"
 #include "renderers/Renderer.h"
 #include <mutex>
+#include <chrono>
 
 struct libvlc_instance_t;
 struct libvlc_media_t;
@@ -22,6 +23,9 @@ struct VideoContext
 		hasFrame[0] = false;
 		hasFrame[1] = false;
 		surfaceId = 0;
+		format = Renderer::Texture::RGBA;
+		width = 0;
+		height = 0;
 	}
 
 	int					surfaceId;
@@ -29,6 +33,11 @@ struct VideoContext
 	std::mutex			mutexes[2];
 	bool				hasFrame[2];
 
+	Renderer::Texture::Type format;
+	unsigned int		width;
+	unsigned int		height;
+	std::chrono::steady_clock::time_point lockTime;
+
 	VideoComponent*		component;
 	bool				valid;	
 };
@@ -45,6 +54,17 @@ namespace VideoVlcFlags
 	};
 }
 
+// Per-frame cost of the video path, accumulated since the last call to VideoVlcComponent::getFrameStats
+struct VideoFrameStats
+{
+	VideoFrameStats() : frames(0), convertTime(0), uploadTime(0), bytes(0) { }
+
+	unsigned int	frames;
+	double			convertTime;	// ms, VLC conversion into our buffers
+	double			uploadTime;		// ms, texture upload
+	size_t			bytes;			// uploaded bytes
+};
+
 class VideoVlcComponent : public VideoComponent
 {
 	// Structure that groups together the configuration of the video component
@@ -58,6 +78,7 @@ class VideoVlcComponent : public VideoComponent
 
 public:
 	static void init();
+	static VideoFrameStats getFrameStats(bool reset = true);
 
 	VideoVlcComponent(Window* window);
 	virtual ~VideoVlcComponent();
@@ -120,6 +141,8 @@ private:
 	void setupContext();
 	void freeContext();
 
+	Renderer::Texture::Type getVideoPixelFormat();
+
 private:
 	void crop(float left, float top, float right, float bot);
 
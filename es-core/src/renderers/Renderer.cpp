@@ -907,6 +907,11 @@ namespace Renderer
 		return Instance()->supportShaders();
 	}
 
+	bool supportYUVTextures()
+	{
+		return Instance()->supportYUVTextures();
+	}
+
 	void setProjection(const Transform4x4f& _projection)
 	{
 		Instance()->setProjection(_projection);
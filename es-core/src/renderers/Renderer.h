@@ -37,11 +37,19 @@ namespace Renderer
 	{
 		enum Type
 		{
-			RGBA  = 0,
-			ALPHA = 1
+			RGBA    = 0,
+			ALPHA   = 1,
+			YUV420P = 2, // I420 : Y plane on top, U & V half planes side by side below it
+			NV12    = 3  // Y plane on top, interleaved UV half plane below it
 
 		}; // Type
 
+		inline bool isYUV(const Type _type) { return _type == YUV420P || _type == NV12; }
+
+		// YUV frames are stored in a single luminance texture, 1.5 times higher than the picture
+		inline unsigned int getStorageHeight(const Type _type, const unsigned int _height) { return isYUV(_type) ? _height + _height / 2 : _height; }
+		inline size_t       getDataSize(const Type _type, const size_t _width, const size_t _height) { return isYUV(_type) ? _width * (_height + _height / 2) : _width * _height * 4; }
+
 	} // Texture::
 
 	struct Rect
@@ -139,6 +147,8 @@ namespace Renderer
 
 		virtual bool		 supportShaders() { return false; }
 		virtual bool		 shaderSupportsCornerSize(const std::string& shader) { return false; };
+
+		virtual bool		 supportYUVTextures() { return false; }
 	};
 	
 	class ScreenSettings
@@ -207,6 +217,7 @@ namespace Renderer
 
 	bool		 supportShaders();
 	bool		 shaderSupportsCornerSize(const std::string& shader);
+	bool		 supportYUVTextures();
 
 	std::string  getDriverName();
 	std::vector<std::pair<std::string, std::string>> getDriverInformation();
@@ -27,6 +27,7 @@ namespace Renderer
 	struct TextureInfo
 	{
 		GLenum type;
+		Texture::Type format;
 		Vector2f size;
 	};
 
@@ -39,6 +40,8 @@ namespace Renderer
 	static ShaderProgram    shaderProgramColorTexture;
 	static ShaderProgram    shaderProgramColorNoTexture;
 	static ShaderProgram    shaderProgramAlpha;
+	static ShaderProgram    shaderProgramYUV420P;
+	static ShaderProgram    shaderProgramNV12;
 
 	static GLuint			vertexBuffer     = 0;
 
@@ -276,7 +279,7 @@ namespace Renderer
 			)=====";
 
 		// fragment shader (texture)
-		std::string fragmentSourceTexture =
+		std::string fragmentHeaderTexture =
 			SHADER_VERSION_STRING +
 			R"=====(
 			#ifdef GL_ES
@@ -293,10 +296,79 @@ namespace Renderer
 			uniform   vec2      outputOffset;
 			uniform   float		saturation;
 			uniform   float     es_cornerRadius;
+			)=====";
+
+		std::string fragmentSampleRGBA =
+			R"=====(
+			vec4 sampleTexture(vec2 uv)
+			{
+			    return texture2D(u_tex, uv);
+			}
+			)=====";
+
+		// YUV frames : Y plane in the top 2/3 of the texture, U & V planes side by side in the bottom 1/3. BT.601 limited range.
+		// Coordinates are kept half a texel inside each plane, so that linear filtering doesn't blend neighbouring planes.
+		std::string fragmentSampleYUV420P =
+			R"=====(
+			#ifdef GL_FRAGMENT_PRECISION_HIGH
+			precision highp float;
+			#endif
+
+			uniform   vec2      TextureSize;
+
+			vec4 yuvToRgba(float y, float u, float v)
+			{
+			    y = 1.164 * (y - 0.0625);
+			    u = u - 0.5;
+			    v = v - 0.5;
+			    return vec4(clamp(vec3(y + 1.596 * v, y - 0.392 * u - 0.813 * v, y + 2.017 * u), 0.0, 1.0), 1.0);
+			}
+
+			vec4 sampleTexture(vec2 uv)
+			{
+			    vec2 halfTexel = 0.5 / TextureSize;
+			    float ly = clamp(uv.y * 2.0 / 3.0, halfTexel.y, 2.0 / 3.0 - halfTexel.y);
+			    float cy = clamp(2.0 / 3.0 + uv.y / 3.0, 2.0 / 3.0 + halfTexel.y, 1.0 - halfTexel.y);
+			    float y = texture2D(u_tex, vec2(uv.x, ly)).r;
+			    float u = texture2D(u_tex, vec2(clamp(uv.x * 0.5, halfTexel.x, 0.5 - halfTexel.x), cy)).r;
+			    float v = texture2D(u_tex, vec2(clamp(0.5 + uv.x * 0.5, 0.5 + halfTexel.x, 1.0 - halfTexel.x), cy)).r;
+			    return yuvToRgba(y, u, v);
+			}
+			)=====";
+
+		// NV12 chroma texels are interleaved : sample exactly at U & V texel centers
+		std::string fragmentSampleNV12 =
+			R"=====(
+			#ifdef GL_FRAGMENT_PRECISION_HIGH
+			precision highp float;
+			#endif
+
+			uniform   vec2      TextureSize;
 
+			vec4 yuvToRgba(float y, float u, float v)
+			{
+			    y = 1.164 * (y - 0.0625);
+			    u = u - 0.5;
+			    v = v - 0.5;
+			    return vec4(clamp(vec3(y + 1.596 * v, y - 0.392 * u - 0.813 * v, y + 2.017 * u), 0.0, 1.0), 1.0);
+			}
+
+			vec4 sampleTexture(vec2 uv)
+			{
+			    float chroma = floor(clamp(uv.x * TextureSize.x * 0.5, 0.0, TextureSize.x * 0.5 - 1.0));
+			    float cy = 2.0 / 3.0 + uv.y / 3.0;
+			    float y = texture2D(u_tex, vec2(uv.x, uv.y * 2.0 / 3.0)).r;
+			    float u = texture2D(u_tex, vec2((chroma * 2.0 + 0.5) / TextureSize.x, cy)).r;
+			    float v = texture2D(u_tex, vec2((chroma * 2.0 + 1.5) / TextureSize.x, cy)).r;
+			    return yuvToRgba(y, u, v);
+			}
+			)=====";
+
+		std::string fragmentBodyTexture =
+			R"=====(
 			void main(void)                                    
 			{                                                  
-			    vec4 clr = texture2D(u_tex, v_tex);
+			    vec4 clr = sampleTexture(v_tex);
 		
 			    if (saturation != 1.0) {
 			    	vec3 gray = vec3(dot(clr.rgb, vec3(0.34, 0.55, 0.11)));
@@ -328,8 +400,17 @@ namespace Renderer
 
 		// Compile each shader, link them to make a full program
 		auto vertexShaderTexture = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
-		auto fragmentShaderColorTexture = Shader::createShader(GL_FRAGMENT_SHADER, fragmentSourceTexture);
+		auto fragmentShaderColorTexture = Shader::createShader(GL_FRAGMENT_SHADER, fragmentHeaderTexture + fragmentSampleRGBA + fragmentBodyTexture);
 		shaderProgramColorTexture.createShaderProgram(vertexShaderTexture, fragmentShaderColorTexture);
+
+		// YUV video frames : colour conversion is done by the shader
+		auto vertexShaderYUV420P = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
+		auto fragmentShaderYUV420P = Shader::createShader(GL_FRAGMENT_SHADER, fragmentHeaderTexture + fragmentSampleYUV420P + fragmentBodyTexture);
+		shaderProgramYUV420P.createShaderProgram(vertexShaderYUV420P, fragmentShaderYUV420P);
+
+		auto vertexShaderNV12 = Shader::createShader(GL_VERTEX_SHADER, vertexSourceTexture);
+		auto fragmentShaderNV12 = Shader::createShader(GL_FRAGMENT_SHADER, fragmentHeaderTexture + fragmentSampleNV12 + fragmentBodyTexture);
+		shaderProgramNV12.createShaderProgram(vertexShaderNV12, fragmentShaderNV12);
 		
 		// fragment shader (alpha texture)
 		std::string fragmentSourceAlpha =
@@ -403,6 +484,8 @@ namespace Renderer
 #else
 			case Texture::ALPHA: { return GL_LUMINANCE_ALPHA; } break;
 #endif
+			case Texture::YUV420P:
+			case Texture::NV12:  { return GL_LUMINANCE;       } break;
 			default:             { return GL_ZERO;            }
 		}
 
@@ -711,12 +794,14 @@ namespace Renderer
 			if (it != _textures.cend())
 			{
 				it->second->type = type;
+				it->second->format = _type;
 				it->second->size = Vector2f(_width, _height);
 			}
 			else
 			{
 				auto info = new TextureInfo();
 				info->type = type;
+				info->format = _type;
 				info->size = Vector2f(_width, _height);
 				_textures[texture] = info;
 			}
@@ -779,12 +864,14 @@ namespace Renderer
 			if (it != _textures.cend())
 			{
 				it->second->type = type;
+				it->second->format = _type;
 				it->second->size = Vector2f(_width, _height);
 			}
 			else
 			{
 				auto info = new TextureInfo();
 				info->type = type;
+				info->format = _type;
 				info->size = Vector2f(_width, _height);
 				_textures[_texture] = info;
 			}
@@ -907,7 +994,9 @@ namespace Renderer
 			{
 				ShaderProgram* shader = &shaderProgramColorTexture;
 
-				if (_vertices->customShader != nullptr && !_vertices->customShader->path.empty())
+				if (it != _textures.cend() && it->second != nullptr && Texture::isYUV(it->second->format))
+					shader = (it->second->format == Texture::NV12 ? &shaderProgramNV12 : &shaderProgramYUV420P);
+				else if (_vertices->customShader != nullptr && !_vertices->customShader->path.empty())
 				{
 					ShaderProgram* customShader = getShaderProgram(_vertices->customShader->path.c_str());
 					if (customShader != nullptr)
@@ -945,7 +1034,7 @@ namespace Renderer
 					shader->setOutputOffset(_vertices[0].pos);
 				}
 
-				if (_vertices->customShader != nullptr && !_vertices->customShader->path.empty())
+				if (shader != &shaderProgramYUV420P && shader != &shaderProgramNV12 && _vertices->customShader != nullptr && !_vertices->customShader->path.empty())
 					shader->setCustomUniformsParameters(_vertices->customShader->parameters);
 			}
 		}
@@ -1061,9 +1150,20 @@ namespace Renderer
 				useProgram(&shaderProgramAlpha);
 			else
 			{
-				useProgram(&shaderProgramColorTexture);
-				shaderProgramColorTexture.setSaturation(_vertices->saturation);
-				shaderProgramColorTexture.setCornerRadius(0.0f);
+				ShaderProgram* shader = &shaderProgramColorTexture;
+
+				if (it != _textures.cend() && it->second != nullptr && Texture::isYUV(it->second->format))
+					shader = (it->second->format == Texture::NV12 ? &shaderProgramNV12 : &shaderProgramYUV420P);
+
+				useProgram(shader);
+				shader->setSaturation(_vertices->saturation);
+				shader->setCornerRadius(0.0f);
+
+				if (shader->supportsTextureSize() && it != _textures.cend() && it->second != nullptr)
+				{
+					shader->setInputSize(it->second->size);
+					shader->setTextureSize(it->second->size);
+				}
 			}
 		}
 		else
@@ -1125,7 +1225,7 @@ namespace Renderer
 		{
 			if (tex.first != 0 && tex.second)
 			{
-				size_t size = tex.second->size.x() * tex.second->size.y() * (tex.second->type == GL_ALPHA ? 1 : 4);
+				size_t size = tex.second->size.x() * tex.second->size.y() * (tex.second->type == GL_ALPHA || tex.second->type == GL_LUMINANCE ? 1 : 4);
 				total += size;
 			}
 		}	
@@ -57,6 +57,8 @@ namespace Renderer
 		bool		 supportShaders() { return true; }
 		bool		 shaderSupportsCornerSize(const std::string& shader) override;
 
+		bool		 supportYUVTextures() override { return true; }
+
 	private:
 		unsigned int mFrameBuffer;
 	};
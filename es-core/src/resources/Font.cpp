@@ -4,6 +4,8 @@
 #include "utils/FileSystemUtil.h"
 #include "utils/StringUtil.h"
 #include "Log.h"
+#include "Trace.h"
+#include "MemoryAccounting.h"
 #include "math/Misc.h"
 #include "LocaleES.h"
 
@@ -12,6 +14,7 @@
 #include "Settings.h"
 #include "ImageIO.h"
 #include <algorithm>
+#include <cstring>
 #include "math/Transform4x4f.h"
 
 #ifdef WIN32
@@ -57,7 +60,10 @@ size_t Font::getMemUsage() const
 	size_t memUsage = 0;
 	
 	for(auto tex : mTextures)
+	{
 		memUsage += (tex->textureId != 0 ? tex->textureSize.x() * tex->textureSize.y() * 4 : 0);
+		memUsage += tex->pixels.capacity() + tex->packedPixels.capacity();
+	}
 
 	for(auto it = mFaceCache.cbegin(); it != mFaceCache.cend(); it++)
 		memUsage += it->second->data.length;
@@ -142,7 +148,10 @@ bool Font::unload()
 	if (mLoaded)
 	{		
 		for (auto tex : mTextures)
+		{
 			tex->deinitTexture();
+			tex->packPixels();
+		}
 
 		clearFaceCache();
 
@@ -215,14 +224,105 @@ bool Font::FontTexture::findEmpty(const Vector2i& size, Vector2i& cursor_out)
 	return true;
 }
 
-void Font::FontTexture::initTexture()
+bool Font::FontTexture::initTexture()
 {
+	if (textureId != 0)
+		return true;
+
+	bool restored = unpackPixels();
+	if (!restored)
+		pixels.assign((size_t)textureSize.x() * textureSize.y(), 0);
+
+	textureId = Renderer::createTexture(Renderer::Texture::ALPHA, true, false, textureSize.x(), textureSize.y(), pixels.data());
 	if (textureId == 0)
+		LOG(LogError) << "FontTexture::initTexture() failed to create texture " << textureSize.x() << "x" << textureSize.y();
+
+	// Without the copy, glyphs are rendered again when the texture is recreated
+	if (!Settings::getInstance()->getBool("FontTextureCopy"))
 	{
-		textureId = Renderer::createTexture(Renderer::Texture::ALPHA, true, false, textureSize.x(), textureSize.y(), nullptr);
-		if (textureId == 0)
-			LOG(LogError) << "FontTexture::initTexture() failed to create texture " << textureSize.x() << "x" << textureSize.y();
+		pixels.clear();
+		pixels.shrink_to_fit();
 	}
+
+	return restored;
+}
+
+void Font::FontTexture::writeGlyph(const Vector2i& cursor, const Vector2i& size, const unsigned char* data)
+{
+	if (data == nullptr || pixels.size() != (size_t)textureSize.x() * textureSize.y())
+		return;
+
+	for (int y = 0; y < size.y(); y++)
+		memcpy(&pixels[(size_t)(cursor.y() + y) * textureSize.x() + cursor.x()], data + (size_t)y * size.x(), size.x());
+}
+
+// Glyph textures are mostly empty : a control byte < 128 is a run of (n + 1) zeros, otherwise it is followed by (n - 127) literal bytes
+void Font::FontTexture::packPixels()
+{
+	if (pixels.empty())
+		return;
+
+	packedPixels.clear();
+	packedPixels.reserve(pixels.size() / 8);
+
+	size_t pos = 0;
+	while (pos < pixels.size())
+	{
+		size_t start = pos;
+		while (pos < pixels.size() && pos - start < 128 && pixels[pos] == 0)
+			pos++;
+
+		if (pos > start)
+		{
+			packedPixels.push_back((unsigned char)(pos - start - 1));
+			continue;
+		}
+
+		while (pos < pixels.size() && pos - start < 128 && (pixels[pos] != 0 || (pos + 1 < pixels.size() && pixels[pos + 1] != 0)))
+			pos++;
+
+		packedPixels.push_back((unsigned char)(127 + pos - start));
+		packedPixels.insert(packedPixels.end(), pixels.cbegin() + start, pixels.cbegin() + pos);
+	}
+
+	packedPixels.shrink_to_fit();
+
+	pixels.clear();
+	pixels.shrink_to_fit();
+}
+
+bool Font::FontTexture::unpackPixels()
+{
+	size_t size = (size_t)textureSize.x() * textureSize.y();
+
+	if (packedPixels.empty())
+		return pixels.size() == size;
+
+	pixels.clear();
+	pixels.reserve(size);
+
+	size_t pos = 0;
+	while (pos < packedPixels.size())
+	{
+		unsigned char control = packedPixels[pos++];
+		if (control < 128)
+			pixels.insert(pixels.end(), (size_t)control + 1, 0);
+		else
+		{
+			size_t count = std::min((size_t)control - 127, packedPixels.size() - pos);
+			pixels.insert(pixels.end(), packedPixels.cbegin() + pos, packedPixels.cbegin() + pos + count);
+			pos += count;
+		}
+	}
+
+	packedPixels.clear();
+	packedPixels.shrink_to_fit();
+
+	if (pixels.size() == size)
+		return true;
+
+	pixels.clear();
+	return false;
 }
 
 void Font::FontTexture::deinitTexture()
@@ -367,6 +467,8 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 			return it->second;
 	}
 
+	TRACE_SCOPE("Font::getGlyph");
+
 	// nope, need to make a glyph
 	FT_Face face = getFaceForChar(id);
 	if(!face)
@@ -409,7 +511,10 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 
 	// upload glyph bitmap to texture
 	if (glyphSize.x() > 0 && glyphSize.y() > 0)
+	{
 		Renderer::updateTexture(tex->textureId, Renderer::Texture::ALPHA, cursor.x(), cursor.y(), glyphSize.x(), glyphSize.y(), g->bitmap.buffer);
+		tex->writeGlyph(cursor, glyphSize, g->bitmap.buffer);
+	}
 
 	// update max glyph height - Limit to ascii table. If we don't it can take in the fallback fonts
 	if (glyphSize.y() > mMaxGlyphHeight && id >= 32 && id < 128)
@@ -427,9 +532,13 @@ Font::Glyph* Font::getGlyph(unsigned int id)
 // completely recreate the texture data for all textures based on mGlyphs information
 void Font::rebuildTextures()
 {
-	// recreate OpenGL textures
-	for(auto tex : mTextures)
-		tex->initTexture();
+	// recreate OpenGL textures, from the copy of their content if possible
+	bool restored = true;
+	for (auto tex : mTextures)
+		restored = tex->initTexture() && restored;
+
+	if (restored)
+		return;
 
 	// reupload the texture data
 	for(auto it = mGlyphMap.cbegin(); it != mGlyphMap.cend(); it++)
@@ -447,6 +556,8 @@ void Font::rebuildTextures()
 			glyph->cursor.x(), glyph->cursor.y(),
 			glyph->glyphSize.x(), glyph->glyphSize.y(),
 			glyphSlot->bitmap.buffer);
+
+		glyph->texture->writeGlyph(glyph->cursor, glyph->glyphSize, glyphSlot->bitmap.buffer);
 	}
 }
 
@@ -1070,6 +1181,9 @@ TextCache* Font::buildTextCache(const std::string& _text, Vector2f offset, unsig
 		i++;
 	}
 
+	cache->accountedSize = cache->getMemUsage();
+	MemoryAccounting::add(MemoryAccounting::TEXT_CACHES, cache->accountedSize);
+
 	clearFaceCache();
 
 	return cache;
@@ -1080,6 +1194,11 @@ TextCache* Font::buildTextCache(const std::string& text, float offsetX, float of
 	return buildTextCache(text, Vector2f(offsetX, offsetY), color, 0.0f);
 }
 
+TextCache::~TextCache()
+{
+	MemoryAccounting::remove(MemoryAccounting::TEXT_CACHES, accountedSize);
+}
+
 void TextCache::setColors(unsigned int color, unsigned int extraColor)
 {
 	const unsigned int convertedColor = Renderer::convertColor(color);
@@ -1106,6 +1225,16 @@ void TextCache::setColors(unsigned int color, unsigned int extraColor)
 			it.vertex[i].col = substitColor;
 }
 
+size_t TextCache::getMemUsage() const
+{
+	size_t total = 0;
+
+	for (auto it = vertexLists.cbegin(); it != vertexLists.cend(); it++)
+		total += it->verts.size() * sizeof(Renderer::Vertex);
+
+	return total;
+}
+
 void TextCache::setColor(unsigned int color)
 {
 	const unsigned int convertedColor = Renderer::convertColor(color);
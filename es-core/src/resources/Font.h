@@ -75,8 +75,8 @@ public:
 
 	static std::shared_ptr<Font> getFromTheme(const ThemeData::ThemeElement* elem, unsigned int properties, const std::shared_ptr<Font>& orig, bool menu = false);
 
-	size_t getMemUsage() const; // returns an approximation of VRAM used by this font's texture (in bytes)
-	static size_t getTotalMemUsage(); // returns an approximation of total VRAM used by font textures (in bytes)
+	size_t getMemUsage() const; // returns an approximation of memory used by this font's textures, their copy and the font files (in bytes)
+	static size_t getTotalMemUsage(); // returns an approximation of total memory used by fonts (in bytes)
 
 private:
 	void renderSingleGlow(TextCache* cache, const Transform4x4f& parentTrans, float x, float y, bool verticesChanged = true);
@@ -95,13 +95,24 @@ private:
 		Vector2i writePos;
 		int rowHeight;
 
+		// Copy of the texture content, so that the glyphs don't have to be rendered again when the texture is recreated.
+		// GLES can't read a texture back, so the copy is kept while the texture is loaded : it costs one byte per texel,
+		// textureSize.x() * textureSize.y(), e.g. 2048 x 40 (80 KB) for a 32 pixels font. It is run-length encoded while
+		// the texture is unloaded (e.g. while a game is running). Disabled by the "FontTextureCopy" setting.
+		std::vector<unsigned char> pixels;
+		std::vector<unsigned char> packedPixels;
+
 		FontTexture();
 		~FontTexture();
 		bool findEmpty(const Vector2i& size, Vector2i& cursor_out);
 
 		// you must call initTexture() after creating a FontTexture to get a textureId
-		void initTexture(); // initializes the OpenGL texture according to this FontTexture's settings, updating textureId
+		bool initTexture(); // initializes the OpenGL texture according to this FontTexture's settings, updating textureId. Returns false if the glyphs must be uploaded again
 		void deinitTexture(); // deinitializes the OpenGL texture if any exists, is automatically called in the destructor
+
+		void writeGlyph(const Vector2i& cursor, const Vector2i& size, const unsigned char* data);
+		void packPixels();
+		bool unpackPixels();
 	};
 
 	struct FontFace
@@ -180,6 +191,7 @@ protected:
 	std::vector<VertexList> vertexLists;
 	std::vector<TextImageSubstitute> imageSubstitutes;
 	bool renderingGlow;
+	size_t accountedSize; // Counted by MemoryAccounting
 
 	Renderer::ShaderInfo customShader;
 
@@ -187,8 +199,11 @@ public:
 	TextCache()
 	{
 		renderingGlow = false;
+		accountedSize = 0;
 	}
 
+	~TextCache();
+
 	struct CacheMetrics
 	{
 		Vector2f size;
@@ -198,6 +213,7 @@ public:
 	void setColors(unsigned int color, unsigned int extraColor);
 
 	void setRenderingGlow(bool glow) { renderingGlow = glow; }
+	size_t getMemUsage() const; // returns the size of the vertex lists (in bytes)
 	void setCustomShader(Renderer::ShaderInfo* shader) { if (shader == nullptr) customShader.path = ""; else customShader = *shader; }
 
 	friend Font;
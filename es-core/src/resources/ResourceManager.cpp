@@ -5,6 +5,7 @@
 #include <fstream>
 #include <algorithm>
 #include "Log.h"
+#include "Trace.h"
 #include "Settings.h"
 #include "Paths.h"
 #include "utils/ConcurrentVector.h"
@@ -188,8 +189,9 @@ void ResourceManager::unloadAll()
 
 		if (!info->data.expired())
 		{
+			// Keep the flag of resources which haven't been reloaded since the last call
 			if (!info->locked)
-				info->reload = info->data.lock()->unload();
+				info->reload = info->data.lock()->unload() || info->reload;
 			else
 				info->locked = false;
 
@@ -202,6 +204,8 @@ void ResourceManager::unloadAll()
 
 void ResourceManager::reloadAll()
 {
+	TRACE_SCOPE("ResourceManager::reloadAll");
+
 	auto iter = mReloadables.cbegin();
 	while(iter != mReloadables.cend())
 	{
@@ -25,7 +25,7 @@
 IPdfHandler* TextureData::PdfHandler = nullptr;
 
 TextureData::TextureData(bool tile, bool linear) : 
-	mTile(tile), mLinear(linear), mTextureID(0), mDataRGBA(nullptr), mScalable(false), mDynamic(true), mReloadable(false),	
+	mTile(tile), mLinear(linear), mTextureID(0), mDataRGBA(nullptr), mFormat(Renderer::Texture::RGBA), mScalable(false), mDynamic(true), mReloadable(false),	
 	mSize(Vector2i::Zero()), mPhysicalSize(Vector2f::Zero()), mMaxSize(MaxSizeInfo::Empty)
 {
 	mIsExternalDataRGBA = false;
@@ -211,6 +211,7 @@ bool TextureData::initFromRGBA(unsigned char* dataRGBA, size_t width, size_t hei
 	else
 		mDataRGBA = dataRGBA;
 
+	mFormat = Renderer::Texture::RGBA;
 	mSize = Vector2i(width, height);
 
 	if (copyData)
@@ -219,7 +220,7 @@ bool TextureData::initFromRGBA(unsigned char* dataRGBA, size_t width, size_t hei
 	return true;
 }
 
-bool TextureData::updateFromExternalRGBA(unsigned char* dataRGBA, size_t width, size_t height)
+bool TextureData::updateFromExternalRGBA(unsigned char* dataRGBA, size_t width, size_t height, Renderer::Texture::Type format)
 {
 	// If already initialised then don't read again
 	std::unique_lock<std::mutex> lock(mMutex);
@@ -230,11 +231,19 @@ bool TextureData::updateFromExternalRGBA(unsigned char* dataRGBA, size_t width,
 	mIsExternalDataRGBA = true;
 	mDataRGBA = dataRGBA;
 
+	// Texture storage differs between formats : it will be recreated by uploadAndBind
+	if (mTextureID != 0 && mFormat != format)
+	{
+		Renderer::destroyTexture(mTextureID);
+		mTextureID = 0;
+	}
+
+	mFormat = format;
 	mSize = Vector2i(width, height);
 	mPhysicalSize = Vector2f(width, height);
 
 	if (mTextureID != 0)
-		Renderer::updateTexture(mTextureID, Renderer::Texture::RGBA, 0, 0, width, height, mDataRGBA);
+		Renderer::updateTexture(mTextureID, mFormat, 0, 0, width, Renderer::Texture::getStorageHeight(mFormat, height), mDataRGBA);
 
 	return true;
 }
@@ -501,7 +510,7 @@ bool TextureData::uploadAndBind()
 		}
 
 		// Upload texture
-		mTextureID = Renderer::createTexture(Renderer::Texture::RGBA, mLinear, mTile, mSize.x(), mSize.y(), mDataRGBA);
+		mTextureID = Renderer::createTexture(mFormat, mLinear, mTile, mSize.x(), Renderer::Texture::getStorageHeight(mFormat, mSize.y()), mDataRGBA);
 		if (mTextureID == 0)
 			return false;
 
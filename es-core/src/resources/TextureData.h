@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include "ImageIO.h"
+#include "renderers/Renderer.h"
 
 class TextureResource;
 
@@ -52,7 +53,9 @@ public:
 
 	// Get the amount of VRAM currenty used by this texture
 	inline size_t getEstimatedVRAMUsage() { return mSize.x() * mSize.y() * 4; }
-	inline size_t getVRAMUsage() { return mTextureID != 0 || mDataRGBA != nullptr ? mSize.x() * mSize.y() * 4 : 0; }
+	inline size_t getVRAMUsage() { return mTextureID != 0 || mDataRGBA != nullptr ? Renderer::Texture::getDataSize(mFormat, mSize.x(), mSize.y()) : 0; }
+	// Get the amount of RAM used by decoded pixels waiting to be uploaded
+	inline size_t getRAMUsage() { return mDataRGBA != nullptr && !mIsExternalDataRGBA ? Renderer::Texture::getDataSize(mFormat, mSize.x(), mSize.y()) : 0; }
 
 	const 	Vector2i& getSize() const { return mSize; }
 	const 	Vector2f& getPhysicalSize() const { return mPhysicalSize; }
@@ -79,7 +82,8 @@ public:
 
 	inline const std::string& getPath() { return mPath; };
 
-	bool updateFromExternalRGBA(unsigned char* dataRGBA, size_t width, size_t height);
+	// dataRGBA is not copied. With a YUV format, it contains the planes described in Renderer::Texture::Type
+	bool updateFromExternalRGBA(unsigned char* dataRGBA, size_t width, size_t height, Renderer::Texture::Type format = Renderer::Texture::RGBA);
 
 	inline bool isRequired() { return mRequired; };
 	void setRequired(bool value) { mRequired = value; };
@@ -101,6 +105,7 @@ private:
 	std::string		mPath;
 	unsigned int	mTextureID;
 	unsigned char*	mDataRGBA;
+	Renderer::Texture::Type mFormat;
 	bool			mReloadable;
 	bool			mDynamic;
 
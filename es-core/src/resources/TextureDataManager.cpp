@@ -4,6 +4,7 @@
 #include "resources/TextureResource.h"
 #include "Settings.h"
 #include "Log.h"
+#include "Trace.h"
 #include <algorithm>
 #include <SDL.h>
 
@@ -77,6 +78,14 @@ std::shared_ptr<TextureData> TextureDataManager::get(const TextureResource* key,
 		if (enableLoading == TextureLoadMode::DISABLED)
 			return tex;
 
+		if (enableLoading == TextureLoadMode::BACKGROUND)
+		{
+			if (!tex->isLoaded())
+				load(tex, false, true);
+
+			return tex;
+		}
+
 		if (mTextures.cbegin() != (*it).second)
 		{
 			// Remove the list entry
@@ -131,6 +140,17 @@ size_t TextureDataManager::getCommittedSize()
 	return total;
 }
 
+size_t TextureDataManager::getRAMSize()
+{
+	std::unique_lock<std::recursive_mutex> lock(mMutex);
+
+	size_t total = 0;
+	for (auto tex : mTextures)
+		total += tex->getRAMUsage();
+
+	return total;
+}
+
 size_t TextureDataManager::getQueueSize()
 {
 	std::unique_lock<std::recursive_mutex> lock(mMutex);
@@ -224,7 +244,7 @@ void TextureDataManager::cleanupVRAM(std::shared_ptr<TextureData> exclude)
 	}
 }
 
-void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
+void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block, bool background)
 {
 	// See if it's already loaded
 	if (tex->isLoaded())
@@ -243,7 +263,7 @@ void TextureDataManager::load(std::shared_ptr<TextureData> tex, bool block)
 	cleanupVRAM(tex);
 
 	if (!block)
-		mLoader->load(tex);
+		mLoader->load(tex, background);
 	else
 		tex->load();
 }
@@ -273,6 +293,8 @@ TextureLoader::~TextureLoader()
 
 void TextureLoader::threadProc()
 {
+	Trace::setThreadName("TextureLoader");
+
 	while (true)
 	{		
 		// Wait for an event to say there is something in the queue
@@ -296,7 +318,10 @@ void TextureLoader::threadProc()
 				lock.unlock();
 				std::this_thread::yield();
 				
-				textureData->load(true);
+				{
+					TRACE_SCOPE("TextureLoader::load");
+					textureData->load(true);
+				}
 				
 				std::this_thread::yield();
 				lock.lock();
@@ -312,7 +337,7 @@ void TextureLoader::threadProc()
 
 bool TextureLoader::paused = false;
 
-void TextureLoader::load(std::shared_ptr<TextureData> textureData)
+void TextureLoader::load(std::shared_ptr<TextureData> textureData, bool background)
 {
 //	if (paused)
 	//	return;
@@ -328,15 +353,24 @@ void TextureLoader::load(std::shared_ptr<TextureData> textureData)
 		return;
 
 	// Remove it from the queue if it is already there
-	if (mTextureDataQSet.erase(textureData) > 0)
+	if (mTextureDataQSet.find(textureData) != mTextureDataQSet.cend())
 	{
+		// Don't lower the priority of a texture which has been requested for rendering
+		if (background)
+			return;
+
+		mTextureDataQSet.erase(textureData);
+
 		auto tx = std::find(mTextureDataQ.cbegin(), mTextureDataQ.cend(), textureData);
 		if (tx != mTextureDataQ.cend())
 			mTextureDataQ.erase(tx);
 	}
 
 	// Put it on the start of the queue as we want the newly requested textures to load first
-	mTextureDataQ.push_front(textureData);
+	if (background)
+		mTextureDataQ.push_back(textureData);
+	else
+		mTextureDataQ.push_front(textureData);
 	mTextureDataQSet.insert(textureData);
 
 	mEvent.notify_one();
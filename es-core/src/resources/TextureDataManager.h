@@ -22,7 +22,7 @@ public:
 	TextureLoader(TextureDataManager* mgr);
 	~TextureLoader();
 
-	void load(std::shared_ptr<TextureData> textureData);
+	void load(std::shared_ptr<TextureData> textureData, bool background = false);
 	bool remove(std::shared_ptr<TextureData> textureData);
 	void clearQueue();
 
@@ -72,7 +72,8 @@ public:
 	{
 		ENABLED = 0,
 		DISABLED = 1,
-		MOVETOTOPONLY = 2
+		MOVETOTOPONLY = 2,
+		BACKGROUND = 3 // Queued after the textures requested while rendering, keeps its place in the cache
 	};
 
 	std::shared_ptr<TextureData> add(const TextureResource* key, bool tiled, bool linear);
@@ -90,11 +91,13 @@ public:
 	size_t	getTotalSize();
 	// Get the total size of all committed textures (in VRAM) in bytes
 	size_t	getCommittedSize();
+	// Get the total size of the decoded textures which are still in RAM in bytes
+	size_t	getRAMSize();
 	// Get the total size of all load-pending textures in the queue - these will
 	// be committed to VRAM as the queue is processed
 	size_t  getQueueSize();
 	// Load a texture, freeing resources as necessary to make space
-	void load(std::shared_ptr<TextureData> tex, bool block = false);
+	void load(std::shared_ptr<TextureData> tex, bool block = false, bool background = false);
 
 	void clearQueue();
 	
@@ -192,13 +192,13 @@ std::shared_ptr<TextureResource> TextureResource::get(const std::string& path, b
 	return tex;
 }
 
-void TextureResource::updateFromExternalPixels(unsigned char* dataRGBA, size_t width, size_t height)
+void TextureResource::updateFromExternalPixels(unsigned char* dataRGBA, size_t width, size_t height, Renderer::Texture::Type format)
 {
 	// This is only valid if we have a local texture data object
 	if (mTextureData == nullptr)
 		return;
 
-	if (mTextureData->updateFromExternalRGBA(dataRGBA, width, height))
+	if (mTextureData->updateFromExternalRGBA(dataRGBA, width, height, format))
 	{
 		mSize = mTextureData->getSize();
 		mPhysicalSize = mTextureData->getPhysicalSize();
@@ -336,6 +336,17 @@ size_t TextureResource::getTotalMemUsage(bool includeQueueSize)
 	return total;
 }
 
+size_t TextureResource::getTotalRAMUsage()
+{
+	size_t total = 0;
+
+	for (auto tex : sNonDynamicTextureResources)
+		total += tex->mTextureData->getRAMUsage();
+
+	total += sTextureDataManager.getRAMSize();
+	return total;
+}
+
 size_t TextureResource::getTotalTextureSize()
 {
 	size_t total = 0;
@@ -366,15 +377,15 @@ bool TextureResource::unload()
 
 void TextureResource::reload()
 {
-	// For dynamically loaded textures the texture manager will load them on demand.
-	// For manually loaded textures we have to reload them here
+	// For dynamically loaded textures the texture manager will load them on demand : the ones which are displayed are
+	// requested first by rendering, the others are queued after them. For manually loaded textures we have to reload them here
 	if (mTextureData)
 	{
 		if (!mTextureData->isLoaded())
 			mTextureData->load();
 	}
 	else
-		sTextureDataManager.get(this);
+		sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::BACKGROUND);
 }
 
 void TextureResource::clearQueue()
@@ -397,4 +408,10 @@ size_t TextureResource::getEstimatedVRAMUsage()
 {
 	auto data = mTextureData ? mTextureData : sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::DISABLED);
 	return data ? data->getEstimatedVRAMUsage() : 0;
+}
+
+size_t TextureResource::getVRAMUsage()
+{
+	auto data = mTextureData ? mTextureData : sTextureDataManager.get(this, TextureDataManager::TextureLoadMode::DISABLED);
+	return data ? data->getVRAMUsage() : 0;
 }
\ No newline at end of file
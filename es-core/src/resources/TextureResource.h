@@ -24,7 +24,7 @@ public:
 	static void cleanupTextureResourceCache();
 	
 	void initFromPixels(unsigned char* dataRGBA, size_t width, size_t height);
-	void updateFromExternalPixels(unsigned char* dataRGBA, size_t width, size_t height);
+	void updateFromExternalPixels(unsigned char* dataRGBA, size_t width, size_t height, Renderer::Texture::Type format = Renderer::Texture::RGBA);
 	void initFromMemory(const char* file, size_t length);
 
 	// For scalable source images in textures we want to set the resolution to rasterize at
@@ -34,6 +34,7 @@ public:
 	const Vector2f getPhysicalSize() const;
 
 	size_t getEstimatedVRAMUsage();
+	size_t getVRAMUsage(); // returns 0 if the texture is not loaded
 
 	virtual ~TextureResource();
 
@@ -47,6 +48,7 @@ public:
 
 	static size_t getTotalMemUsage(bool includeQueueSize = true); // returns an approximation of total VRAM used by textures (in bytes)
 	static size_t getTotalTextureSize(); // returns the number of bytes that would be used if all textures were in memory
+	static size_t getTotalRAMUsage(); // returns the size of the decoded pixels which are not uploaded yet
 	
 	virtual bool unload();
 	virtual void reload();
@@ -0,0 +1,178 @@
+#!/usr/bin/python3
+
+# Compiles arcaderoms.xml and gamesdb.xml into mamenames.dat, a read-only binary database mapped by MameNames at startup.
+#
+# Layout (little endian, 32 bits values) :
+#   header   : magic "ESMN", version, arcaderoms.xml size, gamesdb.xml size,
+#              rom count, rom table offset, system count, system table offset,
+#              device game count, device game table offset, strings offset, strings size,
+#              then 64 bits values : arcaderoms.xml and gamesdb.xml modification times, arcaderoms.xml and gamesdb.xml FNV-1a hashes
+#
+# Usage : compileGamesDb.py <resources directory> <output file>. The build writes it to the resources directory next to the executable.
+#   roms     : { id, display name (0xFFFFFFFF if none), ArcadeRomType flags } sorted by id
+#   systems  : { name, first device game, device game count } sorted by name
+#   games    : { name, ArcadeRomType flags }
+#   strings  : zero terminated utf-8 strings, offsets are relative to the strings block
+
+import os
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+VERSION = 2
+NO_STRING = 0xFFFFFFFF
+
+# ArcadeRomType
+VERTICAL = 1
+LIGHTGUN = 2
+WHEEL = 4
+BIOS = 8
+DEVICE = 16
+TRACKBALL = 32
+SPINNER = 64
+
+DEVICES = [("gun", LIGHTGUN), ("wheel", WHEEL), ("trackball", TRACKBALL), ("spinner", SPINNER)]
+
+class StringPool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = dict()
+
+    def add(self, value):
+        if value is None:
+            return NO_STRING
+        if value not in self.offsets:
+            self.offsets[value] = len(self.data)
+            self.data += value.encode("utf-8") + b"\0"
+        return self.offsets[value]
+
+def getFileInfo(path):
+    if not os.path.exists(path):
+        return (0, 0, 0)
+
+    hash = 0xcbf29ce484222325
+    with open(path, "rb") as f:
+        for byte in f.read():
+            hash = ((hash ^ byte) * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+
+    return (os.path.getsize(path), int(os.path.getmtime(path)), hash)
+
+def readArcadeRoms(path):
+    roms = dict()
+    if not os.path.exists(path):
+        return roms
+
+    for node in ET.parse(path).getroot().findall("rom"):
+        name = node.get("id")
+        if name is None:
+            continue
+
+        if node.get("device") == "true":
+            roms[name] = [None, DEVICE]
+            continue
+
+        if node.get("bios") == "true":
+            roms[name] = [None, BIOS]
+            continue
+
+        if node.get("name") is None:
+            continue
+
+        roms[name] = [node.get("name"), VERTICAL if node.get("vert") == "true" else 0]
+
+    return roms
+
+def readGamesDb(path, roms):
+    systems = dict()
+    if not os.path.exists(path):
+        return systems
+
+    for systemNode in ET.parse(path).getroot().findall("system"):
+        systemNames = systemNode.get("name")
+        if systemNames is None:
+            continue
+
+        games = dict()
+        for gameNode in systemNode.findall("game"):
+            name = gameNode.get("name")
+            if name is None or name == "" or name == "default":
+                continue
+
+            flags = 0
+            for tag, flag in DEVICES:
+                if gameNode.find(tag) is not None:
+                    flags |= flag
+
+            if flags != 0:
+                games[name] = games.get(name, 0) | flags
+
+        if systemNames == "arcade":
+            for name, flags in games.items():
+                roms.setdefault(name, [None, 0])[1] |= flags
+            continue
+
+        for systemName in systemNames.split(","):
+            target = systems.setdefault(systemName.strip(), dict())
+            for name, flags in games.items():
+                target[name] = target.get(name, 0) | flags
+
+    return systems
+
+def compile(resourcesPath, outputPath):
+    arcadePath = os.path.join(resourcesPath, "arcaderoms.xml")
+    gamesDbPath = os.path.join(resourcesPath, "gamesdb.xml")
+
+    roms = readArcadeRoms(arcadePath)
+    systems = readGamesDb(gamesDbPath, roms)
+
+    strings = StringPool()
+
+    # Keys must be sorted the way strcmp compares them
+    romTable = bytearray()
+    for name in sorted(roms.keys(), key=lambda x: x.encode("utf-8")):
+        displayName, flags = roms[name]
+        romTable += struct.pack("<III", strings.add(name), strings.add(displayName), flags)
+
+    systemTable = bytearray()
+    gameTable = bytearray()
+    gameCount = 0
+    for name in sorted(systems.keys(), key=lambda x: x.encode("utf-8")):
+        games = systems[name]
+        systemTable += struct.pack("<III", strings.add(name), gameCount, len(games))
+        for gameName, flags in games.items():
+            gameTable += struct.pack("<II", strings.add(gameName), flags)
+        gameCount += len(games)
+
+    headerSize = 12 * 4 + 4 * 8
+    romOffset = headerSize
+    systemOffset = romOffset + len(romTable)
+    gameOffset = systemOffset + len(systemTable)
+    stringsOffset = gameOffset + len(gameTable)
+
+    arcadeSize, arcadeTime, arcadeHash = getFileInfo(arcadePath)
+    gamesDbSize, gamesDbTime, gamesDbHash = getFileInfo(gamesDbPath)
+
+    header = struct.pack("<4sIIIIIIIIIIIQQQQ", b"ESMN", VERSION, arcadeSize, gamesDbSize,
+        len(roms), romOffset, len(systems), systemOffset, gameCount, gameOffset, stringsOffset, len(strings.data),
+        arcadeTime, gamesDbTime, arcadeHash, gamesDbHash)
+
+    data = header + romTable + systemTable + gameTable + strings.data
+
+    # Don't touch the file if nothing changed
+    if os.path.exists(outputPath):
+        with open(outputPath, "rb") as f:
+            if f.read() == data:
+                return
+
+    outputDir = os.path.dirname(outputPath)
+    if outputDir != "" and not os.path.isdir(outputDir):
+        os.makedirs(outputDir)
+
+    with open(outputPath, "wb") as f:
+        f.write(data)
+
+    print("{} : {} roms, {} systems, {} device games, {} bytes".format(outputPath, len(roms), len(systems), gameCount, len(data)))
+
+resourcesPath = sys.argv[1] if len(sys.argv) > 1 else "resources"
+outputPath = sys.argv[2] if len(sys.argv) > 2 else "mamenames.dat"
+compile(resourcesPath, outputPath)